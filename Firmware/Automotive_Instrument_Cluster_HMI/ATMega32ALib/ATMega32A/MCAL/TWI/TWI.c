@@ -22,9 +22,49 @@
 # define F_CPU 1000000UL
 #endif
 
+#define TWI_MASTER_TRANSACTION_QUEUE_MASK (TWI_MASTER_TRANSACTION_QUEUE_SIZE - 1)
+
+#if (TWI_MASTER_TRANSACTION_QUEUE_SIZE & TWI_MASTER_TRANSACTION_QUEUE_MASK) != 0 || TWI_MASTER_TRANSACTION_QUEUE_SIZE > 128
+# error "TWI_MASTER_TRANSACTION_QUEUE_SIZE must be a power of two, up to 128"
+#endif
+
 /* TWI Interrupt Callback Function */
 static void(*TWI_INTERRUPT_CALLBACK_FUNCTION)() = 0;		// Initialize
 
+/**
+ * Master transaction queue, filled by TWI_master_queueTransaction() and run by the TWI ISR.
+ * The head transaction is the one on the bus. Both indexes run freely and wrap around at 256, same as the UART ring buffers
+ */
+static ST_TWI_transaction_t* volatile gs_masterQueue[TWI_MASTER_TRANSACTION_QUEUE_SIZE];
+static volatile uint8_t gs_masterQueueHead = 0;
+static volatile uint8_t gs_masterQueueTail = 0;
+// Transactions are pending, the TWI ISR runs the master state machine instead of calling TWI_INTERRUPT_CALLBACK_FUNCTION
+static volatile bool gs_masterBusy = false;
+// Index of the next byte to write or read of the head transaction
+static uint8_t gs_masterDataIndex = 0;
+static uint8_t gs_masterArbitrationRetries = 0;
+
+/* Slave Register Bank, see TWI_slave_initRegisterBank() */
+static volatile uint8_t* gs_registerBank = 0;
+static uint8_t gs_registerBankSize = 0;
+static const uint8_t* gs_registerBankWritableMask = 0;
+static void(*gs_registerBankWriteCallback)(uint8_t, uint8_t) = 0;
+static uint8_t gs_registerBankPointer = 0;
+// The first byte written after own slave address + write is the register address, the next ones are register values
+static bool gs_registerBankPointerReceived = false;
+// Buffer the current read transaction sends the registers from
+static volatile uint8_t* gs_registerBankReadBuffer = 0;
+
+/**
+ * Snapshot register bank, see TWI_slave_initSnapshotRegisterBank(). gs_registerBank holds both buffers back to back.
+ * The sequence counter is only incremented by the main program, its lowest bit selects the published buffer, so publishing is a single byte write.
+ * The latched buffer is only written by the ISR, the main program never fills it
+ */
+#define TWI_SNAPSHOT_NOT_LATCHED 0xFF
+static bool gs_registerBankSnapshots = false;
+static volatile uint8_t gs_snapshotSequence = 0;
+static volatile uint8_t gs_snapshotLatched = TWI_SNAPSHOT_NOT_LATCHED;
+
 /**
  * Calculate the value for the TWSR register from the SCL frequency, F_CPU, and the TWI pre-scaler(TWPS0, TWPS1)
 */
@@ -455,10 +495,341 @@ void TWI_setInterruptCallback(void(*callbackFunction)())
 	TWI_INTERRUPT_CALLBACK_FUNCTION = callbackFunction;
 }
 
+/**
+ * @brief Clear TWINT with the TWI and its interrupt enabled, requesting the next master operation in the same write
+ *
+ * Unlike the blocking functions, TWCR is written in one go so no other bit is left over from the previous operation
+ *
+ * @param control										Any of (1<<TWSTA), (1<<TWSTO) and (1<<TWEA), or 0
+ *
+ * @return void
+ */
+static inline void MasterControl(uint8_t control)
+{
+	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWIE) | control;
+}
+
+/**
+ * @brief End the head transaction, then start the next queued one or release the bus
+ *
+ * Called inside the TWI ISR
+ *
+ * @param status										Final status of the transaction
+ * @param control										Operation ending the transaction: (1<<TWSTO) to send a STOP CONDITION, or 0 when the bus is not owned anymore (arbitration lost)
+ *
+ * @return void
+ */
+static void MasterFinishTransaction(EN_TWI_TRANSACTION_STATUS_t status, uint8_t control)
+{
+	ST_TWI_transaction_t* transaction = gs_masterQueue[gs_masterQueueHead & TWI_MASTER_TRANSACTION_QUEUE_MASK];
+	gs_masterQueueHead++;
+	gs_masterArbitrationRetries = 0;
+	transaction->status = status;
+	
+	// The callback may queue a transaction, it is still only started below since the master is busy
+	if(transaction->callback != 0)
+	{
+		transaction->callback(transaction);
+	}
+	
+	if(gs_masterQueueHead == gs_masterQueueTail)
+	{
+		gs_masterBusy = false;
+		MasterControl(control);
+	}
+	else if(status == TWI_TRANSACTION_BUS_ERROR)
+	{
+		// TWSTO only resets the TWI hardware after a bus error, no STOP CONDITION is sent so it clears right away
+		MasterControl(control);
+		while(TWCR & (1<<TWSTO));		// Busy wait
+		MasterControl(1<<TWSTA);
+	}
+	else
+	{
+		// STOP CONDITION followed by a START CONDITION, or a START CONDITION as soon as the bus becomes free
+		MasterControl(control | (1<<TWSTA));
+	}
+}
+
+/**
+ * @brief Run the head transaction one operation further, based on the TWI status of the operation that just ended
+ *
+ * Called inside the TWI ISR while gs_masterBusy is set
+ *
+ * @return void
+ */
+static void MasterTransactionStep()
+{
+	ST_TWI_transaction_t* transaction = gs_masterQueue[gs_masterQueueHead & TWI_MASTER_TRANSACTION_QUEUE_MASK];
+	
+	switch(TWSR & TWI_TWSR_STATUS_BITS_MASK)
+	{
+		// Address the slave, for writing unless there is only something to read
+		case TWI_START_SENT_STATE:
+			gs_masterDataIndex = 0;
+			TWDR = (transaction->writeSize == 0 && transaction->readSize != 0) ? (transaction->slaveAddress | TWI_READ_BIT) : (transaction->slaveAddress | TWI_WRITE_BIT);
+			MasterControl(0);
+			break;
+		
+		// Only sent between the write part and the read part
+		case TWI_REPEATED_START_SENT_STATE:
+			gs_masterDataIndex = 0;
+			TWDR = transaction->slaveAddress | TWI_READ_BIT;
+			MasterControl(0);
+			break;
+		
+		// Write the next byte, then switch to reading or stop
+		case TWI_SLAVE_ADDRESS_W_SENT_ACK_RECEIVED_STATE:
+		case TWI_MASTER_DATA_SENT_ACK_RECEIVED_STATE:
+			if(gs_masterDataIndex < transaction->writeSize)
+			{
+				TWDR = transaction->writeData[gs_masterDataIndex++];
+				MasterControl(0);
+			}
+			else if(transaction->readSize != 0)
+			{
+				MasterControl(1<<TWSTA);
+			}
+			else
+			{
+				MasterFinishTransaction(TWI_TRANSACTION_COMPLETE, 1<<TWSTO);
+			}
+			break;
+		
+		case TWI_MASTER_DATA_SENT_NACK_RECEIVED_STATE:
+			// A slave may refuse the last byte, as it is not expecting more
+			if(gs_masterDataIndex == transaction->writeSize && transaction->readSize == 0)
+			{
+				MasterFinishTransaction(TWI_TRANSACTION_COMPLETE, 1<<TWSTO);
+			}
+			else
+			{
+				MasterFinishTransaction(TWI_TRANSACTION_DATA_NACK, 1<<TWSTO);
+			}
+			break;
+		
+		case TWI_SLAVE_ADDRESS_W_SENT_NACK_RECEIVED_STATE:
+		case TWI_SLAVE_ADDRESS_R_SENT_NACK_RECEIVED_STATE:
+			MasterFinishTransaction(TWI_TRANSACTION_SLAVE_ADDRESS_NACK, 1<<TWSTO);
+			break;
+		
+		// Receive the first byte, ACK it unless it is the last one
+		case TWI_SLAVE_ADDRESS_R_SENT_ACK_RECEIVED_STATE:
+			MasterControl((transaction->readSize > 1) ? (1<<TWEA) : 0);
+			break;
+		
+		case TWI_MASTER_DATA_RECEIVED_ACK_SENT_STATE:
+			transaction->readData[gs_masterDataIndex++] = TWDR;
+			MasterControl((gs_masterDataIndex < transaction->readSize - 1) ? (1<<TWEA) : 0);
+			break;
+		
+		case TWI_MASTER_DATA_RECEIVED_NACK_SENT_STATE:
+			transaction->readData[gs_masterDataIndex++] = TWDR;
+			MasterFinishTransaction(TWI_TRANSACTION_COMPLETE, 1<<TWSTO);
+			break;
+		
+		// The bus is released, restart the whole transaction once it becomes free
+		case TWI_MASTER_ARBITRATION_LOST_STATE:
+			if(gs_masterArbitrationRetries < TWI_MASTER_ARBITRATION_RETRIES)
+			{
+				gs_masterArbitrationRetries++;
+				MasterControl(1<<TWSTA);
+			}
+			else
+			{
+				MasterFinishTransaction(TWI_TRANSACTION_ARBITRATION_LOST, 0);
+			}
+			break;
+		
+		// Bus error (0x00), or addressed as a slave after losing arbitration. TWSTO resets the TWI hardware and releases the bus in both cases
+		default:
+			MasterFinishTransaction(TWI_TRANSACTION_BUS_ERROR, 1<<TWSTO);
+			break;
+	}
+}
+
+/**
+ * @brief Handle the TWI slave events of the register bank. Called inside the TWI ISR as the TWI interrupt callback
+ *
+ * @return void
+ */
+static void RegisterBankInterruptHandler()
+{
+	uint8_t data = 0;
+	
+	switch(TWSR & TWI_TWSR_STATUS_BITS_MASK)
+	{
+		// Slave receiver mode, the register address comes first
+		case TWI_SLAVE_ADDRESS_W_RECEIVED_STATE:
+			gs_registerBankPointerReceived = false;
+			TWI_slave_receive(0, TWI_ACK, true);
+			break;
+		
+		case TWI_SLAVE_DATA_RECEIVED_ACK_SENT_STATE:
+			data = TWDR;
+			if(!gs_registerBankPointerReceived)
+			{
+				gs_registerBankPointer = data;
+				gs_registerBankPointerReceived = true;
+			}
+			else
+			{
+				if(gs_registerBankPointer < gs_registerBankSize && gs_registerBankWritableMask != 0
+				   && (gs_registerBankWritableMask[gs_registerBankPointer >> 3] & (1 << (gs_registerBankPointer & 7))))
+				{
+					gs_registerBank[gs_registerBankPointer] = data;
+					if(gs_registerBankWriteCallback != 0)
+					{
+						gs_registerBankWriteCallback(gs_registerBankPointer, data);
+					}
+				}
+				// Stop at the last address, writing past the end of the bank is ignored
+				if(gs_registerBankPointer != UINT8_MAX)
+				{
+					gs_registerBankPointer++;
+				}
+			}
+			TWI_slave_receive(0, TWI_ACK, true);
+			break;
+		
+		// Slave transmitter mode, send the registers from the pointer on until the master NACKs. The whole transaction reads the buffer latched here
+		case TWI_SLAVE_ADDRESS_R_RECEIVED_STATE:
+			if(gs_registerBankSnapshots)
+			{
+				gs_snapshotLatched = gs_snapshotSequence & 1;
+				gs_registerBankReadBuffer = gs_registerBank + gs_snapshotLatched * gs_registerBankSize;
+			}
+			else
+			{
+				gs_registerBankReadBuffer = gs_registerBank;
+			}
+			// Fall through
+		case TWI_SLAVE_DATA_SENT_ACK_RECEIVED_STATE:
+			TWI_slave_transmit((gs_registerBankPointer < gs_registerBankSize) ? gs_registerBankReadBuffer[gs_registerBankPointer] : TWI_REGISTER_BANK_UNMAPPED_VALUE, true);
+			if(gs_registerBankPointer != UINT8_MAX)
+			{
+				gs_registerBankPointer++;
+			}
+			break;
+		
+		// End of the transaction, listen for own slave address again
+		case TWI_SLAVE_DATA_RECEIVED_NACK_SENT_STATE:
+		case TWI_SLAVE_DATA_SENT_NACK_RECEIVED_STATE:
+		case TWI_SLAVE_STO_RSTA_RECEIVED_STATE:
+			gs_snapshotLatched = TWI_SNAPSHOT_NOT_LATCHED;
+			TWI_slave_listen(true);
+			break;
+		
+		// Bus error (0x00) or unexpected status. TWSTO resets the TWI hardware and releases the bus, the slave keeps listening
+		default:
+			gs_snapshotLatched = TWI_SNAPSHOT_NOT_LATCHED;
+			TWCR = (1<<TWINT) | (1<<TWSTO) | (1<<TWEA) | (1<<TWEN) | (1<<TWIE);
+			break;
+	}
+}
+
+void TWI_slave_initRegisterBank(uint8_t slaveAddress, volatile uint8_t* registers, uint8_t size, const uint8_t* writableMask, void(*writeCallback)(uint8_t address, uint8_t value))
+{
+	gs_registerBank = registers;
+	gs_registerBankSize = size;
+	gs_registerBankWritableMask = writableMask;
+	gs_registerBankWriteCallback = writeCallback;
+	gs_registerBankPointer = 0;
+	gs_registerBankPointerReceived = false;
+	gs_registerBankReadBuffer = registers;
+	gs_registerBankSnapshots = false;
+	
+	TWI_slave_init(slaveAddress);
+	TWI_setInterruptCallback(RegisterBankInterruptHandler);
+	TWI_slave_listen(true);
+}
+
+void TWI_slave_initSnapshotRegisterBank(uint8_t slaveAddress, uint8_t* buffers, uint8_t size)
+{
+	gs_snapshotSequence = 0;
+	gs_snapshotLatched = TWI_SNAPSHOT_NOT_LATCHED;
+	
+	// Read-only, the master can't write to a snapshot
+	TWI_slave_initRegisterBank(slaveAddress, buffers, size, 0, 0);
+	gs_registerBankSnapshots = true;
+}
+
+uint8_t* TWI_slave_beginSnapshot()
+{
+	uint8_t back = (gs_snapshotSequence & 1) ^ 1;
+	
+	// The ISR only latches the published buffer, so once the back buffer is seen free it stays free until it is published
+	if(gs_snapshotLatched == back)
+	{
+		return 0;
+	}
+	
+	return (uint8_t*)gs_registerBank + back * gs_registerBankSize;
+}
+
+void TWI_slave_publishSnapshot()
+{
+	// Make sure the snapshot is written to the buffer before it is published
+	__asm__ __volatile__ ("" ::: "memory");
+	
+	gs_snapshotSequence++;
+}
+
+void TWI_master_initTransaction(ST_TWI_transaction_t* transaction, uint8_t slaveAddress, const uint8_t* writeData, uint8_t writeSize,
+								uint8_t* readData, uint8_t readSize, void(*callback)(ST_TWI_transaction_t* transaction))
+{
+	transaction->slaveAddress = slaveAddress;
+	transaction->writeData = writeData;
+	transaction->writeSize = writeSize;
+	transaction->readData = readData;
+	transaction->readSize = readSize;
+	transaction->callback = callback;
+	transaction->status = TWI_TRANSACTION_IDLE;
+}
+
+bool TWI_master_queueTransaction(ST_TWI_transaction_t* transaction)
+{
+	bool queued = false;
+	
+	// The ISR pops the queue and decides whether the bus is still busy, don't let it run in between
+	uint8_t savedStatus = SREG;
+	cli();
+	
+	if(transaction->status != TWI_TRANSACTION_PENDING && (uint8_t)(gs_masterQueueTail - gs_masterQueueHead) < TWI_MASTER_TRANSACTION_QUEUE_SIZE)
+	{
+		transaction->status = TWI_TRANSACTION_PENDING;
+		gs_masterQueue[gs_masterQueueTail & TWI_MASTER_TRANSACTION_QUEUE_MASK] = transaction;
+		gs_masterQueueTail++;
+		queued = true;
+		
+		// Otherwise the ISR starts it after the transactions before it
+		if(!gs_masterBusy)
+		{
+			gs_masterBusy = true;
+			gs_masterArbitrationRetries = 0;
+			// Transmit a START CONDITION as soon as the bus becomes free, the rest is run from the ISR
+			MasterControl(1<<TWSTA);
+		}
+	}
+	
+	SREG = savedStatus;
+	
+	return queued;
+}
+
+bool TWI_master_isBusy()
+{
+	return gs_masterBusy;
+}
+
 ISR(TWI_VECTOR)
 {
+	if(gs_masterBusy)
+	{
+		MasterTransactionStep();
+	}
 	// Make sure that the callback function is not NULL
-	if(TWI_INTERRUPT_CALLBACK_FUNCTION != 0)
+	else if(TWI_INTERRUPT_CALLBACK_FUNCTION != 0)
 	{
 		TWI_INTERRUPT_CALLBACK_FUNCTION();
 	}
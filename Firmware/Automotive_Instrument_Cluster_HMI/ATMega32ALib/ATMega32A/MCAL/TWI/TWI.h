@@ -15,6 +15,19 @@
 // Mask for TWSR status 5-bits, the higher 5-bits
 #define TWI_TWSR_STATUS_BITS_MASK 0xF8
 
+/**
+ * Max number of master transactions waiting for the bus, see TWI_master_queueTransaction().
+ * **MUST** be a power of two, up to 128
+ */
+#ifndef TWI_MASTER_TRANSACTION_QUEUE_SIZE
+#define TWI_MASTER_TRANSACTION_QUEUE_SIZE 8
+#endif
+
+// Times a master transaction restarts after losing arbitration to another master before it fails with TWI_TRANSACTION_ARBITRATION_LOST
+#ifndef TWI_MASTER_ARBITRATION_RETRIES
+#define TWI_MASTER_ARBITRATION_RETRIES 3
+#endif
+
 #define TWI_WRITE_BIT				0
 #define TWI_READ_BIT				1
 #define TWI_ACK						0
@@ -75,6 +88,43 @@ typedef enum EN_TWI_EVENT_STATUS_t
 	
 } EN_TWI_EVENT_STATUS_t;
 
+// Size in bytes of the writable mask of a register bank of SIZE registers, see TWI_slave_initRegisterBank()
+#define TWI_REGISTER_BANK_MASK_SIZE(SIZE) (((SIZE) + 7) / 8)
+
+// Value read past the end of a register bank
+#define TWI_REGISTER_BANK_UNMAPPED_VALUE 0xFF
+
+typedef enum EN_TWI_TRANSACTION_STATUS_t
+{
+	TWI_TRANSACTION_IDLE,					// Initialized, never queued
+	TWI_TRANSACTION_PENDING,				// Queued or running on the bus
+	TWI_TRANSACTION_COMPLETE,				// Every byte written and read
+	TWI_TRANSACTION_SLAVE_ADDRESS_NACK,		// No slave answered the slave address
+	TWI_TRANSACTION_DATA_NACK,				// The slave refused a written byte before the last one
+	TWI_TRANSACTION_ARBITRATION_LOST,		// Lost arbitration to another master more than TWI_MASTER_ARBITRATION_RETRIES times
+	TWI_TRANSACTION_BUS_ERROR				// Illegal START/STOP condition or unexpected status, the TWI hardware was reset
+} EN_TWI_TRANSACTION_STATUS_t;
+
+/**
+ * A master transaction run from the TWI ISR, see TWI_master_queueTransaction():
+ *
+ * START CONDITION -> slave address + Write -> writeSize bytes of writeData -> REPEATED START CONDITION
+ * -> slave address + Read -> readSize bytes into readData (ACK after each byte, NACK after the last one) -> STOP CONDITION
+ *
+ * The write part is skipped when writeSize is 0, the read part when readSize is 0.
+ * The transaction, writeData and readData are owned by the caller and **MUST** stay valid until the transaction is not pending anymore
+ */
+typedef struct ST_TWI_transaction_t
+{
+	uint8_t slaveAddress;			// Slave address in the TWAR format (7-bit address shifted left), e.g. 0xA0
+	const uint8_t* writeData;
+	uint8_t writeSize;
+	uint8_t* readData;
+	uint8_t readSize;
+	void(*callback)(struct ST_TWI_transaction_t* transaction);		// Called inside the TWI ISR once the transaction is not pending anymore, can be NULL
+	volatile EN_TWI_TRANSACTION_STATUS_t status;
+} ST_TWI_transaction_t;
+
 
 /**
  * @brief Initialize TWI in master mode
@@ -179,6 +229,101 @@ EN_TWI_EVENT_STATUS_t TWI_master_transmit(uint8_t data, bool interruptHandled);
  */
 EN_TWI_EVENT_STATUS_t TWI_master_receive(uint8_t* receivedData, uint8_t response, bool interruptHandled);
 
+/**
+ * @brief Fill a master transaction, see ST_TWI_transaction_t
+ *
+ * @param transaction											Transaction to fill, its status is set to TWI_TRANSACTION_IDLE
+ * @param slaveAddress											Slave address in the TWAR format (7-bit address shifted left)
+ * @param writeData												Bytes to write to the slave, can be NULL if @param writeSize is 0
+ * @param writeSize												Number of bytes to write
+ * @param readData												Buffer the bytes read from the slave are written to, can be NULL if @param readSize is 0
+ * @param readSize												Number of bytes to read
+ * @param callback												Function called inside the TWI ISR when the transaction ends, can be NULL to poll the status instead
+ *
+ * @return void
+ */
+void TWI_master_initTransaction(ST_TWI_transaction_t* transaction, uint8_t slaveAddress, const uint8_t* writeData, uint8_t writeSize,
+								uint8_t* readData, uint8_t readSize, void(*callback)(ST_TWI_transaction_t* transaction));
+
+/**
+ * @brief Queue a master transaction, it is run entirely from the TWI ISR **No Busy Wait**
+ *
+ * Function is called after TWI has been initialized in master mode, with the global interrupts enabled.
+ * Transactions run one after another in the order they are queued, chained with a STOP CONDITION followed by a START CONDITION.
+ * The blocking TWI_master_* functions **MUST NOT** be used while a transaction is pending.
+ * Can be called from the transaction callback to queue the next one
+ *
+ * @param transaction											Transaction to run, its status is TWI_TRANSACTION_PENDING until it ends
+ *
+ * @return true													Transaction queued
+ * @return false												The queue is full or the transaction is already pending
+ */
+bool TWI_master_queueTransaction(ST_TWI_transaction_t* transaction);
+
+/**
+ * @brief Check if queued master transactions are running on the bus
+ *
+ * @return true if a transaction is pending
+ */
+bool TWI_master_isBusy();
+
+/**
+ * @brief Initialize TWI in slave mode serving a register bank, run entirely from the TWI ISR **No Busy Wait**
+ *
+ * The register bank is a contiguous byte map with a register pointer, the pointer auto-increments after each byte read or written:
+ *
+ * START CONDITION -> Own slave address + Write -> register address (sets the pointer) -> data bytes written from the pointer on -> STOP CONDITION
+ * START CONDITION -> Own slave address + Read -> data bytes read from the pointer on -> NACK -> STOP CONDITION
+ *
+ * Usually the master writes the register address then reads after a REPEATED START CONDITION, reading the whole bank in one burst.
+ * Bytes written to read-only registers are ignored, reading past the end of the bank returns 0xFF.
+ * Function sets the TWI interrupt callback, enables the TWI interrupt and the global interrupts, and starts listening for own slave address
+ *
+ * @param slaveAddress											Device's own 7-bit slave address, with will be used buy other masters to address this device
+ * @param registers												The register bank, the main program updates the read-only registers in it
+ * @param size													Number of registers
+ * @param writableMask											Bit (address % 8) of writableMask[address / 8] is set for each register the master can write, see TWI_REGISTER_BANK_MASK_SIZE. Can be NULL for a read-only bank
+ * @param writeCallback											Function called inside the TWI ISR after the master wrote a register, with its address and new value. Can be NULL
+ *
+ * @return void
+ */
+void TWI_slave_initRegisterBank(uint8_t slaveAddress, volatile uint8_t* registers, uint8_t size, const uint8_t* writableMask, void(*writeCallback)(uint8_t address, uint8_t value));
+
+/**
+ * @brief Initialize TWI in slave mode serving a read-only register bank published as whole snapshots, run entirely from the TWI ISR **No Busy Wait**
+ *
+ * Same transactions as TWI_slave_initRegisterBank(), but the bank is double buffered: the main program fills the back buffer (TWI_slave_beginSnapshot())
+ * and publishes it in one go (TWI_slave_publishSnapshot()), while the TWI ISR latches the published buffer at the start of each read transaction.
+ * So the master always reads registers of one single snapshot, never half old and half new values
+ *
+ * @param slaveAddress											Device's own 7-bit slave address, with will be used buy other masters to address this device
+ * @param buffers												The two buffers of the bank, back to back (2 * @param size bytes), e.g. uint8_t buffers[2][size]
+ * @param size													Number of registers
+ *
+ * @return void
+ */
+void TWI_slave_initSnapshotRegisterBank(uint8_t slaveAddress, uint8_t* buffers, uint8_t size);
+
+/**
+ * @brief Get the buffer to fill with the next snapshot of a snapshot register bank
+ *
+ * The buffer holds the snapshot before the published one, every register **MUST** be written before TWI_slave_publishSnapshot() is called.
+ * Never waits for the bus: the buffer can't be filled while the master is still reading it, the caller skips this snapshot then
+ *
+ * @return Buffer of the snapshot register bank size
+ * @return NULL													The TWI ISR is still sending this buffer (the master is reading the snapshot before the published one)
+ */
+uint8_t* TWI_slave_beginSnapshot();
+
+/**
+ * @brief Publish the buffer filled after TWI_slave_beginSnapshot(), the next read transactions send it
+ *
+ * A read transaction already running keeps sending the snapshot it latched
+ *
+ * @return void
+ */
+void TWI_slave_publishSnapshot();
+
 /**
  * @brief Initialize TWI in slave mode
  * 
@@ -259,7 +404,8 @@ uint8_t TWI_getStatus();
 /**
  * @brief Set a callback function to be called inside the ISR for TWI interrupt
  *
- * Function enables the TWI interrupt and the global interrupts
+ * Function enables the TWI interrupt and the global interrupts.
+ * The callback is not called while master transactions are pending, the ISR runs them instead (see TWI_master_queueTransaction())
  * 
  * @param callbackFunction				void function will be called when the ISR for the TWI interrupt is called
  *
@@ -29,9 +29,59 @@
 */
 #define UBRR_FROM_BAUD_RATE(BAUD_RATE) (((F_CPU * 1.0 / (BAUD_RATE* 16UL))) - 1)
 
+#define UART_TRANSMIT_BUFFER_MASK (UART_TRANSMIT_BUFFER_SIZE - 1)
+
+#define UART_RECEIVE_BUFFER_MASK (UART_RECEIVE_BUFFER_SIZE - 1)
+
+#if (UART_TRANSMIT_BUFFER_SIZE & UART_TRANSMIT_BUFFER_MASK) != 0 || UART_TRANSMIT_BUFFER_SIZE > 128
+# error "UART_TRANSMIT_BUFFER_SIZE must be a power of two, up to 128"
+#endif
+
+#if (UART_RECEIVE_BUFFER_SIZE & UART_RECEIVE_BUFFER_MASK) != 0 || UART_RECEIVE_BUFFER_SIZE > 128
+# error "UART_RECEIVE_BUFFER_SIZE must be a power of two, up to 128"
+#endif
+
+// Increment an 8-bit counter, stopping at 255
+#define SATURATING_INCREMENT(COUNTER) if((COUNTER) != UINT8_MAX) { (COUNTER)++; }
+
 /* UART Callback Functions */
 static void(*ON_RECEIVE_CALLBACK_FUNCTION)(uint8_t) = NULL;	// Initialize the function pointer to NULL 
 
+/**
+ * Transmit ring buffer, filled by UART_write() and drained by the USART Data Register Empty ISR.
+ * The head is only written by the main program and the tail only by the ISR, single byte writes are atomic so neither side needs to disable the interrupts.
+ * Both indexes run freely and wrap around at 256, the number of queued bytes is their difference
+ */
+static volatile uint8_t gs_transmitBuffer[UART_TRANSMIT_BUFFER_SIZE];
+static volatile uint8_t gs_transmitHead = 0;
+static volatile uint8_t gs_transmitTail = 0;
+/**
+ * Receive ring buffer, filled by the USART reception complete ISR and drained by UART_read().
+ * The head is only written by the ISR and the tail only by the main program, same as the transmit ring buffer the other way around
+ */
+static volatile uint8_t gs_receiveBuffer[UART_RECEIVE_BUFFER_SIZE];
+static volatile uint8_t gs_receiveHead = 0;
+static volatile uint8_t gs_receiveTail = 0;
+static volatile ST_UART_receiveErrors_t gs_receiveErrors = { 0, 0, 0 };
+
+// A byte was written to UDR since the last UART_flush(), its TXC flag tells when it is shifted out
+static volatile bool gs_transmitting = false;
+
+/**
+ * @brief Write a byte to UDR and clear the transmit complete flag, so TXC is only set again once this byte is shifted out
+ *
+ * @param data						A byte of data to be transmitted
+ *
+ * @return void
+ */
+static inline void WriteDataRegister(uint8_t data)
+{
+	// TXC is cleared by writing one to it, keep U2X and MPCM as they are and write zero to the other flags
+	UCSRA = (UCSRA & ((1<<U2X) | (1<<MPCM))) | (1<<TXC);
+	UDR = data;
+	gs_transmitting = true;
+}
+
 
 void UART_init(uint32_t baudRate)
 {
@@ -60,11 +110,14 @@ uint8_t UART_receive()
 
 void UART_transmit(uint8_t data)
 {
+	// Wait for the queued bytes to be transmitted first, the ISR disables its interrupt once the ring buffer is empty
+	while(UCSRB & (1<<UDRIE)); // Busy wait
+	
 	// Wait for the transmit buffer to be empty (UDR), so it can receive new data to be transmitted
 	while(!(UCSRA & (1<<UDRE))); // Busy wait
 	
 	// Write the data into the buffer, which automatically starts sending the data
-	UDR = data;
+	WriteDataRegister(data);
 }
 
 void UART_transmitString(const uint8_t* string)
@@ -78,6 +131,243 @@ void UART_transmitString(const uint8_t* string)
 	UART_transmit('\0');
 }
 
+uint8_t UART_write(const uint8_t* data, uint8_t size)
+{
+	uint8_t freeSpace = UART_transmitBufferFreeSpace();
+	if(size > freeSpace)
+	{
+		size = freeSpace;
+	}
+	
+	if(size == 0)
+	{
+		return 0;
+	}
+	
+	uint8_t head = gs_transmitHead;
+	for(uint8_t i = 0; i < size; i++)
+	{
+		gs_transmitBuffer[head & UART_TRANSMIT_BUFFER_MASK] = data[i];
+		head++;
+	}
+	// Publish the bytes to the ISR only once they are all in the ring buffer
+	gs_transmitHead = head;
+	
+	// Enable USART Data Register Empty interrupt, it fires right away if UDR is empty
+	UCSRB |= (1<<UDRIE);
+	
+	return size;
+}
+
+bool UART_transmitBuffer(const uint8_t* data, uint8_t size)
+{
+	if(size > UART_transmitBufferFreeSpace())
+	{
+		return false;
+	}
+	
+	UART_write(data, size);
+	return true;
+}
+
+uint8_t UART_transmitBufferFreeSpace()
+{
+	return UART_TRANSMIT_BUFFER_SIZE - (uint8_t)(gs_transmitHead - gs_transmitTail);
+}
+
+void UART_flush()
+{
+	// Wait for the ring buffer to be drained, the ISR disables its interrupt once it's empty
+	while(UCSRB & (1<<UDRIE)); // Busy wait
+	
+	// Wait for the last byte written to UDR to be shifted out
+	if(gs_transmitting)
+	{
+		while(!(UCSRA & (1<<TXC))); // Busy wait
+		gs_transmitting = false;
+	}
+}
+
+void UART_enableReceiveBuffer()
+{
+	// The ISR buffers the received bytes when no callback function is hooked. The pointer takes two writes, don't let the ISR see half of it
+	uint8_t savedStatus = SREG;
+	cli();
+	ON_RECEIVE_CALLBACK_FUNCTION = NULL;
+	SREG = savedStatus;
+	
+	// Enable RX complete interrupt
+	UCSRB |= (1 << RXCIE);
+	
+	// Enable global interrupt
+	sei();
+}
+
+uint8_t UART_read(uint8_t* buffer, uint8_t size)
+{
+	uint8_t tail = gs_receiveTail;
+	uint8_t available = (uint8_t)(gs_receiveHead - tail);
+	if(size > available)
+	{
+		size = available;
+	}
+	
+	for(uint8_t i = 0; i < size; i++)
+	{
+		buffer[i] = gs_receiveBuffer[tail & UART_RECEIVE_BUFFER_MASK];
+		tail++;
+	}
+	// Hand the slots back to the ISR only once the bytes are copied
+	gs_receiveTail = tail;
+	
+	return size;
+}
+
+uint8_t UART_receiveBufferSize()
+{
+	return (uint8_t)(gs_receiveHead - gs_receiveTail);
+}
+
+void UART_getReceiveErrors(ST_UART_receiveErrors_t* errors)
+{
+	// The ISR may update the counters meanwhile, read and reset them with the interrupts disabled
+	uint8_t savedStatus = SREG;
+	cli();
+	
+	errors->dataOverruns = gs_receiveErrors.dataOverruns;
+	errors->bufferOverruns = gs_receiveErrors.bufferOverruns;
+	errors->frameErrors = gs_receiveErrors.frameErrors;
+	gs_receiveErrors.dataOverruns = 0;
+	gs_receiveErrors.bufferOverruns = 0;
+	gs_receiveErrors.frameErrors = 0;
+	
+	// Restore the global interrupt state
+	SREG = savedStatus;
+}
+
+void UART_frameAssembler_initDelimited(ST_UART_frameAssembler_t* assembler, uint8_t* buffer, uint8_t capacity, uint8_t delimiter)
+{
+	assembler->buffer = buffer;
+	assembler->capacity = capacity;
+	assembler->mode = UART_FRAME_DELIMITED;
+	assembler->delimiter = delimiter;
+	assembler->oversizedFrames = 0;
+	UART_frameAssembler_reset(assembler);
+}
+
+void UART_frameAssembler_initLengthPrefixed(ST_UART_frameAssembler_t* assembler, uint8_t* buffer, uint8_t capacity)
+{
+	assembler->buffer = buffer;
+	assembler->capacity = capacity;
+	assembler->mode = UART_FRAME_LENGTH_PREFIXED;
+	assembler->delimiter = 0;
+	assembler->oversizedFrames = 0;
+	UART_frameAssembler_reset(assembler);
+}
+
+void UART_frameAssembler_reset(ST_UART_frameAssembler_t* assembler)
+{
+	assembler->size = 0;
+	assembler->expectedSize = 0;
+	assembler->complete = false;
+	assembler->discarding = false;
+}
+
+uint8_t UART_frameAssembler_poll(ST_UART_frameAssembler_t* assembler)
+{
+	// The frame returned by the last poll has been handled by now
+	if(assembler->complete)
+	{
+		UART_frameAssembler_reset(assembler);
+	}
+	
+	uint8_t tail = gs_receiveTail;
+	uint8_t head = gs_receiveHead;
+	
+	while(tail != head)
+	{
+		uint8_t data = gs_receiveBuffer[tail & UART_RECEIVE_BUFFER_MASK];
+		tail++;
+		
+		if(assembler->mode == UART_FRAME_DELIMITED)
+		{
+			if(data == assembler->delimiter)
+			{
+				// End of a frame too long for the buffer, or of an empty frame. Start over with the next byte
+				if(assembler->discarding || assembler->size == 0)
+				{
+					assembler->discarding = false;
+					assembler->size = 0;
+					continue;
+				}
+				
+				assembler->complete = true;
+				break;
+			}
+			
+			if(assembler->discarding)
+			{
+				continue;
+			}
+			
+			if(assembler->size == assembler->capacity)
+			{
+				// Too long, skip the rest of the frame up to its delimiter
+				SATURATING_INCREMENT(assembler->oversizedFrames);
+				assembler->discarding = true;
+				continue;
+			}
+			
+			assembler->buffer[assembler->size++] = data;
+		}
+		else
+		{
+			// Waiting for the length byte of the next frame
+			if(assembler->expectedSize == 0 && !assembler->discarding)
+			{
+				if(data == 0)
+				{
+					// Empty frame
+					continue;
+				}
+				
+				assembler->expectedSize = data;
+				assembler->size = 0;
+				if(data > assembler->capacity)
+				{
+					// Too long, skip its bytes
+					SATURATING_INCREMENT(assembler->oversizedFrames);
+					assembler->discarding = true;
+				}
+				continue;
+			}
+			
+			if(assembler->discarding)
+			{
+				assembler->size++;
+				if(assembler->size == assembler->expectedSize)
+				{
+					assembler->discarding = false;
+					assembler->expectedSize = 0;
+				}
+				continue;
+			}
+			
+			assembler->buffer[assembler->size++] = data;
+			if(assembler->size == assembler->expectedSize)
+			{
+				assembler->complete = true;
+				break;
+			}
+		}
+	}
+	
+	// Hand the consumed bytes back to the ISR, the ones after a complete frame stay for the next poll
+	gs_receiveTail = tail;
+	
+	return assembler->complete ? assembler->size : 0;
+}
+
 void UART_onReceive(void(*onReceiveCallbackFunction)(uint8_t))
 {
 	// Enable RX complete interrupt
@@ -92,13 +382,53 @@ void UART_onReceive(void(*onReceiveCallbackFunction)(uint8_t))
 
 ISR(USART_RECEPTION_COMPLETE_VECTOR)
 {
+	// Read the error flags before UDR, reading UDR clears them. Reading UDR also clears the interrupt flag
+	uint8_t status = UCSRA;
+	uint8_t data = UDR;
+	
+	if(status & (1<<DOR))
+	{
+		SATURATING_INCREMENT(gs_receiveErrors.dataOverruns);
+	}
+	if(status & (1<<FE))
+	{
+		SATURATING_INCREMENT(gs_receiveErrors.frameErrors);
+	}
+	
 	// Safe check that the callback function is not NULL
 	if(ON_RECEIVE_CALLBACK_FUNCTION != NULL)
 	{
 		// Call the callback function with the received byte of data
-		ON_RECEIVE_CALLBACK_FUNCTION(UDR);
+		ON_RECEIVE_CALLBACK_FUNCTION(data);
+		return;
 	}
 	
-	// Clear the interrupt flag
-	UCSRA |= (1<<RXC);
+	// Buffer the byte, or drop it if the main loop hasn't read the ring buffer in time
+	uint8_t head = gs_receiveHead;
+	if((uint8_t)(head - gs_receiveTail) == UART_RECEIVE_BUFFER_SIZE)
+	{
+		SATURATING_INCREMENT(gs_receiveErrors.bufferOverruns);
+		return;
+	}
+	gs_receiveBuffer[head & UART_RECEIVE_BUFFER_MASK] = data;
+	gs_receiveHead = head + 1;
+}
+
+ISR(USART_DATA_REGISTER_EMPTY_VECTOR)
+{
+	uint8_t tail = gs_transmitTail;
+	
+	if(tail != gs_transmitHead)
+	{
+		// Transmit the oldest queued byte
+		WriteDataRegister(gs_transmitBuffer[tail & UART_TRANSMIT_BUFFER_MASK]);
+		tail++;
+		gs_transmitTail = tail;
+	}
+	
+	// Nothing left to transmit, disable the interrupt until UART_write() queues more bytes (it would fire again right away as UDR stays empty)
+	if(tail == gs_transmitHead)
+	{
+		UCSRB &= ~(1<<UDRIE);
+	}
 }
\ No newline at end of file
@@ -10,6 +10,55 @@
 #define UART_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Size in bytes of the transmit ring buffer drained by the USART Data Register Empty ISR, see UART_write().
+ * **MUST** be a power of two, up to 128
+ */
+#ifndef UART_TRANSMIT_BUFFER_SIZE
+#define UART_TRANSMIT_BUFFER_SIZE 64
+#endif
+
+/**
+ * Size in bytes of the receive ring buffer filled by the USART reception complete ISR, see UART_read().
+ * **MUST** be a power of two, up to 128
+ */
+#ifndef UART_RECEIVE_BUFFER_SIZE
+#define UART_RECEIVE_BUFFER_SIZE 64
+#endif
+
+/**
+ * Reception errors counted by the USART reception complete ISR since the last UART_getReceiveErrors() call. The counters saturate at 255
+ */
+typedef struct ST_UART_receiveErrors_t
+{
+	uint8_t dataOverruns;		// Bytes lost by the UART hardware, the ISR didn't read UDR in time
+	uint8_t bufferOverruns;		// Bytes dropped because the receive ring buffer was full, the main loop didn't call UART_read() in time
+	uint8_t frameErrors;		// Bytes received without a valid stop bit, e.g. baud rate mismatch or line noise. They are still buffered
+} ST_UART_receiveErrors_t;
+
+typedef enum EN_UART_FRAME_MODE_t
+{
+	UART_FRAME_DELIMITED,		// Frames end with a delimiter byte, which is not part of the frame (e.g. DEVICE_DATA_FRAME_DELIMITER after a COBS encoded frame)
+	UART_FRAME_LENGTH_PREFIXED	// Frames start with their length (uint8), followed by that many bytes
+} EN_UART_FRAME_MODE_t;
+
+/**
+ * Assembles received bytes into frames in the main loop, see UART_frameAssembler_poll(). The fields are private to the UART driver
+ */
+typedef struct ST_UART_frameAssembler_t
+{
+	uint8_t* buffer;
+	uint8_t capacity;
+	uint8_t size;
+	EN_UART_FRAME_MODE_t mode;
+	uint8_t delimiter;
+	uint8_t expectedSize;		// Length prefixed frames: size of the frame being assembled, 0 until its length byte is received
+	bool complete;				// The frame in buffer was returned by the last poll, the next poll starts a new one
+	bool discarding;			// Skipping the rest of a frame longer than the buffer
+	uint8_t oversizedFrames;	// Frames discarded for being longer than the buffer, saturates at 255
+} ST_UART_frameAssembler_t;
 
 /**
  * @brief Initialize UART(Asynchronous Mode) in both transmission and reception mode in normal speed mode with frame format of [ 8 data bits | no parity | 1 stop bit ]
@@ -32,7 +81,8 @@ uint8_t UART_receive();
 /**
  * @brief Write/Transmit one byte of data
  * 
- * Function will not exit until the transmit buffer is empty, so it can write the byte of data to be transmitted **Uses Busy Wait**
+ * Function will not exit until the transmit buffer is empty, so it can write the byte of data to be transmitted **Uses Busy Wait**.
+ * Bytes queued by UART_write() are transmitted first, so the order of the bytes is kept
  *
  * @param data						A byte of data to be transmitted
  *
@@ -53,8 +103,138 @@ void UART_transmit(uint8_t data);
  */
 void UART_transmitString(const uint8_t* string);
 
+/**
+ * @brief Queue bytes to be transmitted, without waiting for them to be transmitted **No Busy Wait**
+ *
+ * The bytes are copied into the transmit ring buffer, then transmitted one by one from the USART Data Register Empty ISR.
+ * Only the bytes that fit in the free space of the ring buffer are queued.
+ * The global interrupts **MUST** be enabled for the queued bytes to be transmitted
+ *
+ * @param data						Bytes of data to be transmitted
+ * @param size						Number of bytes of data
+ *
+ * @return							Number of bytes queued, less than @param size if the ring buffer is full
+ */
+uint8_t UART_write(const uint8_t* data, uint8_t size);
+
+/**
+ * @brief Queue all the bytes to be transmitted or none of them, without waiting for them to be transmitted **No Busy Wait**
+ *
+ * Same as UART_write(), except that a frame is never cut short: nothing is queued if the bytes don't all fit in the free space of the ring buffer
+ *
+ * @param data						Bytes of data to be transmitted
+ * @param size						Number of bytes of data
+ *
+ * @return true						All the bytes are queued
+ * @return false					Not enough free space, nothing is queued
+ */
+bool UART_transmitBuffer(const uint8_t* data, uint8_t size);
+
+/**
+ * @brief Return the free space of the transmit ring buffer
+ *
+ * @return							Number of bytes that can be queued right now
+ */
+uint8_t UART_transmitBufferFreeSpace();
+
+/**
+ * @brief Wait for all the queued bytes to be transmitted, including the last one shifted out of the transmitter **Uses Busy Wait**
+ *
+ * The global interrupts **MUST** be enabled, otherwise the function never exits while bytes are queued
+ *
+ * @return void
+ */
+void UART_flush();
+
+/**
+ * @brief Buffer the received bytes in the receive ring buffer, from the USART reception complete ISR
+ *
+ * Function enables the RX complete interrupt and the global interrupts. The bytes are then read with UART_read() or assembled into frames with UART_frameAssembler_poll().
+ * Unhooks the UART_onReceive() callback, and UART_receive() **MUST** no longer be used
+ *
+ * @return void
+ */
+void UART_enableReceiveBuffer();
+
+/**
+ * @brief Read the bytes received so far, without waiting for more **No Busy Wait**
+ *
+ * @param buffer					Buffer the received bytes are copied to, in reception order
+ * @param size						Max number of bytes to read
+ *
+ * @return							Number of bytes read, 0 if none is waiting
+ */
+uint8_t UART_read(uint8_t* buffer, uint8_t size);
+
+/**
+ * @brief Return the number of received bytes waiting in the receive ring buffer
+ *
+ * @return							Number of bytes UART_read() can read right now
+ */
+uint8_t UART_receiveBufferSize();
+
+/**
+ * @brief Read and reset the reception error counters
+ *
+ * @param errors					Receives the errors counted since the last call
+ *
+ * @return void
+ */
+void UART_getReceiveErrors(ST_UART_receiveErrors_t* errors);
+
+/**
+ * @brief Initialize a frame assembler for frames ending with a delimiter byte
+ *
+ * Frames longer than the buffer are discarded up to the next delimiter, and empty frames (consecutive delimiters) are skipped.
+ * After lost bytes the assembler resynchronizes on the next delimiter
+ *
+ * @param assembler					Frame assembler to initialize
+ * @param buffer					Buffer the frames are assembled in
+ * @param capacity					Size of the buffer, the longest frame without its delimiter
+ * @param delimiter					Byte ending each frame
+ *
+ * @return void
+ */
+void UART_frameAssembler_initDelimited(ST_UART_frameAssembler_t* assembler, uint8_t* buffer, uint8_t capacity, uint8_t delimiter);
+
+/**
+ * @brief Initialize a frame assembler for frames starting with their length
+ *
+ * Frames longer than the buffer are discarded. Lost bytes can't be detected from the framing alone, call UART_frameAssembler_reset() to resynchronize
+ *
+ * @param assembler					Frame assembler to initialize
+ * @param buffer					Buffer the frames are assembled in, without their length byte
+ * @param capacity					Size of the buffer, the longest frame without its length byte
+ *
+ * @return void
+ */
+void UART_frameAssembler_initLengthPrefixed(ST_UART_frameAssembler_t* assembler, uint8_t* buffer, uint8_t capacity);
+
+/**
+ * @brief Drop the frame being assembled, the next received byte starts a new frame
+ *
+ * @param assembler					Frame assembler to reset
+ *
+ * @return void
+ */
+void UART_frameAssembler_reset(ST_UART_frameAssembler_t* assembler);
+
+/**
+ * @brief Move the received bytes into the frame being assembled, until it's complete or no byte is left **No Busy Wait**
+ *
+ * Meant to be called from the main loop, the ISR only buffers the bytes. The bytes after a complete frame stay in the receive ring buffer for the next poll.
+ * Requires UART_enableReceiveBuffer()
+ *
+ * @param assembler					Frame assembler to feed
+ *
+ * @return							Size of the complete frame in the assembler buffer (valid until the next poll), 0 if no frame is complete yet
+ */
+uint8_t UART_frameAssembler_poll(ST_UART_frameAssembler_t* assembler);
+
 /**
  * @brief Hook a callback function that gets called when a byte reception is complete
+ *
+ * While hooked, the received bytes are passed to the callback function instead of the receive ring buffer
  * 
  * @param onReceiveCallbackFunction		Callback function that gets called every time a byte is received, where the received byte is passed as a parameter to the function
  *
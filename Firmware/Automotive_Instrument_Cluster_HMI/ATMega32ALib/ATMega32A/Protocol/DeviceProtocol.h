@@ -0,0 +1,117 @@
+/*
+ * DeviceProtocol.h
+ *
+ *	Device data protocol shared by the firmware nodes and the Qt application (plain C, also compiles as C++)
+ *
+ * Created: 10/17/2026 2:14:08 PM
+ *  Author: MHamiid
+ */
+
+
+#ifndef DEVICEPROTOCOL_H_
+#define DEVICEPROTOCOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Device data frame (protocol v1), only sent by older HMI firmware:
+ *
+ * DEVICE_DATA_FRAME_V1_START_DELIMITER -> Device address -> Payload -> DEVICE_DATA_FRAME_V1_END_DELIMITER
+ */
+#define DEVICE_DATA_FRAME_V1_START_DELIMITER	 '|'
+#define DEVICE_DATA_FRAME_V1_END_DELIMITER		 '\r'
+
+/**
+ * Device data frame (protocol v2):
+ *
+ * COBS(Device address -> Sequence number -> Payload length -> Payload -> CRC-8) -> DEVICE_DATA_FRAME_DELIMITER
+ *
+ * COBS removes every DEVICE_DATA_FRAME_DELIMITER byte from the encoded frame, so the receiver can always tell payload bytes from the delimiter,
+ * the sequence number lets the receiver count lost frames and the CRC-8 (polynomial 0x07, initial value 0x00) rejects corrupted frames
+ */
+#define DEVICE_DATA_FRAME_DELIMITER				 0x00
+#define DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE		 4
+// Device address, sequence number, payload length, payload and CRC-8
+#define DEVICE_DATA_FRAME_MAX_SIZE				 (3 + DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE + 1)
+#define DEVICE_DATA_FRAME_CRC8_POLYNOMIAL		 0x07
+
+typedef enum EN_DEVICE_PAYLOAD_TYPE_t
+{
+	DEVICE_PAYLOAD_TYPE_NONE,		// Unknown device
+	DEVICE_PAYLOAD_TYPE_BYTE,		// 1 byte
+	DEVICE_PAYLOAD_TYPE_FLOAT		// 4 bytes, the float in the AVR (little endian) byte order
+} EN_DEVICE_PAYLOAD_TYPE_t;
+
+/**
+ * Every device connected to the nodes, one line per device:
+ *
+ * DEVICE(name, internal address, payload size, payload type, scale)
+ *
+ * name							Suffix of the generated DEVICE_INTERNAL_ADDRESS_<name> and DEVICE_PAYLOAD_SIZE_<name> constants
+ * internal address				Selects the device on the TWI slave, and is the device address of its device data frames
+ * payload size					Device data size, up to DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE
+ * payload type					EN_DEVICE_PAYLOAD_TYPE_t of the device data
+ * scale						Factor the receiver multiplies DEVICE_PAYLOAD_TYPE_FLOAT device data by before displaying it
+ *
+ * Adding a sensor is adding a line here, the nodes and the Qt application's decoder are all generated from this list
+ */
+#define DEVICE_PROTOCOL_DEVICES(DEVICE) \
+	DEVICE(MOTOR,			0x01,	1,	DEVICE_PAYLOAD_TYPE_BYTE,	1.0f) \
+	DEVICE(ACCELEROMETER,	0x02,	4,	DEVICE_PAYLOAD_TYPE_FLOAT,	1.0f) \
+	DEVICE(LM35,			0x03,	4,	DEVICE_PAYLOAD_TYPE_FLOAT,	1.0f)
+
+#define DEVICE_PROTOCOL_INTERNAL_ADDRESS(name, internalAddress, payloadSize, payloadType, scale)	DEVICE_INTERNAL_ADDRESS_##name = internalAddress,
+#define DEVICE_PROTOCOL_PAYLOAD_SIZE(name, internalAddress, payloadSize, payloadType, scale)		DEVICE_PAYLOAD_SIZE_##name = payloadSize,
+#define DEVICE_PROTOCOL_PAYLOAD_SIZE_CASE(name, internalAddress, payloadSize, payloadType, scale)	case internalAddress: return payloadSize;
+#define DEVICE_PROTOCOL_REGISTER(name, internalAddress, payloadSize, payloadType, scale)			uint8_t name[payloadSize];
+
+typedef enum EN_DEVICE_INTERNAL_ADDRESS_t
+{
+	DEVICE_PROTOCOL_DEVICES(DEVICE_PROTOCOL_INTERNAL_ADDRESS)
+} EN_DEVICE_INTERNAL_ADDRESS_t;
+
+typedef enum EN_DEVICE_PAYLOAD_SIZE_t
+{
+	DEVICE_PROTOCOL_DEVICES(DEVICE_PROTOCOL_PAYLOAD_SIZE)
+} EN_DEVICE_PAYLOAD_SIZE_t;
+
+/**
+ * Register bank of a TWI slave node (see TWI_slave_initRegisterBank()): the device data of every device, back to back in the order of DEVICE_PROTOCOL_DEVICES.
+ * The master reads all of it in one burst:
+ *
+ * START CONDITION -> slave address + Write -> 0x00 (register address) -> REPEATED START CONDITION
+ * -> slave address + Read -> DEVICE_REGISTER_MAP_SIZE bytes, ACK after each byte but the last one -> NACK -> STOP CONDITION
+ *
+ * All registers are read-only. The fields are byte arrays, so the map has no padding
+ */
+typedef struct ST_DEVICE_REGISTER_MAP_t
+{
+	DEVICE_PROTOCOL_DEVICES(DEVICE_PROTOCOL_REGISTER)
+} ST_DEVICE_REGISTER_MAP_t;
+
+// Register address of the device data of a device, e.g. DEVICE_REGISTER_ADDRESS(LM35)
+#define DEVICE_REGISTER_ADDRESS(name)	offsetof(ST_DEVICE_REGISTER_MAP_t, name)
+#define DEVICE_REGISTER_MAP_SIZE		sizeof(ST_DEVICE_REGISTER_MAP_t)
+
+/**
+ * @brief Get the device data size of a device
+ *
+ * @param internalAddress			The internal device address
+ *
+ * @return Device data size in bytes, 0 for an unknown device
+ */
+static inline uint8_t DeviceProtocol_payloadSize(uint8_t internalAddress)
+{
+	switch(internalAddress)
+	{
+		DEVICE_PROTOCOL_DEVICES(DEVICE_PROTOCOL_PAYLOAD_SIZE_CASE)
+
+		default:
+			return 0;
+	}
+}
+
+
+
+#endif /* DEVICEPROTOCOL_H_ */
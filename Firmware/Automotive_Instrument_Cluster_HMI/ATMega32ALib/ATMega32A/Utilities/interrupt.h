@@ -25,6 +25,8 @@
 /* USART Interrupt Vectors */
 // USART reception (RX) complete
 #define USART_RECEPTION_COMPLETE_VECTOR __vector_13
+// USART data register (UDR) empty
+#define USART_DATA_REGISTER_EMPTY_VECTOR __vector_14
 
 
 /* TWI Interrupt Vectors */
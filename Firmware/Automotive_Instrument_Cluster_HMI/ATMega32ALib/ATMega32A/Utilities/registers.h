@@ -125,6 +125,15 @@
 #define FOC2    7
 
 
+/************************************************************************/
+/* Status Register                                                      */
+/************************************************************************/
+
+#define SREG	(*((volatile uint8_t*)0x5F))
+/* SREG Bits */
+#define SREG_I  7
+
+
 /************************************************************************/
 /* External Interrupt Registers                                         */
 /************************************************************************/
@@ -9,145 +9,153 @@
 #include "Application.h"
 #include <ATMega32A/MCAL/TWI/TWI.h>
 #include <ATMega32A/MCAL/UART/UART.h>
+#include <ATMega32A/Protocol/DeviceProtocol.h>
+#include <ATMega32A/Utilities/interrupt.h>
 #include <stdint.h>
 
-#define DEVICE_DATA_FRAME_START_DELIMITER '|'
-#define DEVICE_DATA_FRAME_END_DELIMITER '\r'
-#define DEVICE_INTERNAL_ADDRESS_MOTOR			 0x01
-#define DEVICE_INTERNAL_ADDRESS_ACCELEROMETER	 0x02
-#define DEVICE_INTERNAL_ADDRESS_LM35			 0x03
+// Largest frame on the wire: the frame, one COBS overhead byte and DEVICE_DATA_FRAME_DELIMITER
+#define DEVICE_DATA_FRAME_MAX_ENCODED_SIZE (DEVICE_DATA_FRAME_MAX_SIZE + 2)
 
-typedef union UN_receivedData_t
-{
-	uint8_t byteData;
-	uint8_t byteDataArray[4];
-	float floatData;	// 4 Bytes
-} UN_receivedData_t;
+// TWI slave address of NodeOne
+#define NODE_ONE_SLAVE_ADDRESS 0xA0
 
 /**
- * @brief As a TWI master address the slave and receive the slave's internal device data/status
- *
- * TWI slave after being addressed by master reads device's internal address from master and send the current status of that device to master
+ * NodeOne's register bank (see ST_DEVICE_REGISTER_MAP_t), read in one burst every poll round:
  *
- * TWI master handles the following frames:
+ * START CONDITION -> slave address + Write -> 0x00 (register address) -> ACK -> REPEATED START CONDITION
+ * -> slave address + Read -> ACK -> DEVICE_REGISTER_MAP_SIZE bytes, ACK after each byte but the last one -> NACK -> STOP CONDITION
+ */
+static const uint8_t gs_nodeOneRegisterAddress = 0x00;
+static uint8_t gs_nodeOneRegisters[DEVICE_REGISTER_MAP_SIZE];
+static ST_TWI_transaction_t gs_nodeOnePoll;
+
+// Transmit the device data frame of a device from its registers
+#define DEVICE_TRANSMIT_FRAME(name, internalAddress, payloadSize, payloadType, scale)	UARTTransmitDeviceDataFrame(internalAddress, &gs_nodeOneRegisters[DEVICE_REGISTER_ADDRESS(name)], payloadSize);
+
+static uint8_t gs_deviceDataFrameSequenceNumber = 0;	// Incremented for every transmitted device data frame, wraps around
+static bool gs_pollRoundQueued = false;					// The poll was queued, its frames are not transmitted yet
+
+/**
+ * @brief Calculate the CRC-8 (polynomial 0x07, initial value 0x00) of the given bytes
  *
- * START CONDITION -> slave address + Write -> DEVICE_INTERNAL_ADDRESS_MOTOR -> ACK -> REPEATED START CONDITION
- * -> slave address + Read -> ACK -> Motor PWM duty cycle -> NACK -> STOP CONDITION
+ * @param data							Bytes to calculate the CRC-8 for
+ * @param size							Number of bytes
  *
- * START CONDITION -> slave address + Write -> DEVICE_INTERNAL_ADDRESS_ACCELEROMETER -> ACK -> REPEATED START CONDITION
- * -> slave address + Read -> ACK -> Accelerometer first byte -> ACK -> Accelerometer second byte -> ACK -> Accelerometer third byte -> ACK -> Accelerometer fourth/last byte -> NACK -> STOP CONDITION
+ * @return CRC-8 of the bytes
+ */
+static uint8_t CRC8(const uint8_t* data, uint8_t size)
+{
+	uint8_t crc = 0x00;
+	
+	for(uint8_t i = 0; i < size; i++)
+	{
+		crc ^= data[i];
+		for(uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ DEVICE_DATA_FRAME_CRC8_POLYNOMIAL) : (uint8_t)(crc << 1);
+		}
+	}
+	
+	return crc;
+}
+
+/**
+ * @brief Transmit a device data frame over UART in the protocol v2 format
  *
- * START CONDITION -> slave address + Write -> DEVICE_INTERNAL_ADDRESS_LM35 -> ACK -> REPEATED START CONDITION
- * -> slave address + Read -> ACK -> temperatue first byte -> ACK -> temperatue second byte -> ACK -> temperatue third byte -> ACK -> temperatue fourth/last byte -> NACK -> STOP CONDITION
+ * Builds the frame (device address, sequence number, payload length, payload and CRC-8), COBS encodes it and queues it followed by DEVICE_DATA_FRAME_DELIMITER
+ * in the UART transmit ring buffer. Returns right away, the frame is transmitted from the UART ISR meanwhile.
+ * The caller makes sure DEVICE_DATA_FRAME_MAX_ENCODED_SIZE bytes are free, otherwise the frame is dropped whole
  *
- * @param slaveAddress							Slave's 7-bit address that the master wants to start communication with
- * @param slaveInternalAddress					The internal device address that is connected to the addressed slave
+ * @param deviceAddress					The internal device address the data belongs to
+ * @param payload						Device data
+ * @param payloadSize					Device data size, up to DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE
  *
- * @return Data received from slave. Can be a byte or 4 bytes (of a float type)
+ * @return void
  */
-static UN_receivedData_t TWIGetSlaveInternalDeviceData(uint8_t slaveAddress, uint8_t slaveInternalAddress)
+static void UARTTransmitDeviceDataFrame(uint8_t deviceAddress, const uint8_t* payload, uint8_t payloadSize)
 {
-	UN_receivedData_t receivedData;
+	uint8_t frame[DEVICE_DATA_FRAME_MAX_SIZE];
+	// COBS adds one overhead byte for frames shorter than 254 bytes
+	uint8_t encodedFrame[DEVICE_DATA_FRAME_MAX_ENCODED_SIZE];
+	uint8_t frameSize = 0;
 	
-	// Send START condition. And wait for the operation to complete (status is returned)
-	if(TWI_master_start(false) == TWI_START_SENT)
+	if(payloadSize > DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE)
 	{
-		// Send slave address + write. And wait for the operation to complete (status is returned)
-		if(TWI_master_transmitSlaveAddress(slaveAddress, TWI_WRITE_BIT, false) == TWI_SLAVE_ADDRESS_W_SENT_ACK_RECEIVED)
+		return;
+	}
+	
+	/* Build the frame */
+	frame[frameSize++] = deviceAddress;
+	frame[frameSize++] = gs_deviceDataFrameSequenceNumber++;
+	frame[frameSize++] = payloadSize;
+	for(uint8_t i = 0; i < payloadSize; i++)
+	{
+		frame[frameSize++] = payload[i];
+	}
+	frame[frameSize] = CRC8(frame, frameSize);
+	frameSize++;
+	
+	/* COBS encode the frame. Each code byte holds the distance to the next replaced DEVICE_DATA_FRAME_DELIMITER byte */
+	uint8_t codeIndex = 0;
+	uint8_t code = 1;
+	uint8_t encodedFrameSize = 1;
+	for(uint8_t i = 0; i < frameSize; i++)
+	{
+		if(frame[i] == DEVICE_DATA_FRAME_DELIMITER)
+		{
+			encodedFrame[codeIndex] = code;
+			codeIndex = encodedFrameSize++;
+			code = 1;
+		}
+		else
 		{
-			// Send data (slave internal address). And wait for the operation to complete (status is returned)
-			if(TWI_master_transmit(slaveInternalAddress, false) == TWI_MASTER_DATA_SENT_ACK_RECEIVED)
-			{
-				// Send REPEATED START condition. And wait for the operation to complete (status is returned)
-				if(TWI_master_repeatedStart(false) == TWI_REPEATED_START_SENT)
-				{
-					// Send slave address + read. And wait for the operation to complete (status is returned)
-					if(TWI_master_transmitSlaveAddress(slaveAddress, TWI_READ_BIT, false) == TWI_SLAVE_ADDRESS_R_SENT_ACK_RECEIVED)
-					{
-						/* Handle different received data as they vary in size depending of the address internal device */
-						switch(slaveInternalAddress)
-						{
-							// Receive one byte
-							case DEVICE_INTERNAL_ADDRESS_MOTOR:
-								// Receive a byte of data from slave (internal device data/status), and send ACK/NACK response. And wait for the operation to complete (status is returned)
-								if(TWI_master_receive(&receivedData.byteData, TWI_NACK, false) == TWI_MASTER_DATA_RECEIVED_NACK_SENT)
-								{
-									// Send STOP condition. And wait for the operation to complete (status is returned)
-									TWI_master_stop(false);
-								}
-								
-								break;
-							
-							// Receive 4 bytes (of a float type)
-							case DEVICE_INTERNAL_ADDRESS_ACCELEROMETER:
-							case DEVICE_INTERNAL_ADDRESS_LM35:
-								{
-									// Send ACK for each byte received except the last (fourth) byte send NACK
-									uint8_t dataReceptionResponse = TWI_ACK;
-									for(uint8_t i = 0; i < 4; i++)
-									{
-										// For the last byte (fourth byte) send NACK
-										if(i == 3)
-										{
-											dataReceptionResponse = TWI_NACK;
-										}
-										
-										// Receive a byte of data from slave (internal device data/status), and send ACK/NACK response. And wait for the operation to complete (status is returned)
-										if(TWI_master_receive(&receivedData.byteDataArray[i], dataReceptionResponse, false) != TWI_MASTER_DATA_RECEIVED_ACK_SENT)
-										{
-											break;
-										}
-									}
-									
-									// Send STOP condition. And wait for the operation to complete (status is returned)
-									TWI_master_stop(false);
-								}
-								
-								break;
-								
-							default:
-								// Send STOP condition. And wait for the operation to complete (status is returned)
-								TWI_master_stop(false);
-								
-								break;
-						}
-						
-					}
-				}
-			}
+			encodedFrame[encodedFrameSize++] = frame[i];
+			code++;
 		}
 	}
+	encodedFrame[codeIndex] = code;
 	
-	return receivedData;
+	/* Queue the encoded frame then the end of frame, in one go so the frame is never cut short */
+	encodedFrame[encodedFrameSize++] = DEVICE_DATA_FRAME_DELIMITER;
+	UART_transmitBuffer(encodedFrame, encodedFrameSize);
 }
 
 void application_init()
 {
 	// Initialize TWI in master mode with the SCL frequency
 	TWI_master_init(1000);
+	TWI_master_initTransaction(&gs_nodeOnePoll, NODE_ONE_SLAVE_ADDRESS, &gs_nodeOneRegisterAddress, 1, gs_nodeOneRegisters, DEVICE_REGISTER_MAP_SIZE, 0);
 	// Initialize UART with 4800 baud rate
 	UART_init(4800);
+	// The UART transmit ring buffer is drained from the UART ISR, and the NodeOne poll runs from the TWI ISR
+	sei();
 }
 
 void application_loop()
 {
-	// TWIGetSlaveInternalDeviceData(0xA0, DEVICE_INTERNAL_ADDRESS_MOTOR).byteData;
-	// TWIGetSlaveInternalDeviceData(0xA0, DEVICE_INTERNAL_ADDRESS_ACCELEROMETER).floatData;	
-	// TWIGetSlaveInternalDeviceData(0xA0, DEVICE_INTERNAL_ADDRESS_LM35).floatData;
+	// The TWI ISR is running the poll, meanwhile the loop is free to do other work
+	if(TWI_master_isBusy())
+	{
+		return;
+	}
 	
-	uint8_t* byteDataArray  = 0;
+	/* Transmit a device data frame for every device of the register bank */
+	if(gs_pollRoundQueued)
+	{
+		if(gs_nodeOnePoll.status == TWI_TRANSACTION_COMPLETE)
+		{
+			DEVICE_PROTOCOL_DEVICES(DEVICE_TRANSMIT_FRAME)
+		}
+		gs_pollRoundQueued = false;
+	}
 	
-	/* Transmit accelerometer device frame */
-	// Transmit start of frame
-	UART_transmit(DEVICE_DATA_FRAME_START_DELIMITER);
-	UART_transmit(DEVICE_INTERNAL_ADDRESS_ACCELEROMETER);
-	byteDataArray = TWIGetSlaveInternalDeviceData(0xA0, DEVICE_INTERNAL_ADDRESS_ACCELEROMETER).byteDataArray;
-	/* Transmit the 4 bytes of the float */
-	UART_transmit(byteDataArray[0]);
-	UART_transmit(byteDataArray[1]);
-	UART_transmit(byteDataArray[2]);
-	UART_transmit(byteDataArray[3]);
-	// Transmit end of frame
-	UART_transmit(DEVICE_DATA_FRAME_END_DELIMITER);
+	// The link is slower than the sensor polling. Poll the next round while the previous frames are being transmitted, but no earlier,
+	// so a queued frame is never more than one round old. The UART ISR transmits them meanwhile
+	if(UART_TRANSMIT_BUFFER_SIZE - UART_transmitBufferFreeSpace() > DEVICE_DATA_FRAME_MAX_ENCODED_SIZE)
+	{
+		return;
+	}
 	
-}
\ No newline at end of file
+	// Queue the burst read, the TWI ISR runs it
+	gs_pollRoundQueued = TWI_master_queueTransaction(&gs_nodeOnePoll);
+}
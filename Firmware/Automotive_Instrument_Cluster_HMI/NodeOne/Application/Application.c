@@ -11,112 +11,18 @@
 #include <ATMega32A/ECUAL/Motor/Motor.h>
 #include <ATMega32A/ECUAL/Accelerometer/Accelerometer.h>
 #include <ATMega32A/ECUAL/LM35/LM35.h>
-
-#define DEVICE_INTERNAL_ADDRESS_MOTOR			 0x01
-#define DEVICE_INTERNAL_ADDRESS_ACCELEROMETER	 0x02
-#define DEVICE_INTERNAL_ADDRESS_LM35			 0x03
-
-static float gs_accelerometerValue = 0.0f;
-static float gs_temperatureValue = 0.0f;
-static uint8_t gs_currentlyAddressedDevice = 0x00;
-static uint8_t* bytePtrToFloat = 0x00;	// Points to the current byte to be transmitted of the four bytes of a float type
+#include <ATMega32A/Protocol/DeviceProtocol.h>
+#include <string.h>
 
 /**
- * @brief Handle TWI interrupts. Called inside TWI ISR
- *
- * As a TWI slave after being addressed by master reads device's internal address from master and send the current status of that device to master
- *
- * TWI slave handles the following frames in the TWI ISR:
+ * TWI slave register bank, laid out as ST_DEVICE_REGISTER_MAP_t. Served by the TWI ISR, so the master reads every device data in one burst:
  *
- * START CONDITION -> Own slave address + Write -> DEVICE_INTERNAL_ADDRESS_MOTOR -> ACK -> REPEATED START CONDITION/STOP + START CONDITION
- * -> Own slave address + Read -> ACK -> Motor PWM duty cycle -> NACK -> STOP CONDITION
+ * START CONDITION -> Own slave address + Write -> register address -> ACK -> REPEATED START CONDITION/STOP + START CONDITION
+ * -> Own slave address + Read -> ACK -> Motor PWM duty cycle -> ACK -> Accelerometer 4 bytes -> ACK -> temperature 4 bytes -> NACK -> STOP CONDITION
  *
- * START CONDITION -> Own slave address + Write -> DEVICE_INTERNAL_ADDRESS_ACCELEROMETER -> ACK -> REPEATED START CONDITION/STOP + START CONDITION
- * -> Own slave address + Read -> ACK -> Accelerometer first byte -> ACK -> Accelerometer second byte -> ACK -> Accelerometer third byte -> ACK -> Accelerometer fourth/last byte -> NACK -> STOP CONDITION
- *
- * START CONDITION -> Own slave address + Write -> DEVICE_INTERNAL_ADDRESS_LM35 -> ACK -> REPEATED START CONDITION/STOP + START CONDITION
- * -> Own slave address + Read -> ACK -> temperatue first byte -> ACK -> temperatue second byte -> ACK -> temperatue third byte -> ACK -> temperatue fourth/last byte -> NACK -> STOP CONDITION
- *
- * @return void
+ * Double buffered: the loop publishes whole sample sets, and each read transaction sends the one sample set published when it started
  */
-static void TWIInterruptCallback()
-{
-	// Get the current TWI status
-	EN_TWI_EVENT_STATUS_t TWI_status = TWI_getStatus();
-	
-	/* Handle TWI slave logic based on the current TWI_status */
-	
-	// Slave receiver mode
-	if(TWI_status == TWI_SLAVE_ADDRESS_W_RECEIVED_STATE)
-	{
-		// Receive byte of data from master and send ACK on reception. And handle TWI status in the interrupt callback function
-		TWI_slave_receive(0, TWI_ACK, true);
-	}
-	// Slave transmitter mode
-	else if(TWI_status == TWI_SLAVE_ADDRESS_R_RECEIVED_STATE)
-	{
-		if(gs_currentlyAddressedDevice == DEVICE_INTERNAL_ADDRESS_MOTOR)
-		{
-			// Transmit the current Motor duty cycle. And handle TWI status in the interrupt callback function
-			TWI_slave_transmit(motor_getDutyCycle(), true);
-		}
-		else if(gs_currentlyAddressedDevice == DEVICE_INTERNAL_ADDRESS_ACCELEROMETER)
-		{
-			// Point to the first byte of the float
-			bytePtrToFloat = (uint8_t*)&gs_accelerometerValue;
-			
-			// Transmit the first byte (of the 4 bytes of the float type) of the Accelerometer value. And handle TWI status in the interrupt callback function
-			TWI_slave_transmit(*bytePtrToFloat, true);
-			
-			// Point to the next byte of the float to be transmitted
-			bytePtrToFloat++;
-		}
-		else if(gs_currentlyAddressedDevice == DEVICE_INTERNAL_ADDRESS_LM35)
-		{
-			// Point to the first byte of the float
-			bytePtrToFloat = (uint8_t*)&gs_temperatureValue;
-			
-			// Transmit the first byte (of the 4 bytes of the float type) of the temperature value. And handle TWI status in the interrupt callback function
-			TWI_slave_transmit(*bytePtrToFloat, true);
-			
-			// Point to the next byte of the float to be transmitted
-			bytePtrToFloat++;
-		}
-	}
-	// For sending multiple bytes of data, we can handle in here any byte to be sent after the first byte
-	else if(TWI_status == TWI_SLAVE_DATA_SENT_ACK_RECEIVED_STATE)
-	{
-		if(gs_currentlyAddressedDevice == DEVICE_INTERNAL_ADDRESS_ACCELEROMETER)
-		{
-			// Transmit the next byte (of the 4 bytes of the float type) of the Accelerometer value. And handle TWI status in the interrupt callback function
-			TWI_slave_transmit(*bytePtrToFloat, true);
-			
-			// Point to the next byte of the float to be transmitted
-			bytePtrToFloat++;
-		}
-		else if(gs_currentlyAddressedDevice == DEVICE_INTERNAL_ADDRESS_LM35)
-		{
-			// Transmit the next byte (of the 4 bytes of the float type) of the temperature value. And handle TWI status in the interrupt callback function
-			TWI_slave_transmit(*bytePtrToFloat, true);
-			
-			// Point to the next byte of the float to be transmitted
-			bytePtrToFloat++;
-		}
-	}
-	// Received data from master
-	else if(TWI_status == TWI_SLAVE_DATA_RECEIVED_ACK_SENT_STATE)
-	{
-		// Get the received internal device address from master
-		gs_currentlyAddressedDevice = TWI_getDataRegister();
-	}
-	// Received STOP or REPEATED START condition
-	else if(TWI_status == TWI_SLAVE_STO_RSTA_RECEIVED)
-	{
-		// Listen for own slave address on the TWI bus. And handle TWI status in the interrupt callback function
-		TWI_slave_listen(true);
-	}
-	
-}
+static uint8_t gs_registerSnapshots[2][DEVICE_REGISTER_MAP_SIZE];
 
 void application_init()
 {
@@ -124,17 +30,26 @@ void application_init()
 	accelerometer_init(ADC_CHANNEL_1);
 	LM35_init(ADC_CHANNEL_2);
 	
-	// Initialize TWI in slave mode with own slave address 0xA0
-	TWI_slave_init(0xA0);
-	// Set TWI interrupt callback function
-	TWI_setInterruptCallback(TWIInterruptCallback);
-	// Start listening for own slave address on the TWI bus. And handle TWI status in the interrupt callback function
-	TWI_slave_listen(true);
+	// Serve the register bank as TWI slave with own slave address 0xA0, the TWI ISR handles the whole transactions
+	TWI_slave_initSnapshotRegisterBank(0xA0, &gs_registerSnapshots[0][0], DEVICE_REGISTER_MAP_SIZE);
 }
 
 void application_loop()
 {
 	motor_start(ADC_CHANNEL_0, PWM_TIMER2);
-	gs_accelerometerValue = accelerometer_read(ADC_CHANNEL_1);
-	gs_temperatureValue = LM35_read(ADC_CHANNEL_2);
+	uint8_t dutyCycle = motor_getDutyCycle();
+	float accelerometerValue = accelerometer_read(ADC_CHANNEL_1);
+	float temperatureValue = LM35_read(ADC_CHANNEL_2);
+	
+	// The master is still reading the sample set before the published one, skip this one rather than waiting for the bus
+	uint8_t* registers = TWI_slave_beginSnapshot();
+	if(registers == 0)
+	{
+		return;
+	}
+	
+	memcpy(registers + DEVICE_REGISTER_ADDRESS(MOTOR), &dutyCycle, DEVICE_PAYLOAD_SIZE_MOTOR);
+	memcpy(registers + DEVICE_REGISTER_ADDRESS(ACCELEROMETER), &accelerometerValue, DEVICE_PAYLOAD_SIZE_ACCELEROMETER);
+	memcpy(registers + DEVICE_REGISTER_ADDRESS(LM35), &temperatureValue, DEVICE_PAYLOAD_SIZE_LM35);
+	TWI_slave_publishSnapshot();
 }
@@ -5,11 +5,44 @@ QT += quick serialport
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+        capturefile.cpp \
+        capturereplay.cpp \
+        clusterstate.cpp \
+        devicedataparser.cpp \
+        drivelogencoder.cpp \
+        drivelogfile.cpp \
+        drivelogger.cpp \
+        filterstage.cpp \
+        headlessingestion.cpp \
+        historymodel.cpp \
+        ingestionmetrics.cpp \
+        latencyhistogram.cpp \
+        latencyprobe.cpp \
         main.cpp \
-        serial.cpp
+        portmanager.cpp \
+        portprober.cpp \
+        samplefilter.cpp \
+        samplehistory.cpp \
+        samplewriter.cpp \
+        sharedstatepublisher.cpp \
+        sharedstatewriter.cpp \
+        serial.cpp \
+        serialworker.cpp \
+        sourcemanager.cpp \
+        speedintegrator.cpp \
+        speedometergauge.cpp \
+        threadedserial.cpp
 
 RESOURCES += qml.qrc
 
+# shm_open() lives in librt before glibc 2.34, see SharedStateWriter
+linux: LIBS += -lrt
+
+# Device table and frame constants shared with the firmware, see ATMega32A/Protocol/DeviceProtocol.h
+FIRMWARE_LIB_DIR = $$PWD/../../Firmware/Automotive_Instrument_Cluster_HMI/ATMega32ALib
+INCLUDEPATH += $$FIRMWARE_LIB_DIR
+DEPENDPATH += $$FIRMWARE_LIB_DIR
+
 # Additional import path used to resolve QML modules in Qt Creator's code model
 QML_IMPORT_PATH =
 
@@ -22,4 +55,39 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 HEADERS += \
-    serial.h
+    capturefile.h \
+    capturereplay.h \
+    clusterstate.h \
+    devicedataframedecoder.h \
+    devicedataframedecoderv2.h \
+    devicedataparser.h \
+    deviceprotocol.h \
+    devicesample.h \
+    drivelogencoder.h \
+    drivelogfile.h \
+    drivelogformat.h \
+    drivelogger.h \
+    filterstage.h \
+    $$FIRMWARE_LIB_DIR/ATMega32A/Protocol/DeviceProtocol.h \
+    headlessingestion.h \
+    historymodel.h \
+    ingestioncounters.h \
+    ingestionmetrics.h \
+    latencyhistogram.h \
+    latencyprobe.h \
+    portmanager.h \
+    portprober.h \
+    samplefilter.h \
+    samplehistory.h \
+    samplemerger.h \
+    samplewriter.h \
+    sharedstatelayout.h \
+    sharedstatepublisher.h \
+    sharedstatewriter.h \
+    serial.h \
+    serialworker.h \
+    sourcemanager.h \
+    speedintegrator.h \
+    speedometergauge.h \
+    spscringbuffer.h \
+    threadedserial.h
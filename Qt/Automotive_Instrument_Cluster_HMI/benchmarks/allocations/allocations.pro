@@ -0,0 +1,6 @@
+include(../benchmarks.pri)
+
+TARGET = bench_allocations
+
+SOURCES += \
+        bench_allocations.cpp
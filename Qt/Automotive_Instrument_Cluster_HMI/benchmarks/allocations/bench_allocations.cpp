@@ -0,0 +1,133 @@
+#include <QtTest>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "serial.h"
+#include "common/syntheticstream.h"
+
+/*
+ * Counts heap allocations per parsed device data frame, for the typed deviceSampleAvailable() signal and for the
+ * legacy QList<QVariant> deviceDataAvailable() signal.
+ *
+ * Qt containers allocate through malloc() directly, so on glibc malloc() itself is interposed.
+ * Elsewhere only operator new is counted, which misses the container allocations.
+*/
+static std::atomic<bool> gs_countAllocations { false };
+static std::atomic<qint64> gs_allocationCount { 0 };
+
+static inline void countAllocation()
+{
+    if(gs_countAllocations.load(std::memory_order_relaxed))
+    {
+        gs_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#if defined(__GLIBC__)
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+
+    void* malloc(size_t size)
+    {
+        countAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        countAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size)
+    {
+        countAllocation();
+        return __libc_realloc(pointer, size);
+    }
+}
+#else
+void* operator new(size_t size)
+{
+    countAllocation();
+    if(void* pointer = std::malloc(size ? size : 1))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
+
+class AllocationsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void allocationsPerFrame_data();
+    void allocationsPerFrame();
+
+private:
+    static constexpr int FRAME_COUNT = 30000;
+
+    QByteArray stream;
+};
+
+void AllocationsBenchmark::initTestCase()
+{
+    stream = makeDeviceDataStream(FRAME_COUNT);
+}
+
+void AllocationsBenchmark::allocationsPerFrame_data()
+{
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("deviceSampleAvailable") << false;
+    QTest::newRow("deviceDataAvailable (legacy)") << true;
+}
+
+void AllocationsBenchmark::allocationsPerFrame()
+{
+    QFETCH(bool, legacy);
+
+    Serial serial;
+    // Consume the data the same way the QML handler does, so unboxing costs are included
+    double consumedValue = 0.0;
+    if(legacy)
+    {
+        serial.setLegacyDeviceDataEnabled(true);
+        QObject::connect(&serial, &Serial::deviceDataAvailable, &serial, [&consumedValue](const QList<QVariant>& deviceData) { consumedValue += deviceData[1].toDouble(); });
+    }
+    else
+    {
+        QObject::connect(&serial, &Serial::deviceSampleAvailable, &serial, [&consumedValue](const DeviceSample& sample) { consumedValue += sample.value(); });
+    }
+
+    // Warm up, so one-time allocations don't show up in the per frame count
+    serial.parseDeviceData(stream.constData(), stream.size(), 0);
+
+    gs_allocationCount.store(0);
+    gs_countAllocations.store(true);
+    const size_t frames = serial.parseDeviceData(stream.constData(), stream.size(), 0);
+    gs_countAllocations.store(false);
+
+    QCOMPARE(frames, size_t(FRAME_COUNT));
+    QVERIFY(consumedValue != 0.0);
+    QTest::setBenchmarkResult(double(gs_allocationCount.load()) / frames, QTest::Events);
+}
+
+QTEST_GUILESS_MAIN(AllocationsBenchmark)
+
+#include "bench_allocations.moc"
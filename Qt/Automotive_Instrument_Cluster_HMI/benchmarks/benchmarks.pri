@@ -0,0 +1,41 @@
+# Settings shared by all the benchmark projects
+
+QT += testlib serialport
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+# The application sources live one directory above the benchmarks directory
+APP_SOURCE_DIR = $$PWD/..
+INCLUDEPATH += $$APP_SOURCE_DIR
+DEPENDPATH += $$APP_SOURCE_DIR
+# Device table and frame constants shared with the firmware
+INCLUDEPATH += $$APP_SOURCE_DIR/../../Firmware/Automotive_Instrument_Cluster_HMI/ATMega32ALib
+
+# The ingestion path under benchmark
+SOURCES += \
+        $$APP_SOURCE_DIR/capturefile.cpp \
+        $$APP_SOURCE_DIR/capturereplay.cpp \
+        $$APP_SOURCE_DIR/devicedataparser.cpp \
+        $$APP_SOURCE_DIR/ingestionmetrics.cpp \
+        $$APP_SOURCE_DIR/serial.cpp \
+        $$APP_SOURCE_DIR/serialworker.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/capturefile.h \
+        $$APP_SOURCE_DIR/capturereplay.h \
+        $$APP_SOURCE_DIR/devicedataframedecoder.h \
+        $$APP_SOURCE_DIR/devicedataframedecoderv2.h \
+        $$APP_SOURCE_DIR/devicedataparser.h \
+        $$APP_SOURCE_DIR/deviceprotocol.h \
+        $$APP_SOURCE_DIR/devicesample.h \
+        $$APP_SOURCE_DIR/ingestioncounters.h \
+        $$APP_SOURCE_DIR/ingestionmetrics.h \
+        $$APP_SOURCE_DIR/serial.h \
+        $$APP_SOURCE_DIR/serialworker.h \
+        $$APP_SOURCE_DIR/spscringbuffer.h
+
+# Helpers shared between the benchmarks
+INCLUDEPATH += $$PWD
+HEADERS += $$PWD/common/syntheticstream.h
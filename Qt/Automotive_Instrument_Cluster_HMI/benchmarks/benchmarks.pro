@@ -0,0 +1,12 @@
+TEMPLATE = subdirs
+
+# Each benchmark is a standalone QTest executable. Run with -csv, -xml or -o <file>,<format> to get machine-readable results
+SUBDIRS += \
+        decoder \
+        allocations \
+        gauge \
+        history \
+        ingestion_stress \
+        pipeline \
+        replay \
+        sharedstate
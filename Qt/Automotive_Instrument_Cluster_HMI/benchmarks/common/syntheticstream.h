@@ -0,0 +1,96 @@
+#ifndef SYNTHETICSTREAM_H
+#define SYNTHETICSTREAM_H
+
+#include <QByteArray>
+#include <cstring>
+#include <random>
+#include "serial.h"
+
+/*
+ * @brief Build a byte stream of device data frames, interleaving the three devices the same way the HMI node does
+ *
+ * The float values are chosen so that none of their bytes collide with the FRAME_PROTOCOL_V1 delimiters
+ *
+ * @param frameCount    Number of device data frames in the stream
+ * @param protocol      Wire format of the frames
+ *
+ * @return The encoded byte stream
+*/
+inline QByteArray makeDeviceDataStream(int frameCount, Serial::FrameProtocol protocol = Serial::FRAME_PROTOCOL_V2)
+{
+    const float accelerometerValue = 0.25f;
+    const float temperatureValue = 36.5f;
+
+    QByteArray stream;
+    stream.reserve(frameCount * (DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE + 1));
+    for(int i = 0; i < frameCount; i++)
+    {
+        uint8_t deviceAddress;
+        uint8_t payload[4];
+        size_t payloadSize;
+        switch(i % 3)
+        {
+            case 0:
+                deviceAddress = Serial::DEVICE_INTERNAL_ADDRESS_MOTOR;
+                payload[0] = uint8_t(i % 10);
+                payloadSize = 1;
+                break;
+            case 1:
+                deviceAddress = Serial::DEVICE_INTERNAL_ADDRESS_ACCELEROMETER;
+                memcpy(payload, &accelerometerValue, 4);
+                payloadSize = 4;
+                break;
+            default:
+                deviceAddress = Serial::DEVICE_INTERNAL_ADDRESS_LM35;
+                memcpy(payload, &temperatureValue, 4);
+                payloadSize = 4;
+                break;
+        }
+
+        if(protocol == Serial::FRAME_PROTOCOL_V2)
+        {
+            uint8_t encodedFrame[DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE + 1];
+            const size_t encodedSize = DeviceDataFrameDecoderV2::encode(deviceAddress, uint8_t(i), payload, payloadSize, encodedFrame);
+            stream.append(reinterpret_cast<const char*>(encodedFrame), encodedSize);
+        }
+        else
+        {
+            stream.append(DEVICE_DATA_FRAME_START_DELIMITER);
+            stream.append(char(deviceAddress));
+            stream.append(reinterpret_cast<const char*>(payload), payloadSize);
+            stream.append(DEVICE_DATA_FRAME_END_DELIMITER);
+        }
+    }
+
+    return stream;
+}
+
+/*
+ * @brief Flip random bytes of a device data frame stream, as line noise would
+ *
+ * @param stream        Stream to corrupt in place
+ * @param probability   Probability for each byte to be flipped
+ * @param seed          Seed of the random generator, so runs are comparable
+ *
+ * @return Number of flipped bytes
+*/
+inline int corruptDeviceDataStream(QByteArray& stream, double probability, unsigned seed = 1)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> draw(0.0, 1.0);
+    std::uniform_int_distribution<int> flip(1, 255);
+
+    int flippedBytes = 0;
+    for(qsizetype i = 0; i < stream.size(); i++)
+    {
+        if(draw(random) < probability)
+        {
+            stream[i] = char(stream[i] ^ flip(random));
+            flippedBytes++;
+        }
+    }
+
+    return flippedBytes;
+}
+
+#endif // SYNTHETICSTREAM_H
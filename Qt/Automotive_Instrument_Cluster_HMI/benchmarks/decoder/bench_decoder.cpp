@@ -0,0 +1,75 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include "serial.h"
+#include "common/syntheticstream.h"
+
+/*
+ * Measures how many device data frames per second Serial parses when the received bytes are handed over in chunks of different sizes.
+ * A chunk models the bytes available on a single readyRead() signal
+*/
+class DecoderBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void throughput_data();
+    void throughput();
+
+private:
+    static constexpr int FRAME_COUNT = 200000;
+
+    QByteArray streamV1;
+    QByteArray streamV2;
+};
+
+void DecoderBenchmark::initTestCase()
+{
+    streamV1 = makeDeviceDataStream(FRAME_COUNT, Serial::FRAME_PROTOCOL_V1);
+    streamV2 = makeDeviceDataStream(FRAME_COUNT, Serial::FRAME_PROTOCOL_V2);
+}
+
+void DecoderBenchmark::throughput_data()
+{
+    QTest::addColumn<Serial::FrameProtocol>("protocol");
+    QTest::addColumn<int>("chunkSize");
+
+    for(const Serial::FrameProtocol protocol : { Serial::FRAME_PROTOCOL_V1, Serial::FRAME_PROTOCOL_V2 })
+    {
+        for(const int chunkSize : { 1, 7, 64, 512, 4096 })
+        {
+            QTest::addRow("v%d chunk %d", int(protocol), chunkSize) << protocol << chunkSize;
+        }
+    }
+}
+
+void DecoderBenchmark::throughput()
+{
+    QFETCH(Serial::FrameProtocol, protocol);
+    QFETCH(int, chunkSize);
+
+    Serial serial;
+    serial.setFrameProtocol(protocol);
+    qint64 emittedFrames = 0;
+    QObject::connect(&serial, &Serial::deviceSampleAvailable, &serial, [&emittedFrames](const DeviceSample&) { emittedFrames++; });
+
+    const QByteArray& stream = protocol == Serial::FRAME_PROTOCOL_V2 ? streamV2 : streamV1;
+    const char* data = stream.constData();
+    const qsizetype size = stream.size();
+    const qint64 timestamp = DeviceSample::currentTimestamp();
+
+    QElapsedTimer timer;
+    timer.start();
+    for(qsizetype offset = 0; offset < size; offset += chunkSize)
+    {
+        serial.parseDeviceData(data + offset, static_cast<size_t>(qMin<qsizetype>(chunkSize, size - offset)), timestamp);
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    QCOMPARE(emittedFrames, qint64(FRAME_COUNT));
+    QTest::setBenchmarkResult(emittedFrames * 1e9 / elapsedNs, QTest::FramesPerSecond);
+}
+
+QTEST_GUILESS_MAIN(DecoderBenchmark)
+
+#include "bench_decoder.moc"
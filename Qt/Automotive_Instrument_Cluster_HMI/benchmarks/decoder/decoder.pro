@@ -0,0 +1,6 @@
+include(../benchmarks.pri)
+
+TARGET = bench_decoder
+
+SOURCES += \
+        bench_decoder.cpp
@@ -0,0 +1,125 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "speedometergauge.h"
+
+/*
+ * Frame time of the speedometer while its value changes every frame: the former Rectangle with four bound GradientStops
+ * against SpeedometerGauge. Every frame is rendered synchronously with QQuickWindow::grabWindow(), so vsync doesn't pace it.
+ *
+ * Uses the software backend (QT_QUICK_BACKEND=software) unless QT_QUICK_BACKEND is set, e.g. to rhi for the default backend.
+ * Run with -platform offscreen when there is no display.
+*/
+class GaugeBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void frameTime_data();
+    void frameTime();
+
+private:
+    static constexpr int WARM_UP_FRAME_COUNT = 20;
+    static constexpr int FRAME_COUNT = 500;
+};
+
+void GaugeBenchmark::initTestCase()
+{
+    if(qEnvironmentVariableIsEmpty("QT_QUICK_BACKEND"))
+    {
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    }
+    qmlRegisterType<SpeedometerGauge>("Cluster", 1, 0, "SpeedometerGauge");
+}
+
+void GaugeBenchmark::frameTime_data()
+{
+    QTest::addColumn<QByteArray>("qml");
+
+    QTest::newRow("rectangle gradient") << QByteArray(
+        "import QtQuick\n"
+        "Rectangle {\n"
+        "    property real speedValue: 0\n"
+        "    readonly property double fillPosition: 0.3\n"
+        "    readonly property int maxSpeed: 180\n"
+        "    id: speedometer\n"
+        "    width: 300; height: 300\n"
+        "    radius: width * 0.5\n"
+        "    antialiasing: true\n"
+        "    color: \"transparent\"\n"
+        "    border.color: \"lightgreen\"\n"
+        "    border.width: 5\n"
+        "    gradient: Gradient {\n"
+        "        GradientStop { position: 0.0; color: speedometer.border.color }\n"
+        "        GradientStop { position: ((speedometer.speedValue * speedometer.fillPosition) / speedometer.maxSpeed) + 0.0001; color: \"black\" }\n"
+        "        GradientStop { position: (1.0 - ((speedometer.speedValue * speedometer.fillPosition) / speedometer.maxSpeed)) - 0.0001; color: \"black\" }\n"
+        "        GradientStop { position: 1.0; color: speedometer.border.color }\n"
+        "    }\n"
+        "}\n");
+
+    QTest::newRow("scene graph gauge") << QByteArray(
+        "import QtQuick\n"
+        "import Cluster\n"
+        "SpeedometerGauge {\n"
+        "    property real speedValue: 0\n"
+        "    width: 300; height: 300\n"
+        "    value: speedValue\n"
+        "    maxValue: 180\n"
+        "    fillPosition: 0.3\n"
+        "    color: \"lightgreen\"\n"
+        "    borderWidth: 5\n"
+        "}\n");
+}
+
+void GaugeBenchmark::frameTime()
+{
+    QFETCH(QByteArray, qml);
+
+    QQuickWindow window;
+    window.resize(300, 300);
+    window.setColor(Qt::black);
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData(qml, QUrl());
+    std::unique_ptr<QQuickItem> gauge(qobject_cast<QQuickItem*>(component.create()));
+    QVERIFY2(gauge, qPrintable(component.errorString()));
+    gauge->setParentItem(window.contentItem());
+
+    std::vector<qint64> frameTimesNs;
+    frameTimesNs.reserve(FRAME_COUNT);
+    QElapsedTimer timer;
+
+    for(int frame = 0; frame < WARM_UP_FRAME_COUNT + FRAME_COUNT; frame++)
+    {
+        // Sweep the whole speed range back and forth
+        gauge->setProperty("speedValue", 180.0 * (frame % 100 < 50 ? frame % 50 : 50 - frame % 50) / 50);
+
+        timer.start();
+        const QImage image = window.grabWindow();
+        const qint64 elapsedNs = timer.nsecsElapsed();
+
+        QVERIFY(!image.isNull());
+        if(frame >= WARM_UP_FRAME_COUNT)
+        {
+            frameTimesNs.push_back(elapsedNs);
+        }
+    }
+
+    std::sort(frameTimesNs.begin(), frameTimesNs.end());
+    const qint64 medianNs = frameTimesNs[frameTimesNs.size() / 2];
+    qInfo("%s backend, median %.3f ms, p99 %.3f ms, max %.3f ms", qPrintable(window.rendererInterface()->graphicsApi() == QSGRendererInterface::Software ? QStringLiteral("software") : QStringLiteral("hardware")),
+          medianNs / 1e6, frameTimesNs[frameTimesNs.size() * 99 / 100] / 1e6, frameTimesNs.back() / 1e6);
+    QTest::setBenchmarkResult(double(medianNs), QTest::WalltimeNanoseconds);
+}
+
+QTEST_MAIN(GaugeBenchmark)
+
+#include "bench_gauge.moc"
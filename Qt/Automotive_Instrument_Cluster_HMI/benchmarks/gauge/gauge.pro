@@ -0,0 +1,13 @@
+include(../benchmarks.pri)
+
+# Renders the gauges in a window
+QT += gui qml quick
+
+TARGET = bench_gauge
+
+SOURCES += \
+        $$APP_SOURCE_DIR/speedometergauge.cpp \
+        bench_gauge.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/speedometergauge.h
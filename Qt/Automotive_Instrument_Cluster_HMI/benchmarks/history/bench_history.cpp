@@ -0,0 +1,108 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "samplehistory.h"
+
+/*
+ * SampleHistory holding 24 hours of a 1 kHz device, within a 64 MiB memory budget:
+ *  - append: nanoseconds per sample appended to the full history
+ *  - query: nanoseconds to resample a window of the history to the width of a graph, for windows from 1 second to 24 hours
+*/
+class HistoryBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void append();
+    void query_data();
+    void query();
+
+private:
+    static constexpr size_t MEMORY_BUDGET = 64 * 1024 * 1024;
+    static constexpr qint64 SAMPLE_PERIOD_NS = 1000000;
+    static constexpr quint64 SAMPLE_COUNT = 24ULL * 3600 * 1000;
+    static constexpr int APPEND_COUNT = 1000000;
+    static constexpr int QUERY_COUNT = 1000;
+
+    static float sampleValue(quint64 index) { return static_cast<float>(std::sin(index * 1e-4) + 0.1 * std::sin(index * 0.37)); }
+
+    std::unique_ptr<SampleHistory> history;
+    quint64 appendedSamples = 0;
+};
+
+void HistoryBenchmark::initTestCase()
+{
+    history = std::make_unique<SampleHistory>(MEMORY_BUDGET);
+
+    QElapsedTimer timer;
+    timer.start();
+    for(; appendedSamples < SAMPLE_COUNT; appendedSamples++)
+    {
+        history->append(static_cast<qint64>(appendedSamples) * SAMPLE_PERIOD_NS, sampleValue(appendedSamples));
+    }
+
+    qInfo("24 h at 1 kHz appended in %.1f s, %zu entries per level, %.1f h of history kept in %zu MiB",
+          timer.nsecsElapsed() / 1e9, history->levelCapacity(),
+          (history->newestTimestamp() - history->oldestTimestamp()) / 3.6e12, history->memoryBudget() / (1024 * 1024));
+}
+
+void HistoryBenchmark::append()
+{
+    QElapsedTimer timer;
+    timer.start();
+    for(int i = 0; i < APPEND_COUNT; i++, appendedSamples++)
+    {
+        history->append(static_cast<qint64>(appendedSamples) * SAMPLE_PERIOD_NS, sampleValue(appendedSamples));
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    QTest::setBenchmarkResult(double(elapsedNs) / APPEND_COUNT, QTest::WalltimeNanoseconds);
+}
+
+void HistoryBenchmark::query_data()
+{
+    QTest::addColumn<double>("timeSpan");
+    QTest::addColumn<int>("columns");
+
+    for(const double timeSpan : { 1.0, 60.0, 3600.0, 86400.0 })
+    {
+        for(const int columns : { 480, 1920 })
+        {
+            QTest::addRow("%gs %d columns", timeSpan, columns) << timeSpan << columns;
+        }
+    }
+}
+
+void HistoryBenchmark::query()
+{
+    QFETCH(double, timeSpan);
+    QFETCH(int, columns);
+
+    const qint64 to = history->newestTimestamp();
+    const qint64 from = to - static_cast<qint64>(timeSpan * 1e9);
+    std::vector<SampleHistory::Column> series;
+    int level = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for(int i = 0; i < QUERY_COUNT; i++)
+    {
+        level = history->query(from, to, static_cast<size_t>(columns), series);
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    // Every column of a window within the history has samples
+    const int validColumns = static_cast<int>(std::count_if(series.begin(), series.end(), [](const SampleHistory::Column& column) { return column.valid; }));
+    qInfo("level %d, %d of %d columns with samples", level, validColumns, columns);
+    QVERIFY(validColumns > 0);
+
+    QTest::setBenchmarkResult(double(elapsedNs) / QUERY_COUNT, QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(HistoryBenchmark)
+
+#include "bench_history.moc"
@@ -0,0 +1,10 @@
+include(../benchmarks.pri)
+
+TARGET = bench_history
+
+SOURCES += \
+        $$APP_SOURCE_DIR/samplehistory.cpp \
+        bench_history.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/samplehistory.h
@@ -0,0 +1,131 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "serialworker.h"
+#include "common/syntheticstream.h"
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+/*
+ * Pushes 1M frames/s through a pipe into a SerialWorker running on its own thread, while the "GUI" thread drains the
+ * sample ring once per simulated frame of increasing duration.
+ *
+ * Ingestion only depends on the reader thread: the ingestion rate must stay the same whatever the GUI frame time is,
+ * a slow GUI only shows up as dropped samples once the ring is full.
+*/
+class IngestionStressBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void guiFrameTime_data();
+    void guiFrameTime();
+
+private:
+    static constexpr int FRAMES_PER_SECOND = 1000000;
+    // The producer writes one batch per millisecond
+    static constexpr int FRAMES_PER_BATCH = FRAMES_PER_SECOND / 1000;
+    static constexpr int DURATION_MS = 2000;
+    static constexpr size_t RING_CAPACITY = 1 << 18;
+};
+
+void IngestionStressBenchmark::guiFrameTime_data()
+{
+    QTest::addColumn<int>("frameTimeMs");
+
+    QTest::newRow("gui frame 1 ms") << 1;
+    QTest::newRow("gui frame 16 ms") << 16;
+    QTest::newRow("gui frame 50 ms") << 50;
+    QTest::newRow("gui frame 200 ms") << 200;
+}
+
+void IngestionStressBenchmark::guiFrameTime()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Needs POSIX pipes");
+#else
+    QFETCH(int, frameTimeMs);
+
+    int pipeFds[2];
+    QVERIFY(pipe(pipeFds) == 0);
+
+    const QByteArray batch = makeDeviceDataStream(FRAMES_PER_BATCH);
+    SpscRingBuffer<DeviceSample> ring(RING_CAPACITY);
+    SerialWorker worker(&ring);
+
+    /* Producer: paced writes of FRAMES_PER_BATCH frames every millisecond */
+    std::atomic<qint64> producedFrames { 0 };
+    std::thread producer([&]()
+    {
+        auto nextBatch = std::chrono::steady_clock::now();
+        for(int i = 0; i < DURATION_MS; i++)
+        {
+            std::this_thread::sleep_until(nextBatch);
+            nextBatch += std::chrono::milliseconds(1);
+
+            for(qsizetype written = 0; written < batch.size(); )
+            {
+                const ssize_t result = write(pipeFds[1], batch.constData() + written, batch.size() - written);
+                if(result <= 0)
+                {
+                    break;
+                }
+                written += result;
+            }
+            producedFrames += FRAMES_PER_BATCH;
+        }
+        close(pipeFds[1]);
+    });
+
+    /* Reader: the serial I/O thread, same ingestion path as SerialWorker::readAndParseDeviceData() */
+    std::atomic<bool> readerDone { false };
+    qint64 readerElapsedNs = 0;
+    std::thread reader([&]()
+    {
+        char buffer[1 << 16];
+        QElapsedTimer timer;
+        timer.start();
+        ssize_t readBytes;
+        while((readBytes = read(pipeFds[0], buffer, sizeof(buffer))) > 0)
+        {
+            worker.ingest(buffer, static_cast<size_t>(readBytes), DeviceSample::currentTimestamp());
+        }
+        readerElapsedNs = timer.nsecsElapsed();
+        close(pipeFds[0]);
+        readerDone = true;
+    });
+
+    /* GUI: drain the ring once per (slow) frame */
+    qint64 drainedSamples = 0;
+    size_t maxRingOccupancy = 0;
+    while(!readerDone)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(frameTimeMs));
+        maxRingOccupancy = qMax(maxRingOccupancy, ring.size());
+        worker.acknowledgeSamples();
+        drainedSamples += ring.drain([](const DeviceSample&) {});
+    }
+
+    producer.join();
+    reader.join();
+    drainedSamples += ring.drain([](const DeviceSample&) {});
+
+    const qint64 ingested = static_cast<qint64>(worker.ingestedSamples());
+    const qint64 dropped = static_cast<qint64>(worker.droppedSamples());
+    qInfo("produced %lld, ingested %lld, dropped on full ring %lld, max ring occupancy %zu/%zu",
+          producedFrames.load(), ingested, dropped, maxRingOccupancy, ring.capacity());
+
+    // Every produced frame was decoded, whether or not the GUI kept up with it
+    QCOMPARE(ingested + dropped, producedFrames.load());
+    QCOMPARE(drainedSamples, ingested);
+    QTest::setBenchmarkResult((ingested + dropped) * 1e9 / qMax<qint64>(1, readerElapsedNs), QTest::FramesPerSecond);
+#endif
+}
+
+QTEST_GUILESS_MAIN(IngestionStressBenchmark)
+
+#include "bench_ingestion_stress.moc"
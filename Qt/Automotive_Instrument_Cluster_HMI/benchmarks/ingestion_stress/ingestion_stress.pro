@@ -0,0 +1,6 @@
+include(../benchmarks.pri)
+
+TARGET = bench_ingestion_stress
+
+SOURCES += \
+        bench_ingestion_stress.cpp
@@ -0,0 +1,256 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "clusterstate.h"
+#include "serial.h"
+#include "common/syntheticstream.h"
+
+/*
+ * Ingestion path benchmarks, on clean and corrupted synthetic streams:
+ *  - bytesPerSecond / framesPerSecond: Serial parsing chunks of received bytes, with one receiver on the typed signal
+ *  - signalCost: nanoseconds per emitted deviceSampleAvailable(), by number and type of connected receivers
+ *  - endToEnd: nanoseconds from a frame's bytes handed to Serial to the QML property bound to ClusterState being updated
+ *
+ * Run with -csv, -xml or -o <file>,<format> to track the results across releases.
+*/
+class PipelineBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void bytesPerSecond_data();
+    void bytesPerSecond();
+    void framesPerSecond_data();
+    void framesPerSecond();
+    void signalCost_data();
+    void signalCost();
+    void endToEnd_data();
+    void endToEnd();
+
+private:
+    static constexpr int FRAME_COUNT = 300000;
+    static constexpr int CHUNK_SIZE = 64;
+    // Probability for each byte of the corrupted streams to be flipped
+    static constexpr double CORRUPTION_PROBABILITY = 0.001;
+    static constexpr int SIGNAL_COUNT = 1000000;
+
+    struct ParseResult
+    {
+        qint64 elapsedNs;
+        qint64 emittedFrames;
+    };
+
+    void addStreamRows();
+    const QByteArray& stream(Serial::FrameProtocol protocol, bool corrupted) const;
+    ParseResult parseStream(Serial::FrameProtocol protocol, bool corrupted) const;
+
+    QByteArray streams[2][2];
+};
+
+void PipelineBenchmark::initTestCase()
+{
+    for(const Serial::FrameProtocol protocol : { Serial::FRAME_PROTOCOL_V1, Serial::FRAME_PROTOCOL_V2 })
+    {
+        QByteArray clean = makeDeviceDataStream(FRAME_COUNT, protocol);
+        QByteArray corrupted = clean;
+        corruptDeviceDataStream(corrupted, CORRUPTION_PROBABILITY);
+
+        streams[protocol - 1][0] = clean;
+        streams[protocol - 1][1] = corrupted;
+    }
+}
+
+void PipelineBenchmark::addStreamRows()
+{
+    QTest::addColumn<Serial::FrameProtocol>("protocol");
+    QTest::addColumn<bool>("corrupted");
+
+    for(const Serial::FrameProtocol protocol : { Serial::FRAME_PROTOCOL_V1, Serial::FRAME_PROTOCOL_V2 })
+    {
+        QTest::addRow("v%d clean", int(protocol)) << protocol << false;
+        QTest::addRow("v%d corrupted", int(protocol)) << protocol << true;
+    }
+}
+
+const QByteArray& PipelineBenchmark::stream(Serial::FrameProtocol protocol, bool corrupted) const
+{
+    return streams[protocol - 1][corrupted ? 1 : 0];
+}
+
+PipelineBenchmark::ParseResult PipelineBenchmark::parseStream(Serial::FrameProtocol protocol, bool corrupted) const
+{
+    Serial serial;
+    serial.setFrameProtocol(protocol);
+    qint64 emittedFrames = 0;
+    QObject::connect(&serial, &Serial::deviceSampleAvailable, &serial, [&emittedFrames](const DeviceSample&) { emittedFrames++; });
+
+    const QByteArray& input = stream(protocol, corrupted);
+    const char* data = input.constData();
+    const qsizetype size = input.size();
+    const qint64 timestamp = DeviceSample::currentTimestamp();
+
+    QElapsedTimer timer;
+    timer.start();
+    for(qsizetype offset = 0; offset < size; offset += CHUNK_SIZE)
+    {
+        serial.parseDeviceData(data + offset, static_cast<size_t>(qMin<qsizetype>(CHUNK_SIZE, size - offset)), timestamp);
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    if(corrupted)
+    {
+        qInfo("%lld of %d frames emitted, %d corrupted, %d lost", emittedFrames, FRAME_COUNT, serial.corruptedFrames(), serial.lostFrames());
+    }
+
+    return { elapsedNs, emittedFrames };
+}
+
+void PipelineBenchmark::bytesPerSecond_data()
+{
+    addStreamRows();
+}
+
+void PipelineBenchmark::bytesPerSecond()
+{
+    QFETCH(Serial::FrameProtocol, protocol);
+    QFETCH(bool, corrupted);
+
+    const ParseResult result = parseStream(protocol, corrupted);
+    QTest::setBenchmarkResult(stream(protocol, corrupted).size() * 1e9 / result.elapsedNs, QTest::BytesPerSecond);
+}
+
+void PipelineBenchmark::framesPerSecond_data()
+{
+    addStreamRows();
+}
+
+void PipelineBenchmark::framesPerSecond()
+{
+    QFETCH(Serial::FrameProtocol, protocol);
+    QFETCH(bool, corrupted);
+
+    const ParseResult result = parseStream(protocol, corrupted);
+    if(!corrupted)
+    {
+        QCOMPARE(result.emittedFrames, qint64(FRAME_COUNT));
+    }
+    QTest::setBenchmarkResult(result.emittedFrames * 1e9 / result.elapsedNs, QTest::FramesPerSecond);
+}
+
+void PipelineBenchmark::signalCost_data()
+{
+    QTest::addColumn<int>("receiverCount");
+    QTest::addColumn<Qt::ConnectionType>("connectionType");
+
+    QTest::addRow("no receiver") << 0 << Qt::DirectConnection;
+    QTest::addRow("1 direct receiver") << 1 << Qt::DirectConnection;
+    QTest::addRow("4 direct receivers") << 4 << Qt::DirectConnection;
+    // Delivery through the event loop, as for a receiver living on another thread
+    QTest::addRow("1 queued receiver") << 1 << Qt::QueuedConnection;
+}
+
+void PipelineBenchmark::signalCost()
+{
+    QFETCH(int, receiverCount);
+    QFETCH(Qt::ConnectionType, connectionType);
+
+    Serial serial;
+    qint64 receivedSamples = 0;
+    for(int i = 0; i < receiverCount; i++)
+    {
+        QObject::connect(&serial, &Serial::deviceSampleAvailable, &serial, [&receivedSamples](const DeviceSample&) { receivedSamples++; }, connectionType);
+    }
+
+    const DeviceSample sample = DeviceSample::fromFloat(Serial::DEVICE_INTERNAL_ADDRESS_LM35, DeviceSample::currentTimestamp(), 36.5f);
+
+    QElapsedTimer timer;
+    timer.start();
+    for(int i = 0; i < SIGNAL_COUNT; i++)
+    {
+        emit serial.deviceSampleAvailable(sample);
+    }
+    if(connectionType == Qt::QueuedConnection)
+    {
+        QCoreApplication::processEvents();
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    QCOMPARE(receivedSamples, qint64(SIGNAL_COUNT) * receiverCount);
+    QTest::setBenchmarkResult(double(elapsedNs) / SIGNAL_COUNT, QTest::WalltimeNanoseconds);
+}
+
+void PipelineBenchmark::endToEnd_data()
+{
+    addStreamRows();
+}
+
+void PipelineBenchmark::endToEnd()
+{
+    QFETCH(Serial::FrameProtocol, protocol);
+    QFETCH(bool, corrupted);
+
+    Serial serial;
+    serial.setFrameProtocol(protocol);
+    // Without a window every sample is published right away, so the binding is up to date when parseDeviceData() returns
+    ClusterState clusterState;
+    clusterState.setSource(&serial);
+
+    QQmlEngine engine;
+    engine.rootContext()->setContextProperty(QStringLiteral("clusterState"), &clusterState);
+    QQmlComponent component(&engine);
+    component.setData("import QtQml\n"
+                      "QtObject {\n"
+                      "    property int motorDuty: clusterState.motorDuty\n"
+                      "    property int updates: 0\n"
+                      "    onMotorDutyChanged: updates++\n"
+                      "}\n", QUrl());
+    std::unique_ptr<QObject> binding(component.create());
+    QVERIFY2(binding, qPrintable(component.errorString()));
+
+    // Feed the stream one frame at a time, a frame ends with its protocol's delimiter
+    const QByteArray& input = stream(protocol, corrupted);
+    const char delimiter = protocol == Serial::FRAME_PROTOCOL_V2 ? char(DEVICE_DATA_FRAME_V2_DELIMITER) : DEVICE_DATA_FRAME_END_DELIMITER;
+
+    std::vector<qint64> latenciesNs;
+    latenciesNs.reserve(FRAME_COUNT / 3);
+    int updates = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    qsizetype frameStart = 0;
+    while(frameStart < input.size())
+    {
+        qsizetype frameEnd = input.indexOf(delimiter, frameStart);
+        frameEnd = frameEnd < 0 ? input.size() : frameEnd + 1;
+
+        const qint64 startNs = timer.nsecsElapsed();
+        serial.parseDeviceData(input.constData() + frameStart, static_cast<size_t>(frameEnd - frameStart), DeviceSample::currentTimestamp());
+        const qint64 endNs = timer.nsecsElapsed();
+
+        // Only the frames that changed the bound property went all the way to QML
+        const int currentUpdates = binding->property("updates").toInt();
+        if(currentUpdates != updates)
+        {
+            updates = currentUpdates;
+            latenciesNs.push_back(endNs - startNs);
+        }
+        frameStart = frameEnd;
+    }
+
+    QVERIFY(!latenciesNs.empty());
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    const qint64 medianNs = latenciesNs[latenciesNs.size() / 2];
+    const qint64 p99Ns = latenciesNs[latenciesNs.size() * 99 / 100];
+    qInfo("%zu QML updates, median %lld ns, p99 %lld ns, max %lld ns", latenciesNs.size(), medianNs, p99Ns, latenciesNs.back());
+    QTest::setBenchmarkResult(double(medianNs), QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(PipelineBenchmark)
+
+#include "bench_pipeline.moc"
@@ -0,0 +1,15 @@
+include(../benchmarks.pri)
+
+# The end to end benchmark drives ClusterState and a QML binding
+QT += gui qml quick
+
+TARGET = bench_pipeline
+
+SOURCES += \
+        $$APP_SOURCE_DIR/clusterstate.cpp \
+        $$APP_SOURCE_DIR/speedintegrator.cpp \
+        bench_pipeline.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/clusterstate.h \
+        $$APP_SOURCE_DIR/speedintegrator.h
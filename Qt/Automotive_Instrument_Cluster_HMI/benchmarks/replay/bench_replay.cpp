@@ -0,0 +1,77 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include "capturereplay.h"
+#include "common/syntheticstream.h"
+
+/*
+ * Parser throughput over a raw serial capture, replayed unthrottled from its memory mapping.
+ *
+ * Set AICH_CAPTURE_FILE to the path of a real drive capture (recorded through the captureFile property of Serial or ThreadedSerial),
+ * and AICH_CAPTURE_PROTOCOL to 1 if it was recorded from a protocol v1 HMI node.
+ * Without it a synthetic capture of protocol v2 frames is generated.
+*/
+class ReplayBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void unthrottledReplay();
+
+private:
+    static constexpr int SYNTHETIC_FRAME_COUNT = 1000000;
+    static constexpr int SYNTHETIC_CHUNK_SIZE = 64;
+
+    QTemporaryDir temporaryDir;
+    QString captureFilePath;
+    Serial::FrameProtocol protocol = Serial::FRAME_PROTOCOL_V2;
+};
+
+void ReplayBenchmark::initTestCase()
+{
+    captureFilePath = qEnvironmentVariable("AICH_CAPTURE_FILE");
+    if(!captureFilePath.isEmpty())
+    {
+        if(qEnvironmentVariableIntValue("AICH_CAPTURE_PROTOCOL") == 1)
+        {
+            protocol = Serial::FRAME_PROTOCOL_V1;
+        }
+        return;
+    }
+
+    // Synthetic capture: chunks as a 1 kHz frame rate would hand them over
+    QVERIFY(temporaryDir.isValid());
+    captureFilePath = temporaryDir.filePath(QStringLiteral("synthetic.cap"));
+
+    const QByteArray stream = makeDeviceDataStream(SYNTHETIC_FRAME_COUNT);
+    CaptureRecorder recorder;
+    QVERIFY(recorder.open(captureFilePath));
+    qint64 timestamp = 0;
+    for(qsizetype offset = 0; offset < stream.size(); offset += SYNTHETIC_CHUNK_SIZE)
+    {
+        recorder.record(stream.constData() + offset, static_cast<size_t>(qMin<qsizetype>(SYNTHETIC_CHUNK_SIZE, stream.size() - offset)), timestamp);
+        timestamp += 6000000;
+    }
+    recorder.close();
+}
+
+void ReplayBenchmark::unthrottledReplay()
+{
+    CaptureReplay replay;
+    replay.setFile(captureFilePath);
+    replay.setFrameProtocol(protocol);
+
+    QElapsedTimer timer;
+    timer.start();
+    const size_t samples = replay.replayAll();
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    QVERIFY(samples > 0);
+    qInfo("%zu samples from %llu bytes, %.1f MB/s", samples, replay.replayedBytes(), replay.replayedBytes() * 1e3 / elapsedNs);
+    QTest::setBenchmarkResult(samples * 1e9 / elapsedNs, QTest::FramesPerSecond);
+}
+
+QTEST_GUILESS_MAIN(ReplayBenchmark)
+
+#include "bench_replay.moc"
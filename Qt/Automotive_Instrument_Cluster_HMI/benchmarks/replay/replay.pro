@@ -0,0 +1,6 @@
+include(../benchmarks.pri)
+
+TARGET = bench_replay
+
+SOURCES += \
+        bench_replay.cpp
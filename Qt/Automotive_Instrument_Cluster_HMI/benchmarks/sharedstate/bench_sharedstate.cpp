@@ -0,0 +1,190 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <atomic>
+#include <thread>
+#include "sharedstatereader.h"
+#include "sharedstatewriter.h"
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+/*
+ * Reads of the shared vehicle state segment through SharedStateReader, as another process would:
+ *  - readState: nanoseconds per copy of the latest state, idle writer and writer updating it back to back on another thread
+ *  - readSamples: nanoseconds per sample read from the ring in batches of BATCH_SIZE, same two cases
+ *
+ * A read must stay well under a microsecond even against a writer that never pauses, and the writer rate must not depend on the readers.
+*/
+class SharedStateBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void readState_data();
+    void readState();
+    void readSamples_data();
+    void readSamples();
+
+private:
+    static constexpr uint32_t RING_CAPACITY = 4096;
+    static constexpr int READ_COUNT = 1000000;
+    static constexpr size_t BATCH_SIZE = 64;
+
+    // Writes the state and pushes a sample back to back until stopped, returns the number of writes
+    quint64 runWriter(std::atomic<bool>& stop);
+
+    QByteArray segmentName;
+    SharedStateWriter writer;
+    SharedStateReader reader;
+    quint64 written = 0;
+};
+
+void SharedStateBenchmark::initTestCase()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Needs POSIX shared memory");
+#else
+    segmentName = "/bench_sharedstate_" + QByteArray::number(static_cast<qint64>(getpid()));
+    QVERIFY2(writer.open(segmentName.constData(), RING_CAPACITY), writer.errorString().c_str());
+    QVERIFY2(reader.open(segmentName.constData()), reader.errorString().c_str());
+
+    // Something to read in the idle case
+    std::atomic<bool> stop { true };
+    runWriter(stop);
+#endif
+}
+
+void SharedStateBenchmark::cleanupTestCase()
+{
+    reader.close();
+    writer.close();
+}
+
+quint64 SharedStateBenchmark::runWriter(std::atomic<bool>& stop)
+{
+    quint64 writes = 0;
+    do
+    {
+        for(uint32_t i = 0; i < RING_CAPACITY; i++, written++, writes++)
+        {
+            SharedVehicleState state = {};
+            state.timestamp = static_cast<int64_t>(written);
+            state.speed = static_cast<double>(written % 180);
+            state.accelerometer = 0.25;
+            state.temperature = 21.5;
+            state.motorDuty = static_cast<int32_t>(written % 256);
+            state.publishCount = written + 1;
+            writer.writeState(state);
+
+            SharedSample sample = {};
+            sample.timestamp = static_cast<int64_t>(written);
+            sample.value = static_cast<float>(written % 1000);
+            sample.deviceAddress = 2;
+            sample.payloadType = 2;
+            writer.pushSample(sample);
+        }
+    }
+    while(!stop.load(std::memory_order_relaxed));
+    return writes;
+}
+
+void SharedStateBenchmark::readState_data()
+{
+    QTest::addColumn<bool>("contended");
+
+    QTest::newRow("idle writer") << false;
+    QTest::newRow("writer updating") << true;
+}
+
+void SharedStateBenchmark::readState()
+{
+    QFETCH(bool, contended);
+
+    std::atomic<bool> stop { false };
+    std::atomic<quint64> writes { 0 };
+    std::thread writerThread;
+    if(contended)
+    {
+        writerThread = std::thread([this, &stop, &writes]() { writes.store(runWriter(stop), std::memory_order_relaxed); });
+    }
+
+    SharedVehicleState state;
+    int inconsistent = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for(int i = 0; i < READ_COUNT; i++)
+    {
+        reader.readState(state);
+        // Fields written together are read together
+        inconsistent += state.publishCount != static_cast<uint64_t>(state.timestamp) + 1 ? 1 : 0;
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    stop.store(true, std::memory_order_relaxed);
+    if(writerThread.joinable())
+    {
+        writerThread.join();
+        qInfo("%.1f M writes/s meanwhile", writes.load() / (elapsedNs / 1e9) / 1e6);
+    }
+
+    QCOMPARE(inconsistent, 0);
+    QTest::setBenchmarkResult(double(elapsedNs) / READ_COUNT, QTest::WalltimeNanoseconds);
+}
+
+void SharedStateBenchmark::readSamples_data()
+{
+    readState_data();
+}
+
+void SharedStateBenchmark::readSamples()
+{
+    QFETCH(bool, contended);
+
+    std::atomic<bool> stop { false };
+    std::thread writerThread;
+    if(contended)
+    {
+        writerThread = std::thread([this, &stop]() { runWriter(stop); });
+    }
+
+    SharedSample samples[BATCH_SIZE];
+    quint64 read = 0;
+    uint64_t missed = 0;
+    uint64_t cursor = 0;
+    int outOfOrder = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for(int i = 0; i < READ_COUNT / static_cast<int>(BATCH_SIZE); i++)
+    {
+        // Idle, the ring is read again from its oldest sample every time. Otherwise the cursor follows the writer, as a consumer would
+        if(!contended)
+        {
+            cursor = 0;
+        }
+        const size_t count = reader.readSamples(cursor, samples, BATCH_SIZE, &missed);
+        for(size_t j = 1; j < count; j++)
+        {
+            outOfOrder += samples[j].timestamp != samples[j - 1].timestamp + 1 ? 1 : 0;
+        }
+        read += count;
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    stop.store(true, std::memory_order_relaxed);
+    if(writerThread.joinable())
+    {
+        writerThread.join();
+    }
+
+    qInfo("%llu samples read, %llu overwritten before being read", static_cast<unsigned long long>(read), static_cast<unsigned long long>(missed));
+    QVERIFY(read > 0);
+    QCOMPARE(outOfOrder, 0);
+    QTest::setBenchmarkResult(double(elapsedNs) / read, QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(SharedStateBenchmark)
+
+#include "bench_sharedstate.moc"
@@ -0,0 +1,16 @@
+include(../benchmarks.pri)
+
+TARGET = bench_sharedstate
+
+SOURCES += \
+        $$APP_SOURCE_DIR/sharedstatereader.cpp \
+        $$APP_SOURCE_DIR/sharedstatewriter.cpp \
+        bench_sharedstate.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/sharedstatelayout.h \
+        $$APP_SOURCE_DIR/sharedstatereader.h \
+        $$APP_SOURCE_DIR/sharedstatewriter.h
+
+# shm_open() lives in librt before glibc 2.34
+linux: LIBS += -lrt
@@ -0,0 +1,121 @@
+#include "capturefile.h"
+#include <QtEndian>
+#include <cstring>
+
+bool CaptureRecorder::open(const QString& filePath)
+{
+    close();
+
+    file.setFileName(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("CaptureRecorder: can't open %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        return false;
+    }
+
+    char header[CAPTURE_FILE_HEADER_SIZE] = { 0 };
+    memcpy(header, CAPTURE_FILE_MAGIC, 8);
+    qToLittleEndian<quint32>(CAPTURE_FILE_VERSION, header + 8);
+    file.write(header, sizeof(header));
+
+    return true;
+}
+
+void CaptureRecorder::close()
+{
+    if(file.isOpen())
+    {
+        file.close();
+    }
+}
+
+void CaptureRecorder::record(const char* data, size_t size, int64_t timestamp)
+{
+    if(!file.isOpen() || size == 0)
+    {
+        return;
+    }
+
+    char recordHeader[CAPTURE_FILE_RECORD_HEADER_SIZE];
+    qToLittleEndian<qint64>(timestamp, recordHeader);
+    qToLittleEndian<quint32>(static_cast<quint32>(size), recordHeader + 8);
+
+    // QFile buffers the writes, so a record doesn't cost a system call
+    file.write(recordHeader, sizeof(recordHeader));
+    file.write(data, static_cast<qint64>(size));
+}
+
+bool CaptureReader::open(const QString& filePath)
+{
+    close();
+
+    file.setFileName(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qWarning("CaptureReader: can't open %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    if(fileSize < CAPTURE_FILE_HEADER_SIZE)
+    {
+        qWarning("CaptureReader: %s is not a capture file", qPrintable(filePath));
+        file.close();
+        return false;
+    }
+
+    mappedData = file.map(0, fileSize);
+    if(!mappedData)
+    {
+        qWarning("CaptureReader: can't map %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        file.close();
+        return false;
+    }
+    mappedSize = static_cast<size_t>(fileSize);
+
+    if(memcmp(mappedData, CAPTURE_FILE_MAGIC, 8) != 0 || qFromLittleEndian<quint32>(mappedData + 8) != CAPTURE_FILE_VERSION)
+    {
+        qWarning("CaptureReader: %s is not a version %d capture file", qPrintable(filePath), CAPTURE_FILE_VERSION);
+        close();
+        return false;
+    }
+
+    rewind();
+    return true;
+}
+
+void CaptureReader::close()
+{
+    if(mappedData)
+    {
+        file.unmap(const_cast<uchar*>(mappedData));
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+    if(file.isOpen())
+    {
+        file.close();
+    }
+}
+
+bool CaptureReader::next(Chunk& chunk)
+{
+    if(!mappedData || mappedSize - readOffset < CAPTURE_FILE_RECORD_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    const uchar* record = mappedData + readOffset;
+    const size_t chunkSize = qFromLittleEndian<quint32>(record + 8);
+    if(mappedSize - readOffset - CAPTURE_FILE_RECORD_HEADER_SIZE < chunkSize)
+    {
+        return false;
+    }
+
+    chunk.timestamp = qFromLittleEndian<qint64>(record);
+    chunk.data = reinterpret_cast<const char*>(record + CAPTURE_FILE_RECORD_HEADER_SIZE);
+    chunk.size = chunkSize;
+    readOffset += CAPTURE_FILE_RECORD_HEADER_SIZE + chunkSize;
+
+    return true;
+}
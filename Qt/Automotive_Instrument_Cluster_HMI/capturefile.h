@@ -0,0 +1,112 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Raw serial capture file.
+ *
+ * Header (16 bytes): CAPTURE_FILE_MAGIC (8 bytes) -> Format version (uint32) -> Reserved (uint32)
+ * Then one record per chunk read from the port:
+ *      Monotonic arrival timestamp in nanoseconds (int64) -> Chunk size (uint32) -> Chunk bytes
+ *
+ * All the integers are little-endian. The chunks are the exact bytes read from the port, before any parsing,
+ * so replaying a capture reproduces the parser input including split frames and line noise.
+*/
+#define CAPTURE_FILE_MAGIC "AICHCAP\0"
+#define CAPTURE_FILE_VERSION 1
+#define CAPTURE_FILE_HEADER_SIZE 16
+#define CAPTURE_FILE_RECORD_HEADER_SIZE 12
+
+/*
+ * Appends received chunks to a capture file. Not thread safe, it must be used by one thread at a time, the one reading the port
+*/
+class CaptureRecorder
+{
+public:
+    ~CaptureRecorder() { close(); }
+
+    /*
+     * @brief Create (or truncate) the capture file and write its header
+     *
+     * @return false if the file can't be written
+    */
+    bool open(const QString& filePath);
+
+    void close();
+
+    bool isOpen() const { return file.isOpen(); }
+    // Path of the open capture file, empty if none
+    QString filePath() const { return file.isOpen() ? file.fileName() : QString(); }
+
+    // Write the buffered records to the file, e.g. while the port is closed
+    void flush() { file.flush(); }
+
+    /*
+     * @brief Append a received chunk
+     *
+     * @param data          Received bytes
+     * @param size          Number of received bytes
+     * @param timestamp     Monotonic arrival time of the chunk in nanoseconds
+     *
+     * @return void
+    */
+    void record(const char* data, size_t size, int64_t timestamp);
+
+private:
+    QFile file;
+};
+
+/*
+ * Reads the records of a capture file through a memory mapping, without copying the chunk bytes
+*/
+class CaptureReader
+{
+public:
+    struct Chunk
+    {
+        int64_t timestamp;
+        const char* data;
+        size_t size;
+    };
+
+    ~CaptureReader() { close(); }
+
+    /*
+     * @brief Map the capture file and check its header
+     *
+     * @return false if the file can't be mapped or is not a capture file
+    */
+    bool open(const QString& filePath);
+
+    void close();
+
+    bool isOpen() const { return mappedData != nullptr; }
+
+    /*
+     * @brief Read the next record, the chunk bytes stay valid until close()
+     *
+     * A truncated last record (e.g. the recorder was killed) ends the capture
+     *
+     * @return false at the end of the capture
+    */
+    bool next(Chunk& chunk);
+
+    // Go back to the first record
+    void rewind() { readOffset = CAPTURE_FILE_HEADER_SIZE; }
+
+    size_t size() const { return mappedSize; }
+    // Bytes of the mapped file already read, header included
+    size_t position() const { return readOffset; }
+
+private:
+    QFile file;
+    const uchar* mappedData = nullptr;
+    size_t mappedSize = 0;
+    size_t readOffset = 0;
+};
+
+#endif // CAPTUREFILE_H
@@ -0,0 +1,156 @@
+#include "capturereplay.h"
+#include <QElapsedTimer>
+
+// Longest time an unthrottled replay keeps the event loop busy in one go
+#define UNTHROTTLED_REPLAY_SLICE_NS 5000000
+
+CaptureReplay::CaptureReplay(QObject* parent) : QObject(parent)
+{
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&timer, &QTimer::timeout, this, &CaptureReplay::replayDueChunks);
+}
+
+void CaptureReplay::setFile(const QString& file)
+{
+    if(filePath != file)
+    {
+        stop();
+        filePath = file;
+        emit fileChanged(file);
+    }
+}
+
+void CaptureReplay::setSpeed(double speed)
+{
+    if(speedFactor != speed && speed >= 0.0)
+    {
+        speedFactor = speed;
+        emit speedChanged(speed);
+    }
+}
+
+void CaptureReplay::setFrameProtocol(Serial::FrameProtocol frameProtocol)
+{
+    if(parser.frameProtocol() != static_cast<DeviceDataParser::FrameProtocol>(frameProtocol))
+    {
+        parser.setFrameProtocol(static_cast<DeviceDataParser::FrameProtocol>(frameProtocol));
+        emit frameProtocolChanged(frameProtocol);
+    }
+}
+
+size_t CaptureReplay::replayAll()
+{
+    stop();
+    if(!openCapture())
+    {
+        return 0;
+    }
+
+    size_t samples = 0;
+    CaptureReader::Chunk chunk;
+    while(reader.next(chunk))
+    {
+        bytes += chunk.size;
+        samples += parser.parse(chunk.data, chunk.size, replayStartTimestamp + (chunk.timestamp - firstRecordedTimestamp),
+                                [this](const DeviceSample& sample) { emit deviceSampleAvailable(sample); });
+    }
+
+    reader.close();
+    emit finished();
+    return samples;
+}
+
+void CaptureReplay::start()
+{
+    stop();
+    if(openCapture())
+    {
+        setRunning(true);
+        replayDueChunks();
+    }
+}
+
+void CaptureReplay::stop()
+{
+    timer.stop();
+    hasPendingChunk = false;
+    reader.close();
+    setRunning(false);
+}
+
+bool CaptureReplay::openCapture()
+{
+    if(!reader.open(filePath))
+    {
+        return false;
+    }
+
+    bytes = 0;
+    hasPendingChunk = false;
+    replayStartTimestamp = DeviceSample::currentTimestamp();
+
+    // The first record sets the origin of the recorded timing
+    CaptureReader::Chunk firstChunk;
+    firstRecordedTimestamp = reader.next(firstChunk) ? firstChunk.timestamp : 0;
+    reader.rewind();
+
+    return true;
+}
+
+void CaptureReplay::replayDueChunks()
+{
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+
+    while(isRunning)
+    {
+        if(!hasPendingChunk && !(hasPendingChunk = reader.next(pendingChunk)))
+        {
+            stop();
+            emit finished();
+            return;
+        }
+
+        if(speedFactor > 0.0)
+        {
+            // Wait until the chunk is due
+            const qint64 remainingNs = replayTimestamp(pendingChunk.timestamp) - DeviceSample::currentTimestamp();
+            if(remainingNs > 0)
+            {
+                timer.start(static_cast<int>(remainingNs / 1000000));
+                return;
+            }
+        }
+        else if(sliceTimer.nsecsElapsed() > UNTHROTTLED_REPLAY_SLICE_NS)
+        {
+            // Let the event loop run, then carry on
+            timer.start(0);
+            return;
+        }
+
+        feed(pendingChunk);
+        hasPendingChunk = false;
+    }
+}
+
+void CaptureReplay::feed(const CaptureReader::Chunk& chunk)
+{
+    bytes += chunk.size;
+    parser.parse(chunk.data, chunk.size, replayTimestamp(chunk.timestamp), [this](const DeviceSample& sample) { emit deviceSampleAvailable(sample); });
+}
+
+qint64 CaptureReplay::replayTimestamp(qint64 recordedTimestamp) const
+{
+    const qint64 recordedOffset = recordedTimestamp - firstRecordedTimestamp;
+    return replayStartTimestamp + (speedFactor > 0.0 ? static_cast<qint64>(recordedOffset / speedFactor) : recordedOffset);
+}
+
+void CaptureReplay::setRunning(bool running)
+{
+    if(isRunning != running)
+    {
+        isRunning = running;
+        emit runningChanged(running);
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef CAPTUREREPLAY_H
+#define CAPTUREREPLAY_H
+
+#include <QObject>
+#include <QTimer>
+#include "capturefile.h"
+#include "devicedataparser.h"
+#include "devicesample.h"
+#include "serial.h"
+
+/*
+ * Replays a raw serial capture (see CaptureRecorder) through the same DeviceDataParser used for the live port.
+ *
+ * The chunks are fed at their recorded pace scaled by speed (1 = real time, N = N times faster), or as fast as possible with speed 0.
+ * Sample timestamps keep the recorded spacing (scaled by speed), rebased on the start of the replay.
+ *
+ * It emits deviceSampleAvailable() like Serial and ThreadedSerial, so it can be the source of a ClusterState.
+*/
+class CaptureReplay : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString file READ file WRITE setFile NOTIFY fileChanged)
+    // Replay speed factor of the recorded timing, 0 replays unthrottled
+    Q_PROPERTY(double speed READ speed WRITE setSpeed NOTIFY speedChanged)
+    Q_PROPERTY(Serial::FrameProtocol frameProtocol READ frameProtocol WRITE setFrameProtocol NOTIFY frameProtocolChanged)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+
+public:
+    CaptureReplay(QObject* parent = nullptr);
+
+    QString file() const { return filePath; }
+    void setFile(const QString& file);
+
+    double speed() const { return speedFactor; }
+    void setSpeed(double speed);
+
+    Serial::FrameProtocol frameProtocol() const { return static_cast<Serial::FrameProtocol>(parser.frameProtocol()); }
+    void setFrameProtocol(Serial::FrameProtocol frameProtocol);
+
+    bool running() const { return isRunning; }
+
+    /*
+     * @brief Replay the whole capture right now, ignoring speed, and return once done
+     *
+     * Meant for benchmarking the parser over real drive data
+     *
+     * @return Number of samples emitted, 0 if the file can't be opened
+    */
+    size_t replayAll();
+
+    // Bytes fed to the parser since the last start
+    quint64 replayedBytes() const { return bytes; }
+    // See DeviceDataParser::corruptedFrameCount() and DeviceDataParser::lostFrameCount()
+    size_t corruptedFrames() const { return parser.corruptedFrameCount(); }
+    size_t lostFrames() const { return parser.lostFrameCount(); }
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Start replaying from the beginning of the capture
+     *
+     * @return void
+    */
+    void start();
+
+    /*
+     * @brief [SLOT] Stop replaying
+     *
+     * @return void
+    */
+    void stop();
+
+Q_SIGNALS:
+    void fileChanged(QString file);
+    void speedChanged(double speed);
+    void frameProtocolChanged(Serial::FrameProtocol frameProtocol);
+    void runningChanged(bool running);
+
+    // The whole capture was replayed
+    void finished();
+
+    /*
+     * @brief [SIGNAL] Emitted/Called whenever a complete device data frame is parsed from the capture
+     *
+     * @return void
+    */
+    void deviceSampleAvailable(DeviceSample sample);
+
+private:
+    /*
+     * @brief [SLOT] Feed every chunk that is due, then wait for the next one
+     *
+     * @return void
+    */
+    void replayDueChunks();
+
+    /*
+     * @brief Open the capture and reset the replay clock
+     *
+     * @return false if the capture can't be opened
+    */
+    bool openCapture();
+
+    void feed(const CaptureReader::Chunk& chunk);
+
+    // Replay timestamp of a recorded timestamp
+    qint64 replayTimestamp(qint64 recordedTimestamp) const;
+
+    void setRunning(bool running);
+
+    QString filePath;
+    double speedFactor = 1.0;
+    DeviceDataParser parser;
+    CaptureReader reader;
+    QTimer timer;
+
+    CaptureReader::Chunk pendingChunk = { 0, nullptr, 0 };
+    bool hasPendingChunk = false;
+    qint64 firstRecordedTimestamp = 0;
+    qint64 replayStartTimestamp = 0;
+    quint64 bytes = 0;
+    bool isRunning = false;
+};
+
+#endif // CAPTUREREPLAY_H
@@ -0,0 +1,128 @@
+#include "clusterstate.h"
+#include "devicedataparser.h"
+
+ClusterState::ClusterState(QObject* parent) : QObject(parent)
+{
+}
+
+void ClusterState::setSource(QObject* source)
+{
+    if(sampleSource == source)
+    {
+        return;
+    }
+
+    QObject::disconnect(sourceConnection);
+    sampleSource = source;
+    if(sampleSource)
+    {
+        // String based, so any object with the signal can feed the state
+        sourceConnection = QObject::connect(sampleSource, SIGNAL(deviceSampleAvailable(DeviceSample)), this, SLOT(addSample(DeviceSample)));
+        if(!sourceConnection)
+        {
+            qWarning("ClusterState: source has no deviceSampleAvailable(DeviceSample) signal");
+        }
+    }
+    emit sourceChanged(source);
+}
+
+void ClusterState::setWindow(QQuickWindow* window)
+{
+    if(paceWindow == window)
+    {
+        return;
+    }
+
+    QObject::disconnect(paceConnection);
+    paceWindow = window;
+    if(paceWindow)
+    {
+        /*
+         * beforeSynchronizing() is emitted on the render thread with the threaded render loop. Queue the publishing to this object's (GUI) thread,
+         * it then runs once per frame right after the synchronization, and the changed bindings show on the next frame
+        */
+        paceConnection = QObject::connect(paceWindow, &QQuickWindow::beforeSynchronizing, this, &ClusterState::publish, Qt::QueuedConnection);
+    }
+    emit windowChanged(window);
+}
+
+void ClusterState::setMaxSpeed(double maxSpeed)
+{
+    if(speedIntegrator.maxSpeed() != maxSpeed)
+    {
+        speedIntegrator.setMaxSpeed(maxSpeed);
+        emit maxSpeedChanged(maxSpeed);
+    }
+}
+
+void ClusterState::addSample(const DeviceSample& sample)
+{
+    switch(sample.deviceAddress())
+    {
+        case DeviceDataParser::DEVICE_INTERNAL_ADDRESS_MOTOR:
+            pending.motorDuty = sample.byteData();
+            break;
+        case DeviceDataParser::DEVICE_INTERNAL_ADDRESS_ACCELEROMETER:
+            pending.accelerometer = sample.floatData();
+            speedIntegrator.addSample(pending.accelerometer, sample.timestamp());
+            pending.speed = speedIntegrator.speed();
+            break;
+        case DeviceDataParser::DEVICE_INTERNAL_ADDRESS_LM35:
+            pending.temperature = sample.floatData();
+            break;
+        default:
+            return;
+    }
+
+    pendingSample = true;
+    pendingReceivedTimestamp = sample.timestamp();
+    pendingDecodedTimestamp = sample.decodedTimestamp();
+
+    schedulePublish();
+}
+
+void ClusterState::publish()
+{
+    publishScheduled = false;
+
+    // Update all the values first, so a NOTIFY handler reading another property sees the same frame
+    const Values previous = published;
+    published = pending;
+
+    if(published.accelerometer != previous.accelerometer)
+    {
+        emit accelerometerChanged(published.accelerometer);
+    }
+    if(published.temperature != previous.temperature)
+    {
+        emit temperatureChanged(published.temperature);
+    }
+    if(published.motorDuty != previous.motorDuty)
+    {
+        emit motorDutyChanged(published.motorDuty);
+    }
+    if(published.speed != previous.speed)
+    {
+        emit speedChanged(published.speed);
+    }
+
+    if(pendingSample)
+    {
+        pendingSample = false;
+        emit valuesPublished(pendingReceivedTimestamp, pendingDecodedTimestamp);
+    }
+}
+
+void ClusterState::schedulePublish()
+{
+    if(!paceWindow)
+    {
+        publish();
+    }
+    // Nothing may be animating, make sure a frame is coming to publish the new values
+    else if(!publishScheduled)
+    {
+        publishScheduled = true;
+        paceWindow->update();
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef CLUSTERSTATE_H
+#define CLUSTERSTATE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include "devicesample.h"
+#include "speedintegrator.h"
+
+/*
+ * Latest value of every cluster gauge, published to QML at most once per displayed frame.
+ *
+ * Incoming samples only overwrite the pending values. The pending values are published on [SIGNAL] QQuickWindow::beforeSynchronizing()
+ * of the given window, and a NOTIFY signal is emitted only for the values that actually changed since the last frame,
+ * so binding re-evaluations scale with the display refresh rate instead of the serial sample rate.
+ *
+ * Without a window every update is published right away.
+ *
+ * The speed is integrated from every accelerometer sample with its arrival timestamp, see SpeedIntegrator.
+*/
+class ClusterState : public QObject
+{
+    Q_OBJECT
+    // Object emitting deviceSampleAvailable(DeviceSample), e.g. Serial or ThreadedSerial
+    Q_PROPERTY(QObject* source READ source WRITE setSource NOTIFY sourceChanged)
+    // Window whose frames pace the publishing of the values
+    Q_PROPERTY(QQuickWindow* window READ window WRITE setWindow NOTIFY windowChanged)
+    // Accelerometer in (G)s
+    Q_PROPERTY(double accelerometer READ accelerometer NOTIFY accelerometerChanged)
+    // Temperature in Celsius
+    Q_PROPERTY(double temperature READ temperature NOTIFY temperatureChanged)
+    // Motor PWM duty cycle
+    Q_PROPERTY(int motorDuty READ motorDuty NOTIFY motorDutyChanged)
+    // Speed in Km/h, integrated from the accelerometer
+    Q_PROPERTY(double speed READ speed NOTIFY speedChanged)
+    // Cap of the speed in Km/h, for both directions of travel
+    Q_PROPERTY(double maxSpeed READ maxSpeed WRITE setMaxSpeed NOTIFY maxSpeedChanged)
+
+public:
+    ClusterState(QObject* parent = nullptr);
+
+    QObject* source() const { return sampleSource; }
+    void setSource(QObject* source);
+
+    QQuickWindow* window() const { return paceWindow; }
+    void setWindow(QQuickWindow* window);
+
+    double accelerometer() const { return published.accelerometer; }
+    double temperature() const { return published.temperature; }
+    int motorDuty() const { return published.motorDuty; }
+    double speed() const { return published.speed; }
+
+    double maxSpeed() const { return speedIntegrator.maxSpeed(); }
+    void setMaxSpeed(double maxSpeed);
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Take a decoded device sample into the pending values
+     *
+     * @return void
+    */
+    void addSample(const DeviceSample& sample);
+
+    /*
+     * @brief [SLOT] Publish the pending values, emitting the NOTIFY signals of the values that changed
+     *
+     * @return void
+    */
+    void publish();
+
+Q_SIGNALS:
+    void sourceChanged(QObject* source);
+    void windowChanged(QQuickWindow* window);
+    void accelerometerChanged(double accelerometer);
+    void temperatureChanged(double temperature);
+    void motorDutyChanged(int motorDuty);
+    void speedChanged(double speed);
+    void maxSpeedChanged(double maxSpeed);
+
+    /*
+     * @brief [SIGNAL] Emitted by publish() when samples arrived since the previous publish, see LatencyProbe
+     *
+     * @param receivedTimestamp     Arrival time of the newest published sample, see DeviceSample::timestamp()
+     * @param decodedTimestamp      Decode time of the newest published sample, see DeviceSample::decodedTimestamp()
+     *
+     * @return void
+    */
+    void valuesPublished(qint64 receivedTimestamp, qint64 decodedTimestamp);
+
+private:
+    struct Values
+    {
+        double accelerometer = 0.0;
+        double temperature = 0.0;
+        int motorDuty = 0;
+        double speed = 0.0;
+    };
+
+    /*
+     * @brief Publish on the next frame of the window, or right away without a window
+     *
+     * @return void
+    */
+    void schedulePublish();
+
+    SpeedIntegrator speedIntegrator;
+    Values pending;
+    Values published;
+    bool publishScheduled = false;
+    // Timestamps of the newest sample taken since the last publish, if any
+    bool pendingSample = false;
+    qint64 pendingReceivedTimestamp = 0;
+    qint64 pendingDecodedTimestamp = 0;
+
+    QPointer<QObject> sampleSource;
+    QMetaObject::Connection sourceConnection;
+    QPointer<QQuickWindow> paceWindow;
+    QMetaObject::Connection paceConnection;
+};
+
+#endif // CLUSTERSTATE_H
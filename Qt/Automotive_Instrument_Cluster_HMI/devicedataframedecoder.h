@@ -0,0 +1,121 @@
+#ifndef DEVICEDATAFRAMEDECODER_H
+#define DEVICEDATAFRAMEDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ATMega32A/Protocol/DeviceProtocol.h>
+
+#define DEVICE_DATA_FRAME_START_DELIMITER DEVICE_DATA_FRAME_V1_START_DELIMITER
+#define DEVICE_DATA_FRAME_END_DELIMITER DEVICE_DATA_FRAME_V1_END_DELIMITER
+
+/*
+ * Resumable decoder for the device data frames sent by the HMI node:
+ *
+ *      DEVICE_DATA_FRAME_START_DELIMITER -> Device address -> Device data (1 or 4 bytes) -> DEVICE_DATA_FRAME_END_DELIMITER
+ *
+ * The decoder keeps its state between decode() calls, so a frame can be split across any number of chunks,
+ * and a single chunk can hold any number of frames.
+*/
+class DeviceDataFrameDecoder
+{
+public:
+    struct Frame
+    {
+        uint8_t deviceAddress;
+        const uint8_t* payload;
+        size_t payloadSize;
+    };
+
+    /*
+     * @brief Walk all the bytes of a received chunk and call onFrame() for every complete device data frame in it
+     *
+     * @param data          Received bytes
+     * @param size          Number of received bytes
+     * @param onFrame       Callable with the signature void(const DeviceDataFrameDecoder::Frame&).
+     *                      The frame payload is only valid during the call
+     *
+     * @return Number of complete frames decoded from this chunk
+    */
+    template<typename FrameCallback>
+    size_t decode(const char* data, size_t size, FrameCallback&& onFrame);
+
+    /*
+     * @brief Drop any partially received frame and wait for the next DEVICE_DATA_FRAME_START_DELIMITER
+     *
+     * @return void
+    */
+    void reset();
+
+    // Number of frames dropped because no DEVICE_DATA_FRAME_END_DELIMITER was found within the max frame size
+    size_t overflowCount() const { return overflows; }
+
+private:
+    enum class State
+    {
+        WaitingForStartDelimiter,
+        ReadingFrame
+    };
+
+    /*
+     * Buffer size = Max device data frame size:
+     *          1 byte for the device address, DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE bytes max for devices's data, and 1 byte for the DEVICE_DATA_FRAME_END_DELIMITER
+     *
+     * Note that DEVICE_DATA_FRAME_START_DELIMITER is never stored in the buffer, as such there is no space allocated in the buffer for it.
+    */
+    uint8_t receivedDataBuffer[1 + DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE + 1] = { 0 };
+    size_t receivedDataBufferIndex = 0;
+    State state = State::WaitingForStartDelimiter;
+    size_t overflows = 0;
+};
+
+template<typename FrameCallback>
+size_t DeviceDataFrameDecoder::decode(const char* data, size_t size, FrameCallback&& onFrame)
+{
+    size_t decodedFrames = 0;
+
+    for(size_t i = 0; i < size; i++)
+    {
+        const uint8_t byte = static_cast<uint8_t>(data[i]);
+
+        if(state == State::WaitingForStartDelimiter)
+        {
+            // Skip everything until the start of the next frame
+            if(byte == DEVICE_DATA_FRAME_START_DELIMITER)
+            {
+                state = State::ReadingFrame;
+                receivedDataBufferIndex = 0;
+            }
+            continue;
+        }
+
+        receivedDataBuffer[receivedDataBufferIndex] = byte;
+
+        // Reached the end of the frame, first byte in the device data frame is the device address followed by the device data
+        if(byte == DEVICE_DATA_FRAME_END_DELIMITER)
+        {
+            const Frame frame = { receivedDataBuffer[0], receivedDataBuffer + 1, receivedDataBufferIndex > 0 ? receivedDataBufferIndex - 1 : 0 };
+            state = State::WaitingForStartDelimiter;
+            decodedFrames++;
+            onFrame(frame);
+        }
+        /*
+         * If DEVICE_DATA_FRAME_END_DELIMITER hasn't been reached yet, then move to the next index in the buffer to write the next byte.
+         * A frame that doesn't fit in the buffer is garbage, drop it and resync on the next DEVICE_DATA_FRAME_START_DELIMITER
+        */
+        else if(++receivedDataBufferIndex == sizeof(receivedDataBuffer))
+        {
+            state = State::WaitingForStartDelimiter;
+            overflows++;
+        }
+    }
+
+    return decodedFrames;
+}
+
+inline void DeviceDataFrameDecoder::reset()
+{
+    state = State::WaitingForStartDelimiter;
+    receivedDataBufferIndex = 0;
+}
+
+#endif // DEVICEDATAFRAMEDECODER_H
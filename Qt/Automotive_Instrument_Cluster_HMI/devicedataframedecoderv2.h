@@ -0,0 +1,256 @@
+#ifndef DEVICEDATAFRAMEDECODERV2_H
+#define DEVICEDATAFRAMEDECODERV2_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "devicedataframedecoder.h"
+
+// The wire format is defined once for the firmware and the application, in ATMega32A/Protocol/DeviceProtocol.h
+#define DEVICE_DATA_FRAME_V2_DELIMITER DEVICE_DATA_FRAME_DELIMITER
+#define DEVICE_DATA_FRAME_V2_MAX_PAYLOAD_SIZE DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE
+#define DEVICE_DATA_FRAME_V2_MAX_SIZE DEVICE_DATA_FRAME_MAX_SIZE
+// COBS adds one overhead byte for frames shorter than 254 bytes
+#define DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE (DEVICE_DATA_FRAME_V2_MAX_SIZE + 1)
+
+// Lookup table for the CRC-8 with polynomial DEVICE_DATA_FRAME_CRC8_POLYNOMIAL
+constexpr std::array<uint8_t, 256> makeDeviceDataFrameCrc8Table()
+{
+    std::array<uint8_t, 256> table = {};
+    for(int i = 0; i < 256; i++)
+    {
+        uint8_t crc = static_cast<uint8_t>(i);
+        for(int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ DEVICE_DATA_FRAME_CRC8_POLYNOMIAL) : static_cast<uint8_t>(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> DEVICE_DATA_FRAME_CRC8_TABLE = makeDeviceDataFrameCrc8Table();
+
+/*
+ * Resumable decoder for the v2 device data frames sent by the HMI node:
+ *
+ *      COBS(Device address -> Sequence number -> Payload length -> Payload (1 or 4 bytes) -> CRC-8) -> DEVICE_DATA_FRAME_V2_DELIMITER
+ *
+ * COBS removes every 0x00 byte from the encoded frame, so DEVICE_DATA_FRAME_V2_DELIMITER can never show up inside a frame whatever
+ * the payload is, and the decoder is back in sync right after the next delimiter following a corrupted frame.
+ * The CRC-8 (polynomial 0x07, initial value 0x00) covers everything before it, and gaps in the 8-bit sequence number are counted as lost frames.
+*/
+class DeviceDataFrameDecoderV2
+{
+public:
+    using Frame = DeviceDataFrameDecoder::Frame;
+
+    /*
+     * @brief Walk all the bytes of a received chunk and call onFrame() for every valid device data frame in it
+     *
+     * @param data          Received bytes
+     * @param size          Number of received bytes
+     * @param onFrame       Callable with the signature void(const DeviceDataFrameDecoderV2::Frame&).
+     *                      The frame payload is only valid during the call
+     *
+     * @return Number of valid frames decoded from this chunk
+    */
+    template<typename FrameCallback>
+    size_t decode(const char* data, size_t size, FrameCallback&& onFrame);
+
+    /*
+     * @brief Drop any partially received frame and wait for the next DEVICE_DATA_FRAME_V2_DELIMITER
+     *
+     * @return void
+    */
+    void reset();
+
+    /*
+     * @brief Encode a device data frame in the v2 wire format, including the trailing DEVICE_DATA_FRAME_V2_DELIMITER
+     *
+     * @param deviceAddress     Device internal address
+     * @param sequenceNumber    Frame sequence number
+     * @param payload           Device data
+     * @param payloadSize       Device data size, up to DEVICE_DATA_FRAME_V2_MAX_PAYLOAD_SIZE
+     * @param encodedFrame      Output buffer of at least DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE + 1 bytes
+     *
+     * @return Number of bytes written to encodedFrame, 0 if the payload is too large
+    */
+    static size_t encode(uint8_t deviceAddress, uint8_t sequenceNumber, const uint8_t* payload, size_t payloadSize, uint8_t* encodedFrame);
+
+    static uint8_t crc8(const uint8_t* data, size_t size);
+
+    // Number of frames rejected because of a bad COBS encoding, length or CRC
+    size_t corruptedFrameCount() const { return corruptedFrames; }
+    // Number of frames missing according to the gaps in the sequence numbers
+    size_t lostFrameCount() const { return lostFrames; }
+    // Number of frames dropped because no delimiter was found within the max encoded frame size
+    size_t overflowCount() const { return overflows; }
+
+private:
+    /*
+     * @brief Check and decode the frame in encodedFrameBuffer, then call onFrame() if it is valid
+     *
+     * @return true if a valid frame was decoded
+    */
+    template<typename FrameCallback>
+    bool decodeBufferedFrame(FrameCallback&& onFrame);
+
+    uint8_t encodedFrameBuffer[DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE] = { 0 };
+    uint8_t decodedFrameBuffer[DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE] = { 0 };
+    size_t encodedFrameBufferIndex = 0;
+    // Set after an overflow, until the next delimiter is found
+    bool discardingFrame = false;
+    // Sequence number expected for the next frame, only meaningful once the first frame has been received
+    uint8_t expectedSequenceNumber = 0;
+    bool sequenceNumberSynchronized = false;
+
+    size_t corruptedFrames = 0;
+    size_t lostFrames = 0;
+    size_t overflows = 0;
+};
+
+template<typename FrameCallback>
+size_t DeviceDataFrameDecoderV2::decode(const char* data, size_t size, FrameCallback&& onFrame)
+{
+    size_t decodedFrames = 0;
+
+    for(size_t i = 0; i < size; i++)
+    {
+        const uint8_t byte = static_cast<uint8_t>(data[i]);
+
+        if(byte == DEVICE_DATA_FRAME_V2_DELIMITER)
+        {
+            // An overflowed frame ends here, the next byte starts a fresh frame
+            if(!discardingFrame && encodedFrameBufferIndex > 0 && decodeBufferedFrame(onFrame))
+            {
+                decodedFrames++;
+            }
+            discardingFrame = false;
+            encodedFrameBufferIndex = 0;
+        }
+        else if(!discardingFrame)
+        {
+            if(encodedFrameBufferIndex == sizeof(encodedFrameBuffer))
+            {
+                discardingFrame = true;
+                overflows++;
+            }
+            else
+            {
+                encodedFrameBuffer[encodedFrameBufferIndex++] = byte;
+            }
+        }
+    }
+
+    return decodedFrames;
+}
+
+template<typename FrameCallback>
+bool DeviceDataFrameDecoderV2::decodeBufferedFrame(FrameCallback&& onFrame)
+{
+    /* COBS decode: each code byte tells the distance to the next (removed) zero byte */
+    size_t readIndex = 0;
+    size_t decodedSize = 0;
+    while(readIndex < encodedFrameBufferIndex)
+    {
+        const uint8_t code = encodedFrameBuffer[readIndex++];
+        if(readIndex + code - 1 > encodedFrameBufferIndex)
+        {
+            corruptedFrames++;
+            return false;
+        }
+        for(uint8_t j = 1; j < code; j++)
+        {
+            decodedFrameBuffer[decodedSize++] = encodedFrameBuffer[readIndex++];
+        }
+        if(code != 0xFF && readIndex < encodedFrameBufferIndex)
+        {
+            decodedFrameBuffer[decodedSize++] = 0x00;
+        }
+    }
+
+    /* Check the frame: address, sequence number, length, payload and CRC-8 */
+    const uint8_t payloadSize = decodedSize >= 4 ? decodedFrameBuffer[2] : 0;
+    if(decodedSize < 4 || payloadSize > DEVICE_DATA_FRAME_V2_MAX_PAYLOAD_SIZE || decodedSize != size_t(payloadSize) + 4
+       || crc8(decodedFrameBuffer, decodedSize - 1) != decodedFrameBuffer[decodedSize - 1])
+    {
+        corruptedFrames++;
+        return false;
+    }
+
+    const uint8_t sequenceNumber = decodedFrameBuffer[1];
+    if(sequenceNumberSynchronized)
+    {
+        lostFrames += static_cast<uint8_t>(sequenceNumber - expectedSequenceNumber);
+    }
+    expectedSequenceNumber = static_cast<uint8_t>(sequenceNumber + 1);
+    sequenceNumberSynchronized = true;
+
+    const Frame frame = { decodedFrameBuffer[0], decodedFrameBuffer + 3, payloadSize };
+    onFrame(frame);
+
+    return true;
+}
+
+inline void DeviceDataFrameDecoderV2::reset()
+{
+    encodedFrameBufferIndex = 0;
+    discardingFrame = true;
+    sequenceNumberSynchronized = false;
+}
+
+inline uint8_t DeviceDataFrameDecoderV2::crc8(const uint8_t* data, size_t size)
+{
+    uint8_t crc = 0x00;
+    for(size_t i = 0; i < size; i++)
+    {
+        crc = DEVICE_DATA_FRAME_CRC8_TABLE[crc ^ data[i]];
+    }
+    return crc;
+}
+
+inline size_t DeviceDataFrameDecoderV2::encode(uint8_t deviceAddress, uint8_t sequenceNumber, const uint8_t* payload, size_t payloadSize, uint8_t* encodedFrame)
+{
+    if(payloadSize > DEVICE_DATA_FRAME_V2_MAX_PAYLOAD_SIZE)
+    {
+        return 0;
+    }
+
+    uint8_t frame[DEVICE_DATA_FRAME_V2_MAX_SIZE];
+    size_t frameSize = 0;
+    frame[frameSize++] = deviceAddress;
+    frame[frameSize++] = sequenceNumber;
+    frame[frameSize++] = static_cast<uint8_t>(payloadSize);
+    for(size_t i = 0; i < payloadSize; i++)
+    {
+        frame[frameSize++] = payload[i];
+    }
+    frame[frameSize] = crc8(frame, frameSize);
+    frameSize++;
+
+    /* COBS encode, the frame is always shorter than 254 bytes so a single overhead byte is enough */
+    size_t codeIndex = 0;
+    size_t encodedSize = 1;
+    uint8_t code = 1;
+    for(size_t i = 0; i < frameSize; i++)
+    {
+        if(frame[i] == 0x00)
+        {
+            encodedFrame[codeIndex] = code;
+            codeIndex = encodedSize++;
+            code = 1;
+        }
+        else
+        {
+            encodedFrame[encodedSize++] = frame[i];
+            code++;
+        }
+    }
+    encodedFrame[codeIndex] = code;
+    encodedFrame[encodedSize++] = DEVICE_DATA_FRAME_V2_DELIMITER;
+
+    return encodedSize;
+}
+
+#endif // DEVICEDATAFRAMEDECODERV2_H
@@ -0,0 +1,49 @@
+#include "devicedataparser.h"
+#include <cstring>
+
+void DeviceDataParser::setFrameProtocol(FrameProtocol frameProtocol)
+{
+    if(protocol != frameProtocol)
+    {
+        protocol = frameProtocol;
+        frameDecoder.reset();
+        frameDecoderV2.reset();
+    }
+}
+
+size_t DeviceDataParser::corruptedFrameCount() const
+{
+    return frameDecoder.overflowCount() + frameDecoderV2.corruptedFrameCount() + frameDecoderV2.overflowCount() + mismatchedFrames;
+}
+
+bool DeviceDataParser::toDeviceSample(const DeviceDataFrameDecoder::Frame& frame, qint64 timestamp, DeviceSample& sample)
+{
+    const DeviceDispatchEntry& device = DEVICE_DISPATCH_TABLE[frame.deviceAddress];
+
+    if(device.payloadType == DeviceSample::PAYLOAD_TYPE_NONE)
+    {
+        // Error Handing: Unknown device address
+        sample = DeviceSample::fromUnknown(frame.deviceAddress, timestamp);
+        return true;
+    }
+
+    if(frame.payloadSize != device.payloadSize)
+    {
+        // Payload size doesn't match the device, the frame was misparsed
+        mismatchedFrames++;
+        return false;
+    }
+
+    if(device.payloadType == DeviceSample::PAYLOAD_TYPE_BYTE)
+    {
+        sample = DeviceSample::fromByte(frame.deviceAddress, timestamp, frame.payload[0]);
+    }
+    else
+    {
+        // Convert the received four data bytes back to float
+        float value;
+        memcpy(&value, frame.payload, sizeof(value));
+        sample = DeviceSample::fromFloat(frame.deviceAddress, timestamp, value * device.scale);
+    }
+    return true;
+}
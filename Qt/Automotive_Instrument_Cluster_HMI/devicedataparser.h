@@ -0,0 +1,142 @@
+#ifndef DEVICEDATAPARSER_H
+#define DEVICEDATAPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "devicedataframedecoder.h"
+#include "devicedataframedecoderv2.h"
+#include "deviceprotocol.h"
+#include "devicesample.h"
+#include "ingestioncounters.h"
+
+/*
+ * Turns received bytes into DeviceSamples, for either wire format.
+ *
+ * It has no QObject dependency, so the same parsing runs inside Serial on the GUI thread
+ * and inside SerialWorker on a dedicated serial I/O thread.
+*/
+class DeviceDataParser
+{
+public:
+    // Generated from DEVICE_PROTOCOL_DEVICES, see deviceprotocol.h
+    enum DeviceInternalAddress
+    {
+        DEVICE_PROTOCOL_DEVICES(DEVICE_PROTOCOL_INTERNAL_ADDRESS)
+    };
+
+    enum FrameProtocol
+    {
+        // '|' -> Device address -> Device data -> '\r'. Can't tell payload bytes from delimiters, kept for older HMI firmware
+        FRAME_PROTOCOL_V1       =     1,
+        // COBS framed with sequence number, length and CRC-8, see DeviceDataFrameDecoderV2
+        FRAME_PROTOCOL_V2       =     2
+    };
+
+    /*
+     * @brief Parse a chunk of received bytes, calling onSample() for each complete device data frame
+     *
+     * Frames may be split across chunks, the parser state is kept between calls
+     *
+     * @param data          Received bytes
+     * @param size          Number of received bytes
+     * @param timestamp     Monotonic arrival time of the chunk in nanoseconds, see DeviceSample::currentTimestamp()
+     * @param onSample      Callable with the signature void(const DeviceSample&)
+     *
+     * @return Number of device samples parsed from the chunk
+    */
+    template<typename SampleCallback>
+    size_t parse(const char* data, size_t size, qint64 timestamp, SampleCallback&& onSample);
+
+    FrameProtocol frameProtocol() const { return protocol; }
+    /*
+     * @brief Switch the wire format of the received device data frames, any partially received frame is dropped
+     *
+     * @return void
+    */
+    void setFrameProtocol(FrameProtocol frameProtocol);
+
+    bool decodeTimestamps() const { return decodeTimestamping; }
+    /*
+     * @brief Stamp every sample with the time it was decoded at (see DeviceSample::decodedTimestamp()), for latency probes
+     *
+     * Costs a clock read per frame, off by default
+     *
+     * @return void
+    */
+    void setDecodeTimestamps(bool enabled) { decodeTimestamping = enabled; }
+
+    int sourceId() const { return source; }
+    /*
+     * @brief Tag every sample with the id of the port it comes from, see DeviceSample::sourceId()
+     *
+     * @return void
+    */
+    void setSourceId(uint8_t sourceId) { source = sourceId; }
+
+    // Frames rejected because of a bad encoding, length or checksum, or with a payload size that doesn't match their device
+    size_t corruptedFrameCount() const;
+    // Frames missing from the sequence numbers, only counted by FRAME_PROTOCOL_V2
+    size_t lostFrameCount() const { return frameDecoderV2.lostFrameCount(); }
+    // Frames too long for the decoder buffer, also counted as corrupted
+    size_t overflowFrameCount() const { return frameDecoder.overflowCount() + frameDecoderV2.overflowCount(); }
+
+    // Bytes, frames per device and errors, readable from any thread while parsing
+    const IngestionCounters& counters() const { return ingestionCounters; }
+    IngestionCounters& counters() { return ingestionCounters; }
+
+private:
+    /*
+     * @brief Convert a received device data frame to a DeviceSample
+     *
+     * Unknown device addresses give a sample without payload. The device is looked up in DEVICE_DISPATCH_TABLE
+     *
+     * @return false if the payload size doesn't match the device, the frame must be dropped
+    */
+    bool toDeviceSample(const DeviceDataFrameDecoder::Frame& frame, qint64 timestamp, DeviceSample& sample);
+
+    DeviceDataFrameDecoder frameDecoder;
+    DeviceDataFrameDecoderV2 frameDecoderV2;
+    FrameProtocol protocol = FRAME_PROTOCOL_V2;
+    bool decodeTimestamping = false;
+    uint8_t source = 0;
+    // Frames decoded fine but with a payload size that doesn't match the device
+    size_t mismatchedFrames = 0;
+    IngestionCounters ingestionCounters;
+};
+
+template<typename SampleCallback>
+size_t DeviceDataParser::parse(const char* data, size_t size, qint64 timestamp, SampleCallback&& onSample)
+{
+    size_t samples = 0;
+    ingestionCounters.addBytes(size);
+
+    const auto onFrame = [this, timestamp, &samples, &onSample](const DeviceDataFrameDecoder::Frame& frame)
+    {
+        DeviceSample sample;
+        if(toDeviceSample(frame, timestamp, sample))
+        {
+            if(decodeTimestamping)
+            {
+                sample.setDecodedTimestamp(DeviceSample::currentTimestamp());
+            }
+            sample.setSourceId(source);
+            ingestionCounters.addFrame(frame.deviceAddress, sample.payloadType() != DeviceSample::PAYLOAD_TYPE_NONE, timestamp);
+            samples++;
+            onSample(sample);
+        }
+    };
+
+    if(protocol == FRAME_PROTOCOL_V2)
+    {
+        frameDecoderV2.decode(data, size, onFrame);
+    }
+    else
+    {
+        frameDecoder.decode(data, size, onFrame);
+    }
+
+    ingestionCounters.setDecoderErrors(corruptedFrameCount(), lostFrameCount(), overflowFrameCount());
+    return samples;
+}
+
+#endif // DEVICEDATAPARSER_H
@@ -0,0 +1,93 @@
+#ifndef DEVICEPROTOCOL_H
+#define DEVICEPROTOCOL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ATMega32A/Protocol/DeviceProtocol.h>
+#include "devicesample.h"
+
+/*
+ * Host side of the device table shared with the firmware (DEVICE_PROTOCOL_DEVICES in ATMega32A/Protocol/DeviceProtocol.h).
+ *
+ * DEVICE_DESCRIPTORS lists the devices as compile time constants, and DEVICE_DISPATCH_TABLE spreads them over all the
+ * 256 device addresses, so the decoder looks a frame's device up with a single index instead of a switch.
+ * Adding a sensor to the firmware header is enough for the parser to decode it.
+*/
+struct DeviceDescriptor
+{
+    const char* name;
+    uint8_t address;
+    uint8_t payloadSize;
+    DeviceSample::PayloadType payloadType;
+    float scale;
+};
+
+// What the decoder needs about a device address, kept small so the whole table fits in a few cache lines of L1
+struct DeviceDispatchEntry
+{
+    // Unknown devices are DeviceSample::PAYLOAD_TYPE_NONE
+    uint8_t payloadType = DEVICE_PAYLOAD_TYPE_NONE;
+    uint8_t payloadSize = 0;
+    float scale = 1.0f;
+};
+
+#define DEVICE_PROTOCOL_DESCRIPTOR(name, internalAddress, payloadSize, payloadType, scale) \
+    DeviceDescriptor{#name, internalAddress, payloadSize, static_cast<DeviceSample::PayloadType>(payloadType), scale},
+
+inline constexpr DeviceDescriptor DEVICE_DESCRIPTORS[] = { DEVICE_PROTOCOL_DEVICES(DEVICE_PROTOCOL_DESCRIPTOR) };
+
+#undef DEVICE_PROTOCOL_DESCRIPTOR
+
+constexpr std::array<DeviceDispatchEntry, 256> makeDeviceDispatchTable()
+{
+    std::array<DeviceDispatchEntry, 256> table = {};
+    for(const DeviceDescriptor& device : DEVICE_DESCRIPTORS)
+    {
+        table[device.address].payloadType = static_cast<uint8_t>(device.payloadType);
+        table[device.address].payloadSize = device.payloadSize;
+        table[device.address].scale = device.scale;
+    }
+    return table;
+}
+
+inline constexpr std::array<DeviceDispatchEntry, 256> DEVICE_DISPATCH_TABLE = makeDeviceDispatchTable();
+
+// Every device has a payload matching its type, that fits in a frame, and doesn't end a v1 frame as soon as its address is read
+constexpr bool deviceDescriptorsValid()
+{
+    for(const DeviceDescriptor& device : DEVICE_DESCRIPTORS)
+    {
+        const size_t typeSize = device.payloadType == DeviceSample::PAYLOAD_TYPE_BYTE ? sizeof(uint8_t)
+                              : device.payloadType == DeviceSample::PAYLOAD_TYPE_FLOAT ? sizeof(float) : 0;
+        if(typeSize == 0 || device.payloadSize != typeSize || device.payloadSize > DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE
+           || device.address == DEVICE_DATA_FRAME_V1_END_DELIMITER)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool deviceAddressesUnique()
+{
+    for(size_t i = 0; i < std::size(DEVICE_DESCRIPTORS); i++)
+    {
+        for(size_t j = i + 1; j < std::size(DEVICE_DESCRIPTORS); j++)
+        {
+            if(DEVICE_DESCRIPTORS[i].address == DEVICE_DESCRIPTORS[j].address)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(deviceDescriptorsValid(), "DEVICE_PROTOCOL_DEVICES: a payload size doesn't match its payload type or exceeds DEVICE_DATA_FRAME_MAX_PAYLOAD_SIZE");
+static_assert(deviceAddressesUnique(), "DEVICE_PROTOCOL_DEVICES: two devices share an internal address");
+static_assert(int(DEVICE_PAYLOAD_TYPE_NONE) == int(DeviceSample::PAYLOAD_TYPE_NONE) && int(DEVICE_PAYLOAD_TYPE_BYTE) == int(DeviceSample::PAYLOAD_TYPE_BYTE)
+              && int(DEVICE_PAYLOAD_TYPE_FLOAT) == int(DeviceSample::PAYLOAD_TYPE_FLOAT), "EN_DEVICE_PAYLOAD_TYPE_t and DeviceSample::PayloadType differ");
+static_assert(sizeof(DeviceDispatchEntry) == 8, "DeviceDispatchEntry grew, DEVICE_DISPATCH_TABLE no longer fits in 2 KiB");
+
+#endif // DEVICEPROTOCOL_H
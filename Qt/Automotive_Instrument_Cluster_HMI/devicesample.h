@@ -0,0 +1,116 @@
+#ifndef DEVICESAMPLE_H
+#define DEVICESAMPLE_H
+
+#include <QObject>
+#include <QMetaType>
+#include <chrono>
+#include <cstdint>
+
+/*
+ * A single decoded device data frame, passed around by value.
+ *
+ * Unlike QList<QVariant> it needs no heap allocation, so it can be emitted for every received frame
+ * and queued across threads without churning the allocator.
+*/
+class DeviceSample
+{
+    Q_GADGET
+    Q_PROPERTY(int deviceAddress READ deviceAddress CONSTANT)
+    Q_PROPERTY(int sourceId READ sourceId CONSTANT)
+    Q_PROPERTY(qint64 timestamp READ timestamp CONSTANT)
+    Q_PROPERTY(qint64 decodedTimestamp READ decodedTimestamp CONSTANT)
+    Q_PROPERTY(int byteData READ byteData CONSTANT)
+    Q_PROPERTY(float floatData READ floatData CONSTANT)
+    Q_PROPERTY(double value READ value CONSTANT)
+
+public:
+    enum PayloadType
+    {
+        PAYLOAD_TYPE_NONE,
+        PAYLOAD_TYPE_BYTE,
+        PAYLOAD_TYPE_FLOAT
+    };
+    Q_ENUM(PayloadType)
+
+    DeviceSample() = default;
+
+    // A frame from a device address with no known payload format
+    static DeviceSample fromUnknown(uint8_t deviceAddress, qint64 timestamp)
+    {
+        return DeviceSample(deviceAddress, timestamp, PAYLOAD_TYPE_NONE);
+    }
+
+    static DeviceSample fromByte(uint8_t deviceAddress, qint64 timestamp, uint8_t data)
+    {
+        DeviceSample sample(deviceAddress, timestamp, PAYLOAD_TYPE_BYTE);
+        sample.payload.byteData = data;
+        return sample;
+    }
+
+    static DeviceSample fromFloat(uint8_t deviceAddress, qint64 timestamp, float data)
+    {
+        DeviceSample sample(deviceAddress, timestamp, PAYLOAD_TYPE_FLOAT);
+        sample.payload.floatData = data;
+        return sample;
+    }
+
+    /*
+     * @brief Monotonic time in nanoseconds, the clock used for DeviceSample::timestamp()
+     *
+     * @return Current monotonic time in nanoseconds
+    */
+    static qint64 currentTimestamp()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int deviceAddress() const { return address; }
+    // Port the frame was received on when several are merged, see SourceManager. 0 otherwise
+    int sourceId() const { return source; }
+    void setSourceId(uint8_t sourceId) { source = sourceId; }
+    // Monotonic arrival time of the bytes that completed this frame, in nanoseconds
+    qint64 timestamp() const { return arrivalTimestamp; }
+    // Monotonic time the frame was decoded at, in nanoseconds. Same as timestamp() unless the parser latency probes are enabled
+    qint64 decodedTimestamp() const { return arrivalTimestamp + decodeDelay; }
+    // Saturates at ~4.3 s after the arrival time
+    void setDecodedTimestamp(qint64 timestamp)
+    {
+        const qint64 delay = timestamp - arrivalTimestamp;
+        decodeDelay = delay <= 0 ? 0 : (delay >= qint64(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(delay));
+    }
+    PayloadType payloadType() const { return type; }
+    int byteData() const { return type == PAYLOAD_TYPE_BYTE ? payload.byteData : 0; }
+    float floatData() const { return type == PAYLOAD_TYPE_FLOAT ? payload.floatData : 0.0f; }
+    // Replace the value of a float sample, e.g. with a filtered one. Other samples are left unchanged
+    void setFloatData(float data)
+    {
+        if(type == PAYLOAD_TYPE_FLOAT)
+        {
+            payload.floatData = data;
+        }
+    }
+    // The payload as a number, whatever its type is
+    double value() const { return type == PAYLOAD_TYPE_FLOAT ? payload.floatData : byteData(); }
+
+private:
+    DeviceSample(uint8_t deviceAddress, qint64 timestamp, PayloadType payloadType)
+        : arrivalTimestamp(timestamp), address(deviceAddress), type(payloadType) {}
+
+    union Payload
+    {
+        uint8_t byteData;
+        float floatData;	// 4 Bytes
+    };
+
+    qint64 arrivalTimestamp = 0;
+    Payload payload = { 0 };
+    // Kept relative to the arrival time so it fits in the padding, the sample stays 24 bytes with the source id
+    uint32_t decodeDelay = 0;
+    uint8_t address = 0;
+    uint8_t source = 0;
+    PayloadType type = PAYLOAD_TYPE_NONE;
+};
+
+Q_DECLARE_METATYPE(DeviceSample)
+
+#endif // DEVICESAMPLE_H
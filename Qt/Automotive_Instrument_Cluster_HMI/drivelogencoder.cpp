@@ -0,0 +1,164 @@
+#include "drivelogencoder.h"
+#include <algorithm>
+#include <cmath>
+
+// Largest quantized value, beyond it the value is clamped. Keeps round(value / quantum) and its deltas within int64
+#define MAX_QUANTIZED_VALUE 9007199254740992.0
+
+DriveLogEncoder::DriveLogEncoder()
+{
+    quanta.fill(DRIVE_LOG_DEFAULT_FLOAT_QUANTUM);
+}
+
+void DriveLogEncoder::setQuantum(uint8_t deviceAddress, double quantum)
+{
+    quanta[deviceAddress] = quantum > 0.0 ? quantum : 0.0;
+}
+
+bool DriveLogEncoder::fits(const DeviceSample& sample) const
+{
+    return samples == 0 || (samples < DRIVE_LOG_BLOCK_MAX_SAMPLES && sample.timestamp() - blockFirstTimestamp < DRIVE_LOG_BLOCK_MAX_SPAN_NS);
+}
+
+DriveLogEncoder::Column& DriveLogEncoder::column(const DeviceSample& sample)
+{
+    const uint8_t deviceAddress = static_cast<uint8_t>(sample.deviceAddress());
+    const uint8_t sourceId = static_cast<uint8_t>(sample.sourceId());
+
+    // Consecutive samples often come from the same device
+    if(lastColumn < usedColumns && columns[lastColumn].deviceAddress == deviceAddress && columns[lastColumn].sourceId == sourceId)
+    {
+        return columns[lastColumn];
+    }
+    for(size_t i = 0; i < usedColumns; i++)
+    {
+        if(columns[i].deviceAddress == deviceAddress && columns[i].sourceId == sourceId)
+        {
+            lastColumn = i;
+            return columns[i];
+        }
+    }
+
+    if(usedColumns == columns.size())
+    {
+        columns.emplace_back();
+    }
+    lastColumn = usedColumns++;
+
+    Column& newColumn = columns[lastColumn];
+    newColumn.deviceAddress = deviceAddress;
+    newColumn.sourceId = sourceId;
+    newColumn.payloadType = static_cast<uint8_t>(sample.payloadType());
+    newColumn.sampleCount = 0;
+    newColumn.previousTimestamp = blockFirstTimestamp;
+    newColumn.previousValue = 0;
+    newColumn.timestamps.clear();
+    newColumn.values.clear();
+
+    switch(sample.payloadType())
+    {
+    case DeviceSample::PAYLOAD_TYPE_BYTE:
+        newColumn.encoding = DRIVE_LOG_ENCODING_QUANTIZED;
+        newColumn.quantum = 1.0;
+        break;
+
+    case DeviceSample::PAYLOAD_TYPE_FLOAT:
+        newColumn.quantum = quanta[deviceAddress];
+        newColumn.encoding = newColumn.quantum > 0.0 ? DRIVE_LOG_ENCODING_QUANTIZED : DRIVE_LOG_ENCODING_FLOAT;
+        break;
+
+    default:
+        newColumn.encoding = DRIVE_LOG_ENCODING_NONE;
+        newColumn.quantum = 0.0;
+        break;
+    }
+
+    return newColumn;
+}
+
+void DriveLogEncoder::add(const DeviceSample& sample)
+{
+    if(samples == 0)
+    {
+        blockFirstTimestamp = sample.timestamp();
+        blockLastTimestamp = sample.timestamp();
+    }
+    // Samples merged from several ports may be slightly out of order, the last timestamp is the latest one
+    blockLastTimestamp = std::max(blockLastTimestamp, sample.timestamp());
+
+    Column& target = column(sample);
+    // The first timestamp of a column is relative to the first timestamp of the block
+    appendVarint(target.timestamps, DriveLog::zigzagEncode(sample.timestamp() - target.previousTimestamp));
+    target.previousTimestamp = sample.timestamp();
+
+    if(target.encoding == DRIVE_LOG_ENCODING_QUANTIZED)
+    {
+        const double scaled = sample.value() / target.quantum;
+        // NaN ends up as 0, the quantized encoding has no way to tell it
+        const int64_t value = std::isnan(scaled) ? 0 : static_cast<int64_t>(std::llround(std::clamp(scaled, -MAX_QUANTIZED_VALUE, MAX_QUANTIZED_VALUE)));
+        appendVarint(target.values, DriveLog::zigzagEncode(value - target.previousValue));
+        target.previousValue = value;
+    }
+    else if(target.encoding == DRIVE_LOG_ENCODING_FLOAT)
+    {
+        const size_t size = target.values.size();
+        target.values.resize(size + sizeof(float));
+        DriveLog::writeLittleEndian<float>(target.values.data() + size, sample.floatData());
+    }
+
+    target.sampleCount++;
+    samples++;
+}
+
+void DriveLogEncoder::finishBlock(std::vector<uint8_t>& out)
+{
+    if(samples == 0)
+    {
+        return;
+    }
+
+    size_t dataSize = 0;
+    for(size_t i = 0; i < usedColumns; i++)
+    {
+        dataSize += DRIVE_LOG_COLUMN_HEADER_SIZE + columns[i].timestamps.size() + columns[i].values.size();
+    }
+
+    const size_t blockOffset = out.size();
+    out.resize(blockOffset + DRIVE_LOG_BLOCK_HEADER_SIZE + dataSize);
+    uint8_t* header = out.data() + blockOffset;
+
+    DriveLog::writeLittleEndian<uint32_t>(header, DRIVE_LOG_BLOCK_MAGIC);
+    DriveLog::writeLittleEndian<uint32_t>(header + 4, static_cast<uint32_t>(dataSize));
+    DriveLog::writeLittleEndian<uint32_t>(header + 8, static_cast<uint32_t>(samples));
+    DriveLog::writeLittleEndian<uint16_t>(header + 12, static_cast<uint16_t>(usedColumns));
+    DriveLog::writeLittleEndian<uint16_t>(header + 14, 0);
+    DriveLog::writeLittleEndian<int64_t>(header + 16, blockFirstTimestamp);
+    DriveLog::writeLittleEndian<int64_t>(header + 24, blockLastTimestamp);
+
+    uint8_t* columnHeader = header + DRIVE_LOG_BLOCK_HEADER_SIZE;
+    uint8_t* data = columnHeader + usedColumns * DRIVE_LOG_COLUMN_HEADER_SIZE;
+    for(size_t i = 0; i < usedColumns; i++, columnHeader += DRIVE_LOG_COLUMN_HEADER_SIZE)
+    {
+        const Column& source = columns[i];
+        columnHeader[0] = source.deviceAddress;
+        columnHeader[1] = source.sourceId;
+        columnHeader[2] = source.payloadType;
+        columnHeader[3] = source.encoding;
+        DriveLog::writeLittleEndian<double>(columnHeader + 4, source.quantum);
+        DriveLog::writeLittleEndian<uint32_t>(columnHeader + 12, source.sampleCount);
+        DriveLog::writeLittleEndian<uint32_t>(columnHeader + 16, static_cast<uint32_t>(source.timestamps.size()));
+        DriveLog::writeLittleEndian<uint32_t>(columnHeader + 20, static_cast<uint32_t>(source.values.size()));
+
+        memcpy(data, source.timestamps.data(), source.timestamps.size());
+        data += source.timestamps.size();
+        if(!source.values.empty())
+        {
+            memcpy(data, source.values.data(), source.values.size());
+            data += source.values.size();
+        }
+    }
+
+    usedColumns = 0;
+    lastColumn = 0;
+    samples = 0;
+}
@@ -0,0 +1,94 @@
+#ifndef DRIVELOGENCODER_H
+#define DRIVELOGENCODER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "devicesample.h"
+#include "drivelogformat.h"
+
+/*
+ * Builds the blocks of a drive log, see drivelogformat.h.
+ *
+ * Samples are split into one column per device and source as they are added, each column encoding its timestamps and
+ * values right away into its own buffers. The buffers keep their capacity between blocks, so once the first blocks have
+ * been built adding a sample doesn't allocate.
+*/
+class DriveLogEncoder
+{
+public:
+    DriveLogEncoder();
+
+    /*
+     * @brief Set the quantum float values of a device are rounded to, e.g. 0.01 for the temperature in Celsius. Applied from the next block
+     *
+     * @param quantum   Step of the logged values in the device unit, 0 to log them as float32 without loss
+     *
+     * @return void
+    */
+    void setQuantum(uint8_t deviceAddress, double quantum);
+    double quantum(uint8_t deviceAddress) const { return quanta[deviceAddress]; }
+
+    /*
+     * @brief Tell whether a sample still fits in the current block, see DRIVE_LOG_BLOCK_MAX_SAMPLES and DRIVE_LOG_BLOCK_MAX_SPAN_NS
+     *
+     * @return false if the block must be finished before adding the sample
+    */
+    bool fits(const DeviceSample& sample) const;
+
+    /*
+     * @brief Add a sample to the current block
+     *
+     * @return void
+    */
+    void add(const DeviceSample& sample);
+
+    size_t sampleCount() const { return samples; }
+    int64_t firstTimestamp() const { return blockFirstTimestamp; }
+    int64_t lastTimestamp() const { return blockLastTimestamp; }
+
+    /*
+     * @brief Append the current block to out and start a new, empty one
+     *
+     * @return void
+    */
+    void finishBlock(std::vector<uint8_t>& out);
+
+private:
+    struct Column
+    {
+        uint8_t deviceAddress = 0;
+        uint8_t sourceId = 0;
+        uint8_t payloadType = 0;
+        uint8_t encoding = DRIVE_LOG_ENCODING_NONE;
+        double quantum = 0.0;
+        uint32_t sampleCount = 0;
+        int64_t previousTimestamp = 0;
+        int64_t previousValue = 0;
+        std::vector<uint8_t> timestamps;
+        std::vector<uint8_t> values;
+    };
+
+    Column& column(const DeviceSample& sample);
+
+    static void appendVarint(std::vector<uint8_t>& buffer, uint64_t value)
+    {
+        const size_t size = buffer.size();
+        buffer.resize(size + DRIVE_LOG_MAX_VARINT_SIZE);
+        uint8_t* end = DriveLog::writeVarint(buffer.data() + size, value);
+        buffer.resize(static_cast<size_t>(end - buffer.data()));
+    }
+
+    std::array<double, 256> quanta;
+    // Columns of the current block come first, the others are kept for their buffers
+    std::vector<Column> columns;
+    size_t usedColumns = 0;
+    size_t lastColumn = 0;
+    size_t samples = 0;
+    // Timestamp of the first sample added, the column timestamps and the span limit are relative to it
+    int64_t blockFirstTimestamp = 0;
+    int64_t blockLastTimestamp = 0;
+};
+
+#endif // DRIVELOGENCODER_H
@@ -0,0 +1,340 @@
+#include "drivelogfile.h"
+#include <algorithm>
+
+namespace
+{
+    // Decode count zigzag varint deltas, each added to the previous value starting from first
+    template<typename Output>
+    bool decodeDeltas(const uint8_t* in, const uint8_t* end, size_t count, int64_t first, Output&& output)
+    {
+        int64_t value = first;
+        for(size_t i = 0; i < count; i++)
+        {
+            uint64_t delta;
+            in = DriveLog::readVarint(in, end, delta);
+            if(!in)
+            {
+                return false;
+            }
+            value += DriveLog::zigzagDecode(delta);
+            output(i, value);
+        }
+        return in == end;
+    }
+}
+
+bool DriveLogWriter::open(const QString& filePath)
+{
+    close();
+
+    file.setFileName(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("DriveLogWriter: can't open %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        return false;
+    }
+
+    samples = 0;
+    writtenBytes = 0;
+    index.clear();
+
+    buffer.assign(DRIVE_LOG_HEADER_SIZE, 0);
+    memcpy(buffer.data(), DRIVE_LOG_MAGIC, 8);
+    DriveLog::writeLittleEndian<uint32_t>(buffer.data() + 8, DRIVE_LOG_VERSION);
+    writeBuffer();
+
+    return true;
+}
+
+void DriveLogWriter::close()
+{
+    if(!file.isOpen())
+    {
+        return;
+    }
+
+    writeBlock();
+
+    const quint64 indexOffset = writtenBytes;
+    buffer.assign(index.size() * DRIVE_LOG_INDEX_ENTRY_SIZE + DRIVE_LOG_TRAILER_SIZE, 0);
+    uint8_t* out = buffer.data();
+    for(const IndexEntry& entry : index)
+    {
+        DriveLog::writeLittleEndian<uint64_t>(out, entry.offset);
+        DriveLog::writeLittleEndian<int64_t>(out + 8, entry.firstTimestamp);
+        DriveLog::writeLittleEndian<int64_t>(out + 16, entry.lastTimestamp);
+        DriveLog::writeLittleEndian<uint32_t>(out + 24, entry.sampleCount);
+        out += DRIVE_LOG_INDEX_ENTRY_SIZE;
+    }
+    DriveLog::writeLittleEndian<uint64_t>(out, indexOffset);
+    DriveLog::writeLittleEndian<uint32_t>(out + 8, static_cast<uint32_t>(index.size()));
+    DriveLog::writeLittleEndian<uint32_t>(out + 12, DRIVE_LOG_INDEX_MAGIC);
+    writeBuffer();
+
+    file.close();
+}
+
+void DriveLogWriter::write(const DeviceSample& sample)
+{
+    if(!file.isOpen())
+    {
+        return;
+    }
+
+    if(!encoder.fits(sample))
+    {
+        writeBlock();
+    }
+    encoder.add(sample);
+    samples++;
+}
+
+void DriveLogWriter::writeBlock()
+{
+    if(encoder.sampleCount() == 0)
+    {
+        return;
+    }
+
+    index.push_back({ writtenBytes, encoder.firstTimestamp(), encoder.lastTimestamp(), static_cast<quint32>(encoder.sampleCount()) });
+    buffer.clear();
+    encoder.finishBlock(buffer);
+    writeBuffer();
+    // A block is a few seconds of samples, flushing it bounds what a crash loses
+    file.flush();
+}
+
+void DriveLogWriter::writeBuffer()
+{
+    const qint64 size = static_cast<qint64>(buffer.size());
+    if(file.write(reinterpret_cast<const char*>(buffer.data()), size) != size)
+    {
+        qWarning("DriveLogWriter: can't write %s: %s", qPrintable(file.fileName()), qPrintable(file.errorString()));
+    }
+    writtenBytes += static_cast<quint64>(size);
+}
+
+bool DriveLogReader::open(const QString& filePath)
+{
+    close();
+
+    file.setFileName(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qWarning("DriveLogReader: can't open %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    if(fileSize < DRIVE_LOG_HEADER_SIZE)
+    {
+        qWarning("DriveLogReader: %s is not a drive log", qPrintable(filePath));
+        file.close();
+        return false;
+    }
+
+    mappedData = file.map(0, fileSize);
+    if(!mappedData)
+    {
+        qWarning("DriveLogReader: can't map %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        file.close();
+        return false;
+    }
+    mappedSize = static_cast<size_t>(fileSize);
+
+    if(memcmp(mappedData, DRIVE_LOG_MAGIC, 8) != 0 || DriveLog::readLittleEndian<uint32_t>(mappedData + 8) != DRIVE_LOG_VERSION)
+    {
+        qWarning("DriveLogReader: %s is not a version %d drive log", qPrintable(filePath), DRIVE_LOG_VERSION);
+        close();
+        return false;
+    }
+
+    indexRecovered = !loadIndex();
+    if(indexRecovered)
+    {
+        qWarning("DriveLogReader: %s has no index, the writer was not closed. Rebuilding it", qPrintable(filePath));
+        recoverIndex();
+    }
+    indexLatestTimestamps();
+
+    return true;
+}
+
+void DriveLogReader::close()
+{
+    if(mappedData)
+    {
+        file.unmap(const_cast<uchar*>(mappedData));
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+    if(file.isOpen())
+    {
+        file.close();
+    }
+    index.clear();
+    indexRecovered = false;
+}
+
+bool DriveLogReader::loadIndex()
+{
+    index.clear();
+    if(mappedSize < DRIVE_LOG_HEADER_SIZE + DRIVE_LOG_TRAILER_SIZE)
+    {
+        return false;
+    }
+
+    const uchar* trailer = mappedData + mappedSize - DRIVE_LOG_TRAILER_SIZE;
+    const uint64_t indexOffset = DriveLog::readLittleEndian<uint64_t>(trailer);
+    const uint32_t blockCount = DriveLog::readLittleEndian<uint32_t>(trailer + 8);
+    if(DriveLog::readLittleEndian<uint32_t>(trailer + 12) != DRIVE_LOG_INDEX_MAGIC || indexOffset < DRIVE_LOG_HEADER_SIZE
+       || indexOffset + static_cast<uint64_t>(blockCount) * DRIVE_LOG_INDEX_ENTRY_SIZE != mappedSize - DRIVE_LOG_TRAILER_SIZE)
+    {
+        return false;
+    }
+
+    index.resize(blockCount);
+    const uchar* entry = mappedData + indexOffset;
+    for(Block& block : index)
+    {
+        block.offset = DriveLog::readLittleEndian<uint64_t>(entry);
+        block.firstTimestamp = DriveLog::readLittleEndian<int64_t>(entry + 8);
+        block.lastTimestamp = DriveLog::readLittleEndian<int64_t>(entry + 16);
+        block.sampleCount = DriveLog::readLittleEndian<uint32_t>(entry + 24);
+        if(block.offset < DRIVE_LOG_HEADER_SIZE || block.offset + DRIVE_LOG_BLOCK_HEADER_SIZE > indexOffset)
+        {
+            index.clear();
+            return false;
+        }
+        entry += DRIVE_LOG_INDEX_ENTRY_SIZE;
+    }
+    return true;
+}
+
+void DriveLogReader::recoverIndex()
+{
+    index.clear();
+
+    size_t offset = DRIVE_LOG_HEADER_SIZE;
+    while(mappedSize - offset >= DRIVE_LOG_BLOCK_HEADER_SIZE)
+    {
+        const uchar* header = mappedData + offset;
+        const size_t restSize = DriveLog::readLittleEndian<uint32_t>(header + 4);
+        // The last block may be cut short
+        if(DriveLog::readLittleEndian<uint32_t>(header) != DRIVE_LOG_BLOCK_MAGIC || mappedSize - offset - DRIVE_LOG_BLOCK_HEADER_SIZE < restSize)
+        {
+            break;
+        }
+
+        Block block;
+        block.offset = offset;
+        block.sampleCount = DriveLog::readLittleEndian<uint32_t>(header + 8);
+        block.firstTimestamp = DriveLog::readLittleEndian<int64_t>(header + 16);
+        block.lastTimestamp = DriveLog::readLittleEndian<int64_t>(header + 24);
+        index.push_back(block);
+
+        offset += DRIVE_LOG_BLOCK_HEADER_SIZE + restSize;
+    }
+}
+
+void DriveLogReader::indexLatestTimestamps()
+{
+    qint64 latestTimestamp = INT64_MIN;
+    for(Block& block : index)
+    {
+        latestTimestamp = qMax(latestTimestamp, block.lastTimestamp);
+        block.latestTimestamp = latestTimestamp;
+    }
+}
+
+size_t DriveLogReader::findBlock(qint64 timestamp) const
+{
+    // Not on lastTimestamp, a block ending with late merged samples may end before the one preceding it
+    return static_cast<size_t>(std::partition_point(index.begin(), index.end(), [timestamp](const Block& block) { return block.latestTimestamp < timestamp; })
+                               - index.begin());
+}
+
+bool DriveLogReader::readBlock(size_t blockIndex, std::vector<DriveLogColumn>& columns) const
+{
+    if(blockIndex >= index.size())
+    {
+        return false;
+    }
+
+    const size_t offset = index[blockIndex].offset;
+    if(mappedSize - offset < DRIVE_LOG_BLOCK_HEADER_SIZE)
+    {
+        return false;
+    }
+    const uchar* header = mappedData + offset;
+    const size_t restSize = DriveLog::readLittleEndian<uint32_t>(header + 4);
+    const size_t columnCount = DriveLog::readLittleEndian<uint16_t>(header + 12);
+    const int64_t firstTimestamp = DriveLog::readLittleEndian<int64_t>(header + 16);
+    if(DriveLog::readLittleEndian<uint32_t>(header) != DRIVE_LOG_BLOCK_MAGIC || mappedSize - offset - DRIVE_LOG_BLOCK_HEADER_SIZE < restSize
+       || columnCount * DRIVE_LOG_COLUMN_HEADER_SIZE > restSize)
+    {
+        return false;
+    }
+
+    const uchar* columnHeader = header + DRIVE_LOG_BLOCK_HEADER_SIZE;
+    const uchar* data = columnHeader + columnCount * DRIVE_LOG_COLUMN_HEADER_SIZE;
+    const uchar* blockEnd = header + DRIVE_LOG_BLOCK_HEADER_SIZE + restSize;
+
+    columns.resize(columnCount);
+    for(DriveLogColumn& column : columns)
+    {
+        column.deviceAddress = columnHeader[0];
+        column.sourceId = columnHeader[1];
+        column.payloadType = static_cast<DeviceSample::PayloadType>(columnHeader[2]);
+        const uint8_t encoding = columnHeader[3];
+        const double quantum = DriveLog::readLittleEndian<double>(columnHeader + 4);
+        const size_t sampleCount = DriveLog::readLittleEndian<uint32_t>(columnHeader + 12);
+        const size_t timestampBytes = DriveLog::readLittleEndian<uint32_t>(columnHeader + 16);
+        const size_t valueBytes = DriveLog::readLittleEndian<uint32_t>(columnHeader + 20);
+        columnHeader += DRIVE_LOG_COLUMN_HEADER_SIZE;
+
+        // Every sample takes at least one byte of timestamp
+        if(static_cast<size_t>(blockEnd - data) < timestampBytes || static_cast<size_t>(blockEnd - data) - timestampBytes < valueBytes
+           || sampleCount > timestampBytes)
+        {
+            return false;
+        }
+
+        column.timestamps.resize(sampleCount);
+        int64_t* timestamps = column.timestamps.data();
+        if(!decodeDeltas(data, data + timestampBytes, sampleCount, firstTimestamp, [timestamps](size_t i, int64_t timestamp) { timestamps[i] = timestamp; }))
+        {
+            return false;
+        }
+        data += timestampBytes;
+
+        if(encoding == DRIVE_LOG_ENCODING_QUANTIZED)
+        {
+            column.values.resize(sampleCount);
+            double* values = column.values.data();
+            if(!decodeDeltas(data, data + valueBytes, sampleCount, 0, [values, quantum](size_t i, int64_t value) { values[i] = value * quantum; }))
+            {
+                return false;
+            }
+        }
+        else if(encoding == DRIVE_LOG_ENCODING_FLOAT)
+        {
+            if(valueBytes != sampleCount * sizeof(float))
+            {
+                return false;
+            }
+            column.values.resize(sampleCount);
+            for(size_t i = 0; i < sampleCount; i++)
+            {
+                column.values[i] = DriveLog::readLittleEndian<float>(data + i * sizeof(float));
+            }
+        }
+        else
+        {
+            column.values.clear();
+        }
+        data += valueBytes;
+    }
+
+    return true;
+}
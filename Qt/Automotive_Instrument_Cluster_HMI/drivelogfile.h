@@ -0,0 +1,183 @@
+#ifndef DRIVELOGFILE_H
+#define DRIVELOGFILE_H
+
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "devicesample.h"
+#include "drivelogencoder.h"
+#include "drivelogformat.h"
+
+/*
+ * Writes decoded samples to a drive log, see drivelogformat.h.
+ *
+ * Samples are encoded into the current block as they are written, each finished block is written in one go and flushed,
+ * so a killed writer loses at most the block being built. The index is written by close().
+ * Not thread safe, see DriveLogger to write from the GUI thread.
+*/
+class DriveLogWriter
+{
+public:
+    ~DriveLogWriter() { close(); }
+
+    /*
+     * @brief Create (or truncate) the log and write its header
+     *
+     * @return false if the file can't be written
+    */
+    bool open(const QString& filePath);
+
+    /*
+     * @brief Write the current block, the index and the trailer, then close the file
+     *
+     * @return void
+    */
+    void close();
+
+    bool isOpen() const { return file.isOpen(); }
+
+    /*
+     * @brief Append a sample
+     *
+     * @return void
+    */
+    void write(const DeviceSample& sample);
+
+    // See DriveLogEncoder::setQuantum()
+    void setQuantum(uint8_t deviceAddress, double quantum) { encoder.setQuantum(deviceAddress, quantum); }
+
+    // Samples written since open(), including the ones of the block being built
+    quint64 sampleCount() const { return samples; }
+    // Bytes written to the file
+    quint64 fileSize() const { return writtenBytes; }
+
+private:
+    struct IndexEntry
+    {
+        quint64 offset;
+        qint64 firstTimestamp;
+        qint64 lastTimestamp;
+        quint32 sampleCount;
+    };
+
+    /*
+     * @brief Write the current block and add it to the index
+     *
+     * @return void
+    */
+    void writeBlock();
+
+    void writeBuffer();
+
+    QFile file;
+    DriveLogEncoder encoder;
+    // Reused between blocks
+    std::vector<uint8_t> buffer;
+    std::vector<IndexEntry> index;
+    quint64 samples = 0;
+    quint64 writtenBytes = 0;
+};
+
+/*
+ * A decoded column of a drive log block: every sample of one device and source, in the order they were written
+*/
+struct DriveLogColumn
+{
+    uint8_t deviceAddress = 0;
+    uint8_t sourceId = 0;
+    DeviceSample::PayloadType payloadType = DeviceSample::PAYLOAD_TYPE_NONE;
+    std::vector<int64_t> timestamps;
+    // Empty for unknown devices
+    std::vector<double> values;
+
+    DeviceSample sample(size_t index) const
+    {
+        DeviceSample decoded;
+        switch(payloadType)
+        {
+        case DeviceSample::PAYLOAD_TYPE_BYTE:
+            decoded = DeviceSample::fromByte(deviceAddress, timestamps[index], static_cast<uint8_t>(values[index]));
+            break;
+        case DeviceSample::PAYLOAD_TYPE_FLOAT:
+            decoded = DeviceSample::fromFloat(deviceAddress, timestamps[index], static_cast<float>(values[index]));
+            break;
+        default:
+            decoded = DeviceSample::fromUnknown(deviceAddress, timestamps[index]);
+            break;
+        }
+        decoded.setSourceId(sourceId);
+        return decoded;
+    }
+};
+
+/*
+ * Reads a drive log through a memory mapping.
+ *
+ * The index locates the blocks of a time range without reading the others. A block is decoded column by column
+ * into vectors reused from one block to the next, so reading a whole log doesn't allocate once the first blocks are decoded.
+*/
+class DriveLogReader
+{
+public:
+    struct Block
+    {
+        quint64 offset;
+        qint64 firstTimestamp;
+        qint64 lastTimestamp;
+        quint32 sampleCount;
+        // Latest timestamp of this block and the ones before. Late merged samples can make lastTimestamp go back, this only grows
+        qint64 latestTimestamp;
+    };
+
+    ~DriveLogReader() { close(); }
+
+    /*
+     * @brief Map the log, check its header and load its index. The index of a log without one is rebuilt from the block headers
+     *
+     * @return false if the file can't be mapped or is not a drive log
+    */
+    bool open(const QString& filePath);
+
+    void close();
+
+    bool isOpen() const { return mappedData != nullptr; }
+
+    const std::vector<Block>& blocks() const { return index; }
+
+    /*
+     * @brief Find the first block that may hold samples at or after a timestamp. The blocks before it hold none
+     *
+     * @return Block index, blocks().size() if every sample of the log is older
+    */
+    size_t findBlock(qint64 timestamp) const;
+
+    /*
+     * @brief Decode a block
+     *
+     * @param blockIndex    Index of the block in blocks()
+     * @param columns       Replaced by the columns of the block, the vectors of the previous ones are reused
+     *
+     * @return false if the block is corrupted
+    */
+    bool readBlock(size_t blockIndex, std::vector<DriveLogColumn>& columns) const;
+
+    size_t size() const { return mappedSize; }
+    // The log had no index, it was rebuilt from the block headers
+    bool recovered() const { return indexRecovered; }
+
+private:
+    bool loadIndex();
+    void recoverIndex();
+    // Fill Block::latestTimestamp
+    void indexLatestTimestamps();
+
+    QFile file;
+    const uchar* mappedData = nullptr;
+    size_t mappedSize = 0;
+    std::vector<Block> index;
+    bool indexRecovered = false;
+};
+
+#endif // DRIVELOGFILE_H
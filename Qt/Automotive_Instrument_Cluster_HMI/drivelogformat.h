@@ -0,0 +1,129 @@
+#ifndef DRIVELOGFORMAT_H
+#define DRIVELOGFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Drive log file, a compact columnar log of the decoded samples for multi-hour drives, see DriveLogWriter and DriveLogReader.
+ *
+ * Header (16 bytes): DRIVE_LOG_MAGIC (8 bytes) -> Format version (uint32) -> Reserved (uint32)
+ * Then blocks of at most DRIVE_LOG_BLOCK_MAX_SAMPLES samples or DRIVE_LOG_BLOCK_MAX_SPAN_NS of time, each:
+ *      Block header (DRIVE_LOG_BLOCK_HEADER_SIZE bytes): DRIVE_LOG_BLOCK_MAGIC (uint32) -> Size of the rest of the block (uint32)
+ *          -> Sample count (uint32) -> Column count (uint16) -> Reserved (uint16) -> First timestamp (int64) -> Last timestamp (int64)
+ *          The first timestamp is the one of the first sample written, the last one the latest of the block
+ *      One column header per device and source (DRIVE_LOG_COLUMN_HEADER_SIZE bytes): Device address (uint8) -> Source id (uint8)
+ *          -> Payload type (uint8, DeviceSample::PayloadType) -> Value encoding (uint8, DriveLogEncoding) -> Quantum (float64)
+ *          -> Sample count (uint32) -> Timestamp bytes (uint32) -> Value bytes (uint32)
+ *      The data of every column, in header order: its timestamps then its values
+ * Then the index, one entry per block (DRIVE_LOG_INDEX_ENTRY_SIZE bytes): Block offset (uint64) -> First timestamp (int64)
+ *      -> Last timestamp (int64) -> Sample count (uint32) -> Reserved (uint32)
+ * Then the trailer (DRIVE_LOG_TRAILER_SIZE bytes): Index offset (uint64) -> Block count (uint32) -> DRIVE_LOG_INDEX_MAGIC (uint32)
+ *
+ * Timestamps are nanoseconds, the first of a column relative to the block first timestamp, then each relative to the previous one,
+ * as zigzag varints. Quantized values are round(value / quantum), each relative to the previous one of the column, as zigzag varints.
+ * Byte payloads use a quantum of 1 and are exact. Fixed size fields are little-endian.
+ *
+ * A log whose writer was killed has no index: the reader rebuilds it from the block headers, up to the last complete block.
+*/
+#define DRIVE_LOG_MAGIC "AICHLOG\0"
+#define DRIVE_LOG_VERSION 1
+#define DRIVE_LOG_HEADER_SIZE 16
+#define DRIVE_LOG_BLOCK_MAGIC 0x42484341u   // "ACHB"
+#define DRIVE_LOG_BLOCK_HEADER_SIZE 32
+#define DRIVE_LOG_COLUMN_HEADER_SIZE 24
+#define DRIVE_LOG_INDEX_ENTRY_SIZE 32
+#define DRIVE_LOG_INDEX_MAGIC 0x49484341u   // "ACHI"
+#define DRIVE_LOG_TRAILER_SIZE 16
+
+// Block limits, the seek granularity of the index
+#define DRIVE_LOG_BLOCK_MAX_SAMPLES 65536
+#define DRIVE_LOG_BLOCK_MAX_SPAN_NS 10000000000LL
+// Quantum of the float devices without one set, see DriveLogWriter::setQuantum()
+#define DRIVE_LOG_DEFAULT_FLOAT_QUANTUM 0.0001
+// A zigzag varint of 64 bits takes at most 10 bytes
+#define DRIVE_LOG_MAX_VARINT_SIZE 10
+
+enum DriveLogEncoding
+{
+    // Unknown devices, timestamps only
+    DRIVE_LOG_ENCODING_NONE,
+    // Zigzag varint deltas of round(value / quantum)
+    DRIVE_LOG_ENCODING_QUANTIZED,
+    // Little-endian float32, for devices logged without quantization
+    DRIVE_LOG_ENCODING_FLOAT
+};
+
+namespace DriveLog
+{
+    inline uint64_t zigzagEncode(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+    inline int64_t zigzagDecode(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+    // Append a LEB128 varint to out, which must have room for DRIVE_LOG_MAX_VARINT_SIZE bytes. Returns the end of the varint
+    inline uint8_t* writeVarint(uint8_t* out, uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            *out++ = static_cast<uint8_t>(value) | 0x80;
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+
+    // Read a LEB128 varint, returns the end of the varint or nullptr if it runs past end or is too long
+    inline const uint8_t* readVarint(const uint8_t* in, const uint8_t* end, uint64_t& value)
+    {
+        // Small deltas, the common case, take a single byte
+        if(in < end && *in < 0x80)
+        {
+            value = *in;
+            return in + 1;
+        }
+
+        value = 0;
+        for(unsigned shift = 0; shift < 64 && in < end; shift += 7)
+        {
+            const uint8_t byte = *in++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if(byte < 0x80)
+            {
+                return in;
+            }
+        }
+        return nullptr;
+    }
+
+    template<size_t Size> struct Bits;
+    template<> struct Bits<1> { typedef uint8_t Type; };
+    template<> struct Bits<2> { typedef uint16_t Type; };
+    template<> struct Bits<4> { typedef uint32_t Type; };
+    template<> struct Bits<8> { typedef uint64_t Type; };
+
+    template<typename T>
+    inline void writeLittleEndian(uint8_t* out, T value)
+    {
+        typename Bits<sizeof(T)>::Type bits;
+        memcpy(&bits, &value, sizeof(T));
+        for(size_t i = 0; i < sizeof(T); i++)
+        {
+            out[i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+    }
+
+    template<typename T>
+    inline T readLittleEndian(const uint8_t* in)
+    {
+        typename Bits<sizeof(T)>::Type bits = 0;
+        for(size_t i = 0; i < sizeof(T); i++)
+        {
+            bits |= static_cast<typename Bits<sizeof(T)>::Type>(static_cast<typename Bits<sizeof(T)>::Type>(in[i]) << (8 * i));
+        }
+        T value;
+        memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+}
+
+#endif // DRIVELOGFORMAT_H
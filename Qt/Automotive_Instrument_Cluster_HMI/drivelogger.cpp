@@ -0,0 +1,262 @@
+#include "drivelogger.h"
+#include <QTimerEvent>
+#include <array>
+#include <atomic>
+#include "deviceprotocol.h"
+#include "drivelogfile.h"
+
+// Period the writer thread drains the ring at, in milliseconds
+#define DRIVE_LOGGER_DRAIN_INTERVAL 100
+// Period the counters are refreshed at while open, in milliseconds
+#define DRIVE_LOGGER_STATISTICS_INTERVAL 1000
+
+/*
+ * Owns the DriveLogWriter on the writer thread. Every member but the counters is only used on that thread
+*/
+class DriveLogWorker : public QObject
+{
+public:
+    explicit DriveLogWorker(SpscRingBuffer<DeviceSample>* sampleRing) : ring(sampleRing) {}
+
+    bool open(const QString& filePath, const std::array<double, 256>& quanta)
+    {
+        for(size_t address = 0; address < quanta.size(); address++)
+        {
+            writer.setQuantum(static_cast<uint8_t>(address), quanta[address]);
+        }
+        if(!writer.open(filePath))
+        {
+            return false;
+        }
+        drainTimer = startTimer(DRIVE_LOGGER_DRAIN_INTERVAL);
+        return true;
+    }
+
+    void close()
+    {
+        if(drainTimer)
+        {
+            killTimer(drainTimer);
+            drainTimer = 0;
+        }
+        drain();
+        writer.close();
+        updateCounters();
+    }
+
+    std::atomic<quint64> writtenSamples { 0 };
+    std::atomic<quint64> fileSize { 0 };
+
+protected:
+    void timerEvent(QTimerEvent* event) override
+    {
+        if(event->timerId() == drainTimer)
+        {
+            drain();
+        }
+    }
+
+private:
+    void drain()
+    {
+        ring->drain([this](const DeviceSample& sample) { writer.write(sample); });
+        updateCounters();
+    }
+
+    void updateCounters()
+    {
+        writtenSamples.store(writer.sampleCount(), std::memory_order_relaxed);
+        fileSize.store(writer.fileSize(), std::memory_order_relaxed);
+    }
+
+    SpscRingBuffer<DeviceSample>* ring;
+    DriveLogWriter writer;
+    int drainTimer = 0;
+};
+
+DriveLogger::DriveLogger(QObject* parent) : QObject(parent)
+{
+    writerThread.setObjectName(QStringLiteral("DriveLog"));
+    statisticsTimer.setInterval(DRIVE_LOGGER_STATISTICS_INTERVAL);
+    QObject::connect(&statisticsTimer, &QTimer::timeout, this, &DriveLogger::refreshStatistics);
+}
+
+DriveLogger::~DriveLogger()
+{
+    stopWorker();
+}
+
+void DriveLogger::setSource(QObject* source)
+{
+    if(sampleSource == source)
+    {
+        return;
+    }
+
+    QObject::disconnect(sourceConnection);
+    sampleSource = source;
+    if(sampleSource)
+    {
+        // String based, so any object with the signal can be logged
+        sourceConnection = QObject::connect(sampleSource, SIGNAL(deviceSampleAvailable(DeviceSample)), this, SLOT(addSample(DeviceSample)));
+        if(!sourceConnection)
+        {
+            qWarning("DriveLogger: source has no deviceSampleAvailable(DeviceSample) signal");
+        }
+    }
+    emit sourceChanged(source);
+}
+
+void DriveLogger::setFilePath(const QString& filePath)
+{
+    if(logFilePath != filePath)
+    {
+        logFilePath = filePath;
+        emit filePathChanged(filePath);
+        applySettings();
+    }
+}
+
+void DriveLogger::setQuanta(const QVariantMap& quanta)
+{
+    if(quantumSettings != quanta)
+    {
+        quantumSettings = quanta;
+        emit quantaChanged(quanta);
+    }
+}
+
+void DriveLogger::setBufferCapacity(int bufferCapacity)
+{
+    if(capacity != bufferCapacity && bufferCapacity > 0)
+    {
+        capacity = bufferCapacity;
+        emit bufferCapacityChanged(bufferCapacity);
+    }
+}
+
+void DriveLogger::setActive(bool active)
+{
+    if(activeRequested != active)
+    {
+        activeRequested = active;
+        emit activeChanged(active);
+        applySettings();
+    }
+}
+
+void DriveLogger::componentComplete()
+{
+    // Open with the final settings, rather than once per property assigned from QML
+    componentCompleted = true;
+    applySettings();
+}
+
+void DriveLogger::addSample(const DeviceSample& sample)
+{
+    if(ring && !ring->push(sample))
+    {
+        dropped++;
+    }
+}
+
+void DriveLogger::applySettings()
+{
+    if(!componentCompleted)
+    {
+        return;
+    }
+
+    stopWorker();
+
+    if(!activeRequested || logFilePath.isEmpty())
+    {
+        return;
+    }
+
+    std::array<double, 256> quanta;
+    quanta.fill(DRIVE_LOG_DEFAULT_FLOAT_QUANTUM);
+    for(auto it = quantumSettings.constBegin(); it != quantumSettings.constEnd(); ++it)
+    {
+        const DeviceDescriptor* device = nullptr;
+        for(const DeviceDescriptor& descriptor : DEVICE_DESCRIPTORS)
+        {
+            if(it.key().compare(QLatin1String(descriptor.name), Qt::CaseInsensitive) == 0)
+            {
+                device = &descriptor;
+            }
+        }
+        if(!device)
+        {
+            qWarning("DriveLogger: unknown device %s", qPrintable(it.key()));
+            continue;
+        }
+        quanta[device->address] = it.value().toDouble();
+    }
+
+    ring = std::make_unique<SpscRingBuffer<DeviceSample>>(static_cast<size_t>(capacity));
+    worker = new DriveLogWorker(ring.get());
+    worker->moveToThread(&writerThread);
+    writerThread.start();
+
+    bool opened = false;
+    QMetaObject::invokeMethod(worker, [worker = worker, filePath = logFilePath, &quanta, &opened]()
+    {
+        opened = worker->open(filePath, quanta);
+    }, Qt::BlockingQueuedConnection);
+
+    if(!opened)
+    {
+        writerThread.quit();
+        writerThread.wait();
+        delete worker;
+        worker = nullptr;
+        ring.reset();
+        return;
+    }
+
+    dropped = 0;
+    refreshStatistics();
+    statisticsTimer.start();
+    emit isOpenChanged(true);
+}
+
+void DriveLogger::stopWorker()
+{
+    if(!worker)
+    {
+        return;
+    }
+
+    statisticsTimer.stop();
+
+    // Finish the log on its own thread, then stop the thread so the worker can be deleted from here
+    QMetaObject::invokeMethod(worker, [worker = worker]() { worker->close(); }, Qt::BlockingQueuedConnection);
+    writerThread.quit();
+    writerThread.wait();
+
+    refreshStatistics();
+    delete worker;
+    worker = nullptr;
+    ring.reset();
+
+    emit isOpenChanged(false);
+}
+
+void DriveLogger::refreshStatistics()
+{
+    if(!worker)
+    {
+        return;
+    }
+
+    const quint64 written = worker->writtenSamples.load(std::memory_order_relaxed);
+    const quint64 size = worker->fileSize.load(std::memory_order_relaxed);
+    if(written != reportedWrittenSamples || size != reportedFileSize || dropped != reportedDroppedSamples)
+    {
+        reportedWrittenSamples = written;
+        reportedFileSize = size;
+        reportedDroppedSamples = dropped;
+        emit statisticsChanged();
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef DRIVELOGGER_H
+#define DRIVELOGGER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQmlParserStatus>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QVariantMap>
+#include <memory>
+#include "devicesample.h"
+#include "spscringbuffer.h"
+
+class DriveLogWorker;
+
+/*
+ * Records every sample of a source to a drive log for the whole drive, see drivelogformat.h.
+ *
+ * The samples are only pushed into a bounded lock-free SpscRingBuffer on the GUI thread. A DriveLogWriter on a dedicated QThread
+ * drains it every DRIVE_LOGGER_DRAIN_INTERVAL, encodes the samples and writes the finished blocks, so neither the encoding nor the disk
+ * can stall rendering. Samples arriving on a full ring are dropped and counted.
+ *
+ * The quantum float values are rounded to is set per device from QML, keyed by the device name of DEVICE_PROTOCOL_DEVICES:
+ *     quanta: { "LM35": 0.01, "ACCELEROMETER": 0.001 }
+ * Devices without one use DRIVE_LOG_DEFAULT_FLOAT_QUANTUM, 0 logs them as float32 without loss.
+*/
+class DriveLogger : public QObject, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+    // Object emitting deviceSampleAvailable(DeviceSample), e.g. Serial or SourceManager
+    Q_PROPERTY(QObject* source READ source WRITE setSource NOTIFY sourceChanged)
+    // Log file, created or truncated on open. Reopens the log
+    Q_PROPERTY(QString filePath READ filePath WRITE setFilePath NOTIFY filePathChanged)
+    // Value quantum per device name. Applied on the next open
+    Q_PROPERTY(QVariantMap quanta READ quanta WRITE setQuanta NOTIFY quantaChanged)
+    // Max number of samples waiting for the writer thread, it must hold a drain interval of samples. Applied on the next open
+    Q_PROPERTY(int bufferCapacity READ bufferCapacity WRITE setBufferCapacity NOTIFY bufferCapacityChanged)
+    // Open the log when true, finish it when false
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(bool isOpen READ isOpen NOTIFY isOpenChanged)
+    // Refreshed every second while open
+    Q_PROPERTY(double writtenSamples READ writtenSamples NOTIFY statisticsChanged)
+    Q_PROPERTY(double droppedSamples READ droppedSamples NOTIFY statisticsChanged)
+    Q_PROPERTY(double fileSize READ fileSize NOTIFY statisticsChanged)
+
+public:
+    DriveLogger(QObject* parent = nullptr);
+    ~DriveLogger();
+
+    QObject* source() const { return sampleSource; }
+    void setSource(QObject* source);
+
+    QString filePath() const { return logFilePath; }
+    void setFilePath(const QString& filePath);
+
+    QVariantMap quanta() const { return quantumSettings; }
+    void setQuanta(const QVariantMap& quanta);
+
+    int bufferCapacity() const { return capacity; }
+    void setBufferCapacity(int bufferCapacity);
+
+    bool active() const { return activeRequested; }
+    void setActive(bool active);
+
+    bool isOpen() const { return worker != nullptr; }
+
+    double writtenSamples() const { return static_cast<double>(reportedWrittenSamples); }
+    double droppedSamples() const { return static_cast<double>(reportedDroppedSamples); }
+    double fileSize() const { return static_cast<double>(reportedFileSize); }
+
+    void classBegin() override { componentCompleted = false; }
+    void componentComplete() override;
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Queue a sample for the writer thread, or drop it if the ring is full
+     *
+     * @return void
+    */
+    void addSample(const DeviceSample& sample);
+
+Q_SIGNALS:
+    void sourceChanged(QObject* source);
+    void filePathChanged(QString filePath);
+    void quantaChanged(QVariantMap quanta);
+    void bufferCapacityChanged(int bufferCapacity);
+    void activeChanged(bool active);
+    void isOpenChanged(bool isOpen);
+    void statisticsChanged();
+
+private:
+    /*
+     * @brief (Re)open the log on the writer thread with the current settings, or finish it if not active
+     *
+     * @return void
+    */
+    void applySettings();
+
+    /*
+     * @brief Write what is left in the ring, finish the log and stop the writer thread
+     *
+     * @return void
+    */
+    void stopWorker();
+
+    /*
+     * @brief [SLOT] Read the counters of the writer thread
+     *
+     * @return void
+    */
+    void refreshStatistics();
+
+    QString logFilePath;
+    QVariantMap quantumSettings;
+    int capacity = 65536;
+    bool activeRequested = false;
+    bool componentCompleted = true;
+
+    QThread writerThread;
+    std::unique_ptr<SpscRingBuffer<DeviceSample>> ring;
+    DriveLogWorker* worker = nullptr;
+    QTimer statisticsTimer;
+    quint64 dropped = 0;
+    quint64 reportedWrittenSamples = 0;
+    quint64 reportedDroppedSamples = 0;
+    quint64 reportedFileSize = 0;
+
+    QPointer<QObject> sampleSource;
+    QMetaObject::Connection sourceConnection;
+};
+
+#endif // DRIVELOGGER_H
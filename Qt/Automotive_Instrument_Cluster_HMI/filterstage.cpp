@@ -0,0 +1,103 @@
+#include "filterstage.h"
+#include "deviceprotocol.h"
+
+FilterStage::FilterStage(QObject* parent) : QObject(parent)
+{
+}
+
+void FilterStage::setSource(QObject* source)
+{
+    if(sampleSource == source)
+    {
+        return;
+    }
+
+    QObject::disconnect(sourceConnection);
+    sampleSource = source;
+    if(sampleSource)
+    {
+        // String based, so any object with the signal can feed the stage
+        sourceConnection = QObject::connect(sampleSource, SIGNAL(deviceSampleAvailable(DeviceSample)), this, SLOT(addSample(DeviceSample)));
+        if(!sourceConnection)
+        {
+            qWarning("FilterStage: source has no deviceSampleAvailable(DeviceSample) signal");
+        }
+    }
+    filter.reset();
+    emit sourceChanged(source);
+}
+
+void FilterStage::setFilters(const QVariantMap& filters)
+{
+    if(filterSettings == filters)
+    {
+        return;
+    }
+
+    filterSettings = filters;
+    filter.clearSettings();
+
+    for(auto it = filters.constBegin(); it != filters.constEnd(); ++it)
+    {
+        const DeviceDescriptor* device = nullptr;
+        for(const DeviceDescriptor& descriptor : DEVICE_DESCRIPTORS)
+        {
+            if(it.key().compare(QLatin1String(descriptor.name), Qt::CaseInsensitive) == 0)
+            {
+                device = &descriptor;
+            }
+        }
+        if(!device)
+        {
+            qWarning("FilterStage: unknown device %s", qPrintable(it.key()));
+            continue;
+        }
+
+        const QVariantMap entry = it.value().toMap();
+        SampleFilterSettings settings;
+
+        const QString lowPass = entry.value(QStringLiteral("lowPass"), QStringLiteral("none")).toString();
+        if(lowPass == QLatin1String("exponential"))
+        {
+            settings.lowPass = SampleFilterSettings::LOW_PASS_EXPONENTIAL;
+        }
+        else if(lowPass == QLatin1String("biquad"))
+        {
+            settings.lowPass = SampleFilterSettings::LOW_PASS_BIQUAD;
+        }
+        else if(lowPass != QLatin1String("none"))
+        {
+            qWarning("FilterStage: unknown low-pass %s for %s", qPrintable(lowPass), device->name);
+        }
+
+        settings.cutoffFrequency = entry.value(QStringLiteral("cutoffFrequency"), settings.cutoffFrequency).toDouble();
+        settings.sampleRate = entry.value(QStringLiteral("sampleRate"), settings.sampleRate).toDouble();
+        settings.kalman = entry.value(QStringLiteral("kalman"), settings.kalman).toBool();
+        settings.processNoise = entry.value(QStringLiteral("processNoise"), settings.processNoise).toDouble();
+        settings.measurementNoise = entry.value(QStringLiteral("measurementNoise"), settings.measurementNoise).toDouble();
+
+        filter.setSettings(device->address, settings);
+    }
+
+    emit filtersChanged(filters);
+}
+
+void FilterStage::setEnabled(bool enabled)
+{
+    if(filtering != enabled)
+    {
+        filtering = enabled;
+        // Don't resume from values that are stale by now
+        filter.reset();
+        emit enabledChanged(enabled);
+    }
+}
+
+void FilterStage::addSample(DeviceSample sample)
+{
+    if(filtering)
+    {
+        filter.filter(sample);
+    }
+    emit deviceSampleAvailable(sample);
+}
@@ -0,0 +1,83 @@
+#ifndef FILTERSTAGE_H
+#define FILTERSTAGE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVariantMap>
+#include "devicesample.h"
+#include "samplefilter.h"
+
+/*
+ * Filtering stage between a sample source and its consumers, e.g. SourceManager -> FilterStage -> ClusterState.
+ *
+ * Every sample of the source is filtered by a SampleFilter and re-emitted as [SIGNAL] deviceSampleAvailable(), in order and on the same thread,
+ * so the stage can be used as the source of anything taking one.
+ *
+ * The filters are set per device from QML, keyed by the device name of DEVICE_PROTOCOL_DEVICES:
+ *     filters: { "ACCELEROMETER": { "lowPass": "biquad", "cutoffFrequency": 5, "sampleRate": 100, "kalman": true } }
+ * Each entry takes lowPass ("none", "exponential" or "biquad"), cutoffFrequency, sampleRate, kalman, processNoise and measurementNoise,
+ * see SampleFilterSettings for their meaning and defaults. The settings are shared by every source, but each source keeps its own filter state
+ * (up to SAMPLE_FILTER_MAX_SOURCES sources, see SampleFilter).
+*/
+class FilterStage : public QObject
+{
+    Q_OBJECT
+    // Object emitting deviceSampleAvailable(DeviceSample), e.g. Serial or SourceManager
+    Q_PROPERTY(QObject* source READ source WRITE setSource NOTIFY sourceChanged)
+    // Filter settings per device name
+    Q_PROPERTY(QVariantMap filters READ filters WRITE setFilters NOTIFY filtersChanged)
+    // Pass the samples through unchanged when false
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+
+public:
+    FilterStage(QObject* parent = nullptr);
+
+    QObject* source() const { return sampleSource; }
+    void setSource(QObject* source);
+
+    QVariantMap filters() const { return filterSettings; }
+    void setFilters(const QVariantMap& filters);
+
+    bool enabled() const { return filtering; }
+    void setEnabled(bool enabled);
+
+    // The filter applied, e.g. to filter a replayed span of samples with the same settings
+    SampleFilter& sampleFilter() { return filter; }
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Filter a sample and emit it as [SIGNAL] deviceSampleAvailable()
+     *
+     * @return void
+    */
+    void addSample(DeviceSample sample);
+
+    /*
+     * @brief [SLOT] Restart the filters from the next sample, e.g. after the source was reconnected
+     *
+     * @return void
+    */
+    void reset() { filter.reset(); }
+
+Q_SIGNALS:
+    void sourceChanged(QObject* source);
+    void filtersChanged(QVariantMap filters);
+    void enabledChanged(bool enabled);
+
+    /*
+     * @brief [SIGNAL] Emitted for every sample of the source, filtered
+     *
+     * @return void
+    */
+    void deviceSampleAvailable(DeviceSample sample);
+
+private:
+    SampleFilter filter;
+    QVariantMap filterSettings;
+    bool filtering = true;
+
+    QPointer<QObject> sampleSource;
+    QMetaObject::Connection sourceConnection;
+};
+
+#endif // FILTERSTAGE_H
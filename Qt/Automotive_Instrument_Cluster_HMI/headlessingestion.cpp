@@ -0,0 +1,241 @@
+#include "headlessingestion.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+
+// Period the duration and Ctrl+C are checked at, in milliseconds
+#define HEADLESS_TICK_INTERVAL 100
+
+namespace
+{
+// Set by the SIGINT/SIGTERM handler, where a lock-free atomic store is all that is safe to do
+std::atomic<bool> stopRequested(false);
+
+void onStopSignal(int)
+{
+    stopRequested.store(true, std::memory_order_relaxed);
+}
+
+// Latency in microseconds, for the statistics lines
+double toMicroseconds(int64_t latencyNs)
+{
+    return latencyNs / 1000.0;
+}
+}
+
+HeadlessIngestion::HeadlessIngestion(QObject* parent) : QObject(parent)
+{
+    tickTimer.setInterval(HEADLESS_TICK_INTERVAL);
+    QObject::connect(&tickTimer, &QTimer::timeout, this, &HeadlessIngestion::onTick);
+}
+
+HeadlessIngestion::~HeadlessIngestion()
+{
+    finish();
+}
+
+bool HeadlessIngestion::start(const QStringList& arguments)
+{
+    QCommandLineParser commandLine;
+    commandLine.setApplicationDescription(QStringLiteral("Decodes a serial port or a capture without QML nor rendering, and reports the ingestion throughput, latency and frame errors."));
+    commandLine.addHelpOption();
+
+    const QCommandLineOption headlessOption(QStringLiteral("headless"), QStringLiteral("Run the ingestion alone, without a display."));
+    const QCommandLineOption portOption(QStringLiteral("port"), QStringLiteral("Serial port to read."), QStringLiteral("name"));
+    const QCommandLineOption baudOption(QStringLiteral("baud"), QStringLiteral("Baud rate of the port."), QStringLiteral("rate"), QStringLiteral("4800"));
+    const QCommandLineOption captureOption(QStringLiteral("capture"), QStringLiteral("Also record the raw bytes read from the port to a capture file."), QStringLiteral("file"));
+    const QCommandLineOption replayOption(QStringLiteral("replay"), QStringLiteral("Capture file to replay instead of reading a port."), QStringLiteral("file"));
+    const QCommandLineOption speedOption(QStringLiteral("speed"), QStringLiteral("Replay speed factor of the recorded timing, 0 for as fast as possible."), QStringLiteral("factor"), QStringLiteral("0"));
+    const QCommandLineOption protocolOption(QStringLiteral("protocol"), QStringLiteral("Wire format of the device data frames, 1 or 2."), QStringLiteral("version"), QStringLiteral("2"));
+    const QCommandLineOption csvOption(QStringLiteral("csv"), QStringLiteral("Write every decoded sample to a CSV file."), QStringLiteral("file"));
+    const QCommandLineOption binaryOption(QStringLiteral("binary"), QStringLiteral("Write every decoded sample to a binary sample file."), QStringLiteral("file"));
+    const QCommandLineOption driveLogOption(QStringLiteral("drive-log"), QStringLiteral("Write every decoded sample to a drive log, from a writer thread."), QStringLiteral("file"));
+    const QCommandLineOption intervalOption(QStringLiteral("interval"), QStringLiteral("Statistics period in milliseconds."), QStringLiteral("ms"), QStringLiteral("1000"));
+    const QCommandLineOption durationOption(QStringLiteral("duration"), QStringLiteral("Stop after this many seconds, 0 to run until the replay ends or Ctrl+C."), QStringLiteral("seconds"), QStringLiteral("0"));
+    commandLine.addOptions({ headlessOption, portOption, baudOption, captureOption, replayOption, speedOption, protocolOption,
+                             csvOption, binaryOption, driveLogOption, intervalOption, durationOption });
+    commandLine.process(arguments);
+
+    if(commandLine.isSet(portOption) == commandLine.isSet(replayOption))
+    {
+        qCritical("HeadlessIngestion: give either --port or --replay");
+        return false;
+    }
+    if(commandLine.isSet(csvOption) && commandLine.isSet(binaryOption))
+    {
+        qCritical("HeadlessIngestion: give either --csv or --binary");
+        return false;
+    }
+
+    const Serial::FrameProtocol protocol = commandLine.value(protocolOption).toInt() == 1 ? Serial::FRAME_PROTOCOL_V1 : Serial::FRAME_PROTOCOL_V2;
+    statisticsInterval = qMax(HEADLESS_TICK_INTERVAL, commandLine.value(intervalOption).toInt());
+    duration = static_cast<qint64>(commandLine.value(durationOption).toDouble() * 1000.0);
+
+    // Open the output first, so no sample is missed
+    if(commandLine.isSet(csvOption) && !writer.open(commandLine.value(csvOption), SampleWriter::FORMAT_CSV))
+    {
+        return false;
+    }
+    if(commandLine.isSet(binaryOption) && !writer.open(commandLine.value(binaryOption), SampleWriter::FORMAT_BINARY))
+    {
+        return false;
+    }
+    if(commandLine.isSet(driveLogOption))
+    {
+        driveLogger.setFilePath(commandLine.value(driveLogOption));
+        driveLogger.setActive(true);
+        if(!driveLogger.isOpen())
+        {
+            return false;
+        }
+    }
+
+    if(commandLine.isSet(portOption))
+    {
+        serial = std::make_unique<Serial>();
+        serial->setPortName(commandLine.value(portOption));
+        serial->setBaudRate(commandLine.value(baudOption).toInt());
+        serial->setFrameProtocol(protocol);
+        // The decode timestamps split the latency into decoding and handling
+        serial->setLatencyProbes(true);
+        if(commandLine.isSet(captureOption))
+        {
+            serial->setCaptureFile(commandLine.value(captureOption));
+        }
+        QObject::connect(serial.get(), &Serial::deviceSampleAvailable, this, &HeadlessIngestion::onSample);
+
+        if(!serial->open(QIODevice::ReadOnly))
+        {
+            qCritical("HeadlessIngestion: can't open %s: %s", qPrintable(serial->portName()), qPrintable(serial->errorString()));
+            return false;
+        }
+    }
+    else
+    {
+        replay = std::make_unique<CaptureReplay>();
+        replay->setFile(commandLine.value(replayOption));
+        replay->setSpeed(commandLine.value(speedOption).toDouble());
+        replay->setFrameProtocol(protocol);
+        QObject::connect(replay.get(), &CaptureReplay::deviceSampleAvailable, this, &HeadlessIngestion::onSample);
+        QObject::connect(replay.get(), &CaptureReplay::finished, this, [this]()
+        {
+            finish();
+            QCoreApplication::quit();
+        });
+
+        replay->start();
+        if(!replay->running())
+        {
+            return false;
+        }
+    }
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    runClock.start();
+    tickTimer.start();
+    return true;
+}
+
+void HeadlessIngestion::onSample(const DeviceSample& sample)
+{
+    samples++;
+
+    if(serial)
+    {
+        const qint64 now = DeviceSample::currentTimestamp();
+        intervalLatency.record(now - sample.timestamp());
+        totalLatency.record(now - sample.timestamp());
+        intervalDecodeLatency.record(sample.decodedTimestamp() - sample.timestamp());
+    }
+
+    writer.write(sample);
+    driveLogger.addSample(sample);
+}
+
+void HeadlessIngestion::onTick()
+{
+    if(stopRequested.load(std::memory_order_relaxed) || (duration > 0 && runClock.elapsed() >= duration))
+    {
+        finish();
+        QCoreApplication::quit();
+        return;
+    }
+
+    const qint64 now = runClock.elapsed();
+    if(now - lastStatisticsTime < statisticsInterval)
+    {
+        return;
+    }
+
+    const double seconds = (now - lastStatisticsTime) / 1000.0;
+    const quint64 bytes = receivedBytes();
+    printf("%8.1f s %12.0f samples/s %12.0f B/s", now / 1000.0, (samples - lastSamples) / seconds, (bytes - lastReceivedBytes) / seconds);
+    if(serial)
+    {
+        printf("   latency p50 %8.1f us  p99 %8.1f us  max %8.1f us  (decode p99 %6.1f us)",
+               toMicroseconds(intervalLatency.valueAtPercentile(50.0)), toMicroseconds(intervalLatency.valueAtPercentile(99.0)),
+               toMicroseconds(intervalLatency.max()), toMicroseconds(intervalDecodeLatency.valueAtPercentile(99.0)));
+    }
+    printf("   corrupted %zu  lost %zu\n", corruptedFrames(), lostFrames());
+    fflush(stdout);
+
+    lastStatisticsTime = now;
+    lastSamples = samples;
+    lastReceivedBytes = bytes;
+    intervalLatency.reset();
+    intervalDecodeLatency.reset();
+}
+
+void HeadlessIngestion::finish()
+{
+    if(finished || !runClock.isValid())
+    {
+        return;
+    }
+    finished = true;
+
+    tickTimer.stop();
+    writer.close();
+    const bool driveLogged = driveLogger.isOpen();
+    driveLogger.setActive(false);
+
+    const double seconds = runClock.nsecsElapsed() / 1e9;
+    printf("total: %llu samples, %llu bytes in %.3f s (%.0f samples/s, %.0f B/s), corrupted %zu, lost %zu\n",
+           static_cast<unsigned long long>(samples), static_cast<unsigned long long>(receivedBytes()), seconds,
+           seconds > 0.0 ? samples / seconds : 0.0, seconds > 0.0 ? receivedBytes() / seconds : 0.0, corruptedFrames(), lostFrames());
+    if(serial)
+    {
+        printf("latency: p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+               toMicroseconds(totalLatency.valueAtPercentile(50.0)), toMicroseconds(totalLatency.valueAtPercentile(90.0)),
+               toMicroseconds(totalLatency.valueAtPercentile(99.0)), toMicroseconds(totalLatency.valueAtPercentile(99.9)),
+               toMicroseconds(totalLatency.max()));
+    }
+    if(writer.sampleCount() > 0)
+    {
+        printf("wrote %llu samples\n", static_cast<unsigned long long>(writer.sampleCount()));
+    }
+    if(driveLogged)
+    {
+        printf("drive log: %.0f samples in %.0f bytes, %.0f dropped\n", driveLogger.writtenSamples(), driveLogger.fileSize(), driveLogger.droppedSamples());
+    }
+    fflush(stdout);
+}
+
+quint64 HeadlessIngestion::receivedBytes() const
+{
+    return serial ? serial->receivedBytes() : replay->replayedBytes();
+}
+
+size_t HeadlessIngestion::corruptedFrames() const
+{
+    return serial ? static_cast<size_t>(serial->corruptedFrames()) : replay->corruptedFrames();
+}
+
+size_t HeadlessIngestion::lostFrames() const
+{
+    return serial ? static_cast<size_t>(serial->lostFrames()) : replay->lostFrames();
+}
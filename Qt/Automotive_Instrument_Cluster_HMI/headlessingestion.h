@@ -0,0 +1,87 @@
+#ifndef HEADLESSINGESTION_H
+#define HEADLESSINGESTION_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <memory>
+#include "capturereplay.h"
+#include "devicesample.h"
+#include "drivelogger.h"
+#include "latencyhistogram.h"
+#include "samplewriter.h"
+#include "serial.h"
+
+/*
+ * Ingestion without any QML nor rendering, for load testing the transport and the parser on machines without a display.
+ *
+ * Reads a serial port (through Serial, in the application thread) or replays a capture (through CaptureReplay, unthrottled by default),
+ * then prints the throughput, the arrival to handling latency and the frame errors every interval,
+ * and optionally writes every decoded sample to a CSV or binary sample file (see SampleWriter) and to a drive log (see DriveLogger).
+ *
+ * Started by main() with --headless, it runs on a QCoreApplication. See --help for the options.
+*/
+class HeadlessIngestion : public QObject
+{
+    Q_OBJECT
+
+public:
+    HeadlessIngestion(QObject* parent = nullptr);
+    ~HeadlessIngestion();
+
+    /*
+     * @brief Parse the command line, open the source and the output file, and start ingesting
+     *
+     * Exits the process on --help or an invalid command line
+     *
+     * @return false if the source or the output file can't be opened
+    */
+    bool start(const QStringList& arguments);
+
+private:
+    /*
+     * @brief [SLOT] Handle a decoded sample: record its latency and write it out
+     *
+     * @return void
+    */
+    void onSample(const DeviceSample& sample);
+
+    /*
+     * @brief [SLOT] Print the statistics of the last interval, and stop once the duration elapsed or on Ctrl+C
+     *
+     * @return void
+    */
+    void onTick();
+
+    // Print the statistics of the whole run and close the output file
+    void finish();
+
+    quint64 receivedBytes() const;
+    size_t corruptedFrames() const;
+    size_t lostFrames() const;
+
+    std::unique_ptr<Serial> serial;
+    std::unique_ptr<CaptureReplay> replay;
+    SampleWriter writer;
+    DriveLogger driveLogger;
+
+    // Arrival (read from the port) to handled here. Not recorded for replays, their timestamps are synthetic
+    LatencyHistogram intervalLatency;
+    LatencyHistogram totalLatency;
+    // Arrival to decoded, part of the above
+    LatencyHistogram intervalDecodeLatency;
+
+    QTimer tickTimer;
+    QElapsedTimer runClock;
+    qint64 statisticsInterval = 1000;
+    qint64 duration = 0;
+    qint64 lastStatisticsTime = 0;
+    quint64 samples = 0;
+    // Totals at the last statistics line
+    quint64 lastSamples = 0;
+    quint64 lastReceivedBytes = 0;
+    bool finished = false;
+};
+
+#endif // HEADLESSINGESTION_H
@@ -0,0 +1,178 @@
+#include "historymodel.h"
+
+HistoryModel::HistoryModel(QObject* parent) : QAbstractListModel(parent)
+{
+    updateTimer.setInterval(100);
+    QObject::connect(&updateTimer, &QTimer::timeout, this, [this]()
+    {
+        if(samplesAdded)
+        {
+            refresh();
+        }
+    });
+    updateTimer.start();
+}
+
+int HistoryModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(series.size());
+}
+
+QVariant HistoryModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || index.row() >= static_cast<int>(series.size()))
+    {
+        return QVariant();
+    }
+
+    const SampleHistory::Column& column = series[index.row()];
+    switch(role)
+    {
+        case TimeRole:
+            return span * (double(index.row()) / series.size() - 1.0);
+        case MinimumRole:
+            return column.min;
+        case MaximumRole:
+            return column.max;
+        case ValidRole:
+            return column.valid;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> HistoryModel::roleNames() const
+{
+    return {
+        { TimeRole, "time" },
+        { MinimumRole, "minimum" },
+        { MaximumRole, "maximum" },
+        { ValidRole, "valid" }
+    };
+}
+
+void HistoryModel::setSource(QObject* source)
+{
+    if(sampleSource == source)
+    {
+        return;
+    }
+
+    QObject::disconnect(sourceConnection);
+    sampleSource = source;
+    if(sampleSource)
+    {
+        // String based, so any object with the signal can feed the history, see ClusterState::setSource()
+        sourceConnection = QObject::connect(sampleSource, SIGNAL(deviceSampleAvailable(DeviceSample)), this, SLOT(addSample(DeviceSample)));
+        if(!sourceConnection)
+        {
+            qWarning("HistoryModel: source has no deviceSampleAvailable(DeviceSample) signal");
+        }
+    }
+    emit sourceChanged(source);
+}
+
+void HistoryModel::setDeviceAddress(int deviceAddress)
+{
+    if(address != deviceAddress)
+    {
+        address = deviceAddress;
+        clear();
+        emit deviceAddressChanged(deviceAddress);
+    }
+}
+
+void HistoryModel::setMemoryBudget(int memoryBudget)
+{
+    if(this->memoryBudget() != memoryBudget && memoryBudget > 0)
+    {
+        history.reset(static_cast<size_t>(memoryBudget) * 1024 * 1024);
+        refresh();
+        emit memoryBudgetChanged(memoryBudget);
+    }
+}
+
+void HistoryModel::setTimeSpan(double timeSpan)
+{
+    if(span != timeSpan && timeSpan > 0.0)
+    {
+        span = timeSpan;
+        refresh();
+        emit timeSpanChanged(timeSpan);
+    }
+}
+
+void HistoryModel::setColumns(int columns)
+{
+    if(columnCount != columns && columns >= 0)
+    {
+        columnCount = columns;
+        refresh();
+        emit columnsChanged(columns);
+    }
+}
+
+void HistoryModel::setUpdateInterval(int updateInterval)
+{
+    if(updateTimer.interval() != updateInterval && updateInterval > 0)
+    {
+        updateTimer.setInterval(updateInterval);
+        emit updateIntervalChanged(updateInterval);
+    }
+}
+
+void HistoryModel::clear()
+{
+    history.clear();
+    refresh();
+}
+
+void HistoryModel::addSample(const DeviceSample& sample)
+{
+    if(sample.deviceAddress() == address && sample.payloadType() != DeviceSample::PAYLOAD_TYPE_NONE)
+    {
+        history.append(sample.timestamp(), static_cast<float>(sample.value()));
+        samplesAdded = true;
+    }
+}
+
+void HistoryModel::refresh()
+{
+    samplesAdded = false;
+
+    // The rows are rewritten in place, only a change of their number resets the model
+    const bool rowCountChanged = series.size() != static_cast<size_t>(columnCount);
+    if(rowCountChanged)
+    {
+        beginResetModel();
+    }
+
+    const int64_t to = history.newestTimestamp();
+    const int64_t from = to - static_cast<int64_t>(span * 1e9);
+    history.query(from, to, static_cast<size_t>(columnCount), series);
+
+    if(rowCountChanged)
+    {
+        endResetModel();
+    }
+    else if(!series.empty())
+    {
+        emit dataChanged(index(0), index(static_cast<int>(series.size()) - 1));
+    }
+
+    bool hasValue = false;
+    double minimumValue = 0.0;
+    double maximumValue = 0.0;
+    for(const SampleHistory::Column& column : series)
+    {
+        if(column.valid)
+        {
+            minimumValue = hasValue ? qMin<double>(minimumValue, column.min) : column.min;
+            maximumValue = hasValue ? qMax<double>(maximumValue, column.max) : column.max;
+            hasValue = true;
+        }
+    }
+    seriesMinimum = minimumValue;
+    seriesMaximum = maximumValue;
+    emit rangeChanged();
+}
@@ -0,0 +1,124 @@
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QTimer>
+#include <vector>
+#include "devicesample.h"
+#include "samplehistory.h"
+
+/*
+ * Trend of a device's values for graphs, one row per column of the graph.
+ *
+ * Every sample of the given device is kept in a SampleHistory. Every updateInterval milliseconds (when samples arrived)
+ * the last timeSpan seconds of the history are resampled to the given number of columns, each row giving the min and max
+ * of the values in its column, so the cost of a refresh only depends on the width of the graph.
+*/
+class HistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+    // Object emitting deviceSampleAvailable(DeviceSample), e.g. Serial or ThreadedSerial
+    Q_PROPERTY(QObject* source READ source WRITE setSource NOTIFY sourceChanged)
+    // Device whose values are kept, see Serial::DeviceInternalAddress
+    Q_PROPERTY(int deviceAddress READ deviceAddress WRITE setDeviceAddress NOTIFY deviceAddressChanged)
+    // Memory used by the history in MiB. Changing it clears the history
+    Q_PROPERTY(int memoryBudget READ memoryBudget WRITE setMemoryBudget NOTIFY memoryBudgetChanged)
+    // Length of the displayed window in seconds, ending at the newest sample
+    Q_PROPERTY(double timeSpan READ timeSpan WRITE setTimeSpan NOTIFY timeSpanChanged)
+    // Number of rows, typically the width of the graph in pixels
+    Q_PROPERTY(int columns READ columns WRITE setColumns NOTIFY columnsChanged)
+    // Refresh period of the rows in milliseconds
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged)
+    // Range of the values in the displayed window, to scale the graph
+    Q_PROPERTY(double minimum READ minimum NOTIFY rangeChanged)
+    Q_PROPERTY(double maximum READ maximum NOTIFY rangeChanged)
+    // Seconds covered by the history, from the oldest kept sample to the newest one
+    Q_PROPERTY(double historyLength READ historyLength NOTIFY rangeChanged)
+
+public:
+    enum Roles
+    {
+        // Start of the column in seconds relative to the newest sample, negative
+        TimeRole = Qt::UserRole + 1,
+        MinimumRole,
+        MaximumRole,
+        // False when no sample falls in the column
+        ValidRole
+    };
+
+    HistoryModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QObject* source() const { return sampleSource; }
+    void setSource(QObject* source);
+
+    int deviceAddress() const { return address; }
+    void setDeviceAddress(int deviceAddress);
+
+    int memoryBudget() const { return static_cast<int>(history.memoryBudget() / (1024 * 1024)); }
+    void setMemoryBudget(int memoryBudget);
+
+    double timeSpan() const { return span; }
+    void setTimeSpan(double timeSpan);
+
+    int columns() const { return columnCount; }
+    void setColumns(int columns);
+
+    int updateInterval() const { return updateTimer.interval(); }
+    void setUpdateInterval(int updateInterval);
+
+    double minimum() const { return seriesMinimum; }
+    double maximum() const { return seriesMaximum; }
+    double historyLength() const { return (history.newestTimestamp() - history.oldestTimestamp()) / 1e9; }
+
+    /*
+     * @brief Drop every kept sample
+     *
+     * @return void
+    */
+    Q_INVOKABLE void clear();
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Keep the sample if it comes from the device
+     *
+     * @return void
+    */
+    void addSample(const DeviceSample& sample);
+
+    /*
+     * @brief [SLOT] Resample the displayed window into the rows
+     *
+     * @return void
+    */
+    void refresh();
+
+Q_SIGNALS:
+    void sourceChanged(QObject* source);
+    void deviceAddressChanged(int deviceAddress);
+    void memoryBudgetChanged(int memoryBudget);
+    void timeSpanChanged(double timeSpan);
+    void columnsChanged(int columns);
+    void updateIntervalChanged(int updateInterval);
+    void rangeChanged();
+
+private:
+    SampleHistory history;
+    std::vector<SampleHistory::Column> series;
+    int address = 0;
+    double span = 60.0;
+    int columnCount = 0;
+    double seriesMinimum = 0.0;
+    double seriesMaximum = 0.0;
+    bool samplesAdded = false;
+
+    QPointer<QObject> sampleSource;
+    QMetaObject::Connection sourceConnection;
+    QTimer updateTimer;
+};
+
+#endif // HISTORYMODEL_H
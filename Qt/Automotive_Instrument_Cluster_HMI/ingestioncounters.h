@@ -0,0 +1,127 @@
+#ifndef INGESTIONCOUNTERS_H
+#define INGESTIONCOUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Link health counters of a DeviceDataParser, written by the thread parsing and readable from any thread.
+ *
+ * There is a single writer, so the counters are bumped with a relaxed load and store rather than a locked read-modify-write:
+ * counting a frame costs a handful of plain moves, whether anything reads the counters or not.
+ * Readers (see IngestionMetrics) take a snapshot and turn the totals into rates themselves.
+*/
+class IngestionCounters
+{
+public:
+    struct Snapshot
+    {
+        uint64_t bytes = 0;
+        uint64_t frames = 0;
+        uint64_t unknownFrames = 0;
+        uint64_t resyncs = 0;
+        uint64_t lostFrames = 0;
+        uint64_t bufferOverflows = 0;
+        // Frames per device address
+        std::array<uint64_t, 256> deviceFrames = {};
+    };
+
+    // Writer side, from the parsing thread only
+
+    void addBytes(size_t size) { add(bytes, size); }
+
+    /*
+     * @brief Count a decoded frame, and the time since the previous one
+     *
+     * @param timestamp     Arrival time of the frame in nanoseconds
+     *
+     * @return void
+    */
+    void addFrame(uint8_t deviceAddress, bool knownDevice, int64_t timestamp)
+    {
+        add(frames, 1);
+        add(deviceFrames[deviceAddress], 1);
+        if(!knownDevice)
+        {
+            add(unknownFrames, 1);
+        }
+
+        const int64_t previousTimestamp = lastFrame.load(std::memory_order_relaxed);
+        if(previousTimestamp != 0 && timestamp - previousTimestamp > maxFrameGap.load(std::memory_order_relaxed))
+        {
+            maxFrameGap.store(timestamp - previousTimestamp, std::memory_order_relaxed);
+        }
+        lastFrame.store(timestamp, std::memory_order_relaxed);
+    }
+
+    /*
+     * @brief Publish the error totals of the decoders
+     *
+     * @param resyncs           Partial frames dropped to resynchronize on the next frame: bad encoding, length or checksum, or too long
+     * @param lostFrames        Frames missing from the sequence numbers
+     * @param bufferOverflows   Frames too long for the decoder buffer
+     *
+     * @return void
+    */
+    void setDecoderErrors(uint64_t resyncs, uint64_t lostFrames, uint64_t bufferOverflows)
+    {
+        decoderResyncs.store(resyncs, std::memory_order_relaxed);
+        decoderLostFrames.store(lostFrames, std::memory_order_relaxed);
+        decoderOverflows.store(bufferOverflows, std::memory_order_relaxed);
+    }
+
+    // Samples dropped after decoding, e.g. on a full SpscRingBuffer. Counted as buffer overflows
+    void addDroppedSamples(size_t count) { add(droppedSamples, count); }
+
+    // Reader side, from any thread
+
+    void read(Snapshot& snapshot) const
+    {
+        snapshot.bytes = bytes.load(std::memory_order_relaxed);
+        snapshot.frames = frames.load(std::memory_order_relaxed);
+        snapshot.unknownFrames = unknownFrames.load(std::memory_order_relaxed);
+        snapshot.resyncs = decoderResyncs.load(std::memory_order_relaxed);
+        snapshot.lostFrames = decoderLostFrames.load(std::memory_order_relaxed);
+        snapshot.bufferOverflows = decoderOverflows.load(std::memory_order_relaxed) + droppedSamples.load(std::memory_order_relaxed);
+        for(size_t i = 0; i < deviceFrames.size(); i++)
+        {
+            snapshot.deviceFrames[i] = deviceFrames[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t droppedSampleCount() const { return droppedSamples.load(std::memory_order_relaxed); }
+
+    /*
+     * @brief Longest time between two frames since the last call, in nanoseconds, and start over
+     *
+     * A gap recorded while this runs may be lost, which only matters for the single interval it falls in
+     *
+     * @return The gap, 0 if less than two frames were decoded
+    */
+    int64_t takeMaxFrameGap() const { return maxFrameGap.exchange(0, std::memory_order_relaxed); }
+
+    // Arrival time of the last frame in nanoseconds, 0 if none. With takeMaxFrameGap(), tells a link gone silent
+    int64_t lastFrameTimestamp() const { return lastFrame.load(std::memory_order_relaxed); }
+
+private:
+    static void add(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> bytes { 0 };
+    std::atomic<uint64_t> frames { 0 };
+    std::atomic<uint64_t> unknownFrames { 0 };
+    std::atomic<uint64_t> decoderResyncs { 0 };
+    std::atomic<uint64_t> decoderLostFrames { 0 };
+    std::atomic<uint64_t> decoderOverflows { 0 };
+    std::atomic<uint64_t> droppedSamples { 0 };
+    std::array<std::atomic<uint64_t>, 256> deviceFrames {};
+    // Reset by the reader, see takeMaxFrameGap()
+    mutable std::atomic<int64_t> maxFrameGap { 0 };
+    std::atomic<int64_t> lastFrame { 0 };
+};
+
+#endif // INGESTIONCOUNTERS_H
@@ -0,0 +1,121 @@
+#include "ingestionmetrics.h"
+#include <QVariantMap>
+#include "deviceprotocol.h"
+#include "devicesample.h"
+
+IngestionMetrics::IngestionMetrics(QObject* parent) : QObject(parent)
+{
+    QObject::connect(&refreshTimer, &QTimer::timeout, this, &IngestionMetrics::refresh);
+}
+
+void IngestionMetrics::setInterval(int interval)
+{
+    if(refreshInterval == interval || interval < 0)
+    {
+        return;
+    }
+
+    refreshInterval = interval;
+    if(refreshInterval > 0)
+    {
+        restartRates();
+        refreshTimer.start(refreshInterval);
+    }
+    else
+    {
+        refreshTimer.stop();
+    }
+    emit intervalChanged(interval);
+}
+
+void IngestionMetrics::setCounters(const QList<const IngestionCounters*>& counters)
+{
+    sources = counters;
+    restartRates();
+}
+
+void IngestionMetrics::refresh()
+{
+    const int64_t gap = readCounters(current);
+    const double elapsed = rateClock.nsecsElapsed() / 1e9;
+    rateClock.start();
+
+    byteRate = 0.0;
+    frameRate = 0.0;
+    deviceRates.clear();
+    frameGap = gap / 1e6;
+
+    // Totals going backwards were reset by a reopen, the rates start over from them
+    if(elapsed > 0.0 && current.bytes >= previous.bytes && current.frames >= previous.frames)
+    {
+        byteRate = (current.bytes - previous.bytes) / elapsed;
+        frameRate = (current.frames - previous.frames) / elapsed;
+
+        for(size_t address = 0; address < current.deviceFrames.size(); address++)
+        {
+            if(current.deviceFrames[address] <= previous.deviceFrames[address])
+            {
+                continue;
+            }
+
+            QString name;
+            for(const DeviceDescriptor& device : DEVICE_DESCRIPTORS)
+            {
+                if(device.address == address)
+                {
+                    name = QString::fromLatin1(device.name);
+                }
+            }
+
+            QVariantMap deviceRate;
+            deviceRate[QStringLiteral("address")] = static_cast<int>(address);
+            deviceRate[QStringLiteral("name")] = name;
+            deviceRate[QStringLiteral("framesPerSecond")] = (current.deviceFrames[address] - previous.deviceFrames[address]) / elapsed;
+            deviceRates.append(deviceRate);
+        }
+    }
+
+    previous = current;
+    emit updated();
+}
+
+int64_t IngestionMetrics::readCounters(IngestionCounters::Snapshot& snapshot) const
+{
+    snapshot = IngestionCounters::Snapshot();
+    int64_t maxGap = 0;
+    const int64_t now = DeviceSample::currentTimestamp();
+
+    IngestionCounters::Snapshot sourceSnapshot;
+    for(const IngestionCounters* counters : sources)
+    {
+        counters->read(sourceSnapshot);
+        snapshot.bytes += sourceSnapshot.bytes;
+        snapshot.frames += sourceSnapshot.frames;
+        snapshot.unknownFrames += sourceSnapshot.unknownFrames;
+        snapshot.resyncs += sourceSnapshot.resyncs;
+        snapshot.lostFrames += sourceSnapshot.lostFrames;
+        snapshot.bufferOverflows += sourceSnapshot.bufferOverflows;
+        for(size_t i = 0; i < snapshot.deviceFrames.size(); i++)
+        {
+            snapshot.deviceFrames[i] += sourceSnapshot.deviceFrames[i];
+        }
+
+        // A gap is only recorded by the frame ending it, the silence since the last frame is added here
+        int64_t gap = counters->takeMaxFrameGap();
+        const int64_t lastFrameTimestamp = counters->lastFrameTimestamp();
+        if(lastFrameTimestamp != 0)
+        {
+            gap = qMax(gap, now - lastFrameTimestamp);
+        }
+        maxGap = qMax(maxGap, gap);
+    }
+
+    return maxGap;
+}
+
+void IngestionMetrics::restartRates()
+{
+    // Only a snapshot, the metrics exposed stay as they are until the next refresh
+    readCounters(previous);
+    rateClock.start();
+}
@@ -0,0 +1,101 @@
+#ifndef INGESTIONMETRICS_H
+#define INGESTIONMETRICS_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <QVariantList>
+#include "ingestioncounters.h"
+
+/*
+ * Link health of a serial source for QML: throughput, frame rate per device and decoding errors.
+ *
+ * The IngestionCounters of the source's parsers are read every interval milliseconds on the GUI thread and turned into rates.
+ * The parsers keep counting regardless, for the cost of a few relaxed stores per frame, but nothing is read,
+ * computed nor notified while interval is 0, e.g. while the overlay showing the metrics is hidden.
+ * With several counters (one per port, see SourceManager) the totals and rates are summed and the gaps maxed.
+*/
+class IngestionMetrics : public QObject
+{
+    Q_OBJECT
+    // Refresh period of the metrics in milliseconds, 0 to stop refreshing
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    // Rates over the last interval
+    Q_PROPERTY(double bytesPerSecond READ bytesPerSecond NOTIFY updated)
+    Q_PROPERTY(double framesPerSecond READ framesPerSecond NOTIFY updated)
+    // One map per device address received during the last interval, ordered by address: address, name (empty if unknown) and framesPerSecond
+    Q_PROPERTY(QVariantList deviceFrameRates READ deviceFrameRates NOTIFY updated)
+    // Longest time without any frame during the last interval, including the current silence, in milliseconds
+    Q_PROPERTY(double maxFrameGap READ maxFrameGap NOTIFY updated)
+    // Totals since the ports were opened
+    // Partial frames dropped to resynchronize on the next frame: bad encoding, length or checksum, or too long
+    Q_PROPERTY(qint64 resyncs READ resyncs NOTIFY updated)
+    // Frames missing from the sequence numbers, only counted by FRAME_PROTOCOL_V2
+    Q_PROPERTY(qint64 lostFrames READ lostFrames NOTIFY updated)
+    // Frames from device addresses missing from DEVICE_PROTOCOL_DEVICES
+    Q_PROPERTY(qint64 unknownFrames READ unknownFrames NOTIFY updated)
+    // Frames too long for the decoder buffer, and samples dropped on a full ring
+    Q_PROPERTY(qint64 bufferOverflows READ bufferOverflows NOTIFY updated)
+
+public:
+    IngestionMetrics(QObject* parent = nullptr);
+
+    int interval() const { return refreshInterval; }
+    void setInterval(int interval);
+
+    /*
+     * @brief Set the counters read, none to clear them. The counters must outlive this object or be cleared first
+     *
+     * The rates start over from the next refresh
+     *
+     * @return void
+    */
+    void setCounters(const QList<const IngestionCounters*>& counters);
+
+    double bytesPerSecond() const { return byteRate; }
+    double framesPerSecond() const { return frameRate; }
+    QVariantList deviceFrameRates() const { return deviceRates; }
+    double maxFrameGap() const { return frameGap; }
+    qint64 resyncs() const { return static_cast<qint64>(current.resyncs); }
+    qint64 lostFrames() const { return static_cast<qint64>(current.lostFrames); }
+    qint64 unknownFrames() const { return static_cast<qint64>(current.unknownFrames); }
+    qint64 bufferOverflows() const { return static_cast<qint64>(current.bufferOverflows); }
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Read the counters and update the metrics, emitting [SIGNAL] updated(). Connected to the refresh timer
+     *
+     * @return void
+    */
+    void refresh();
+
+Q_SIGNALS:
+    void intervalChanged(int interval);
+    void updated();
+
+private:
+    // Sum of all the counters, and the longest gap among them in nanoseconds
+    int64_t readCounters(IngestionCounters::Snapshot& snapshot) const;
+
+    /*
+     * @brief Take the current totals as the starting point of the next rates
+     *
+     * @return void
+    */
+    void restartRates();
+
+    QList<const IngestionCounters*> sources;
+    int refreshInterval = 0;
+    QTimer refreshTimer;
+    QElapsedTimer rateClock;
+
+    IngestionCounters::Snapshot previous;
+    IngestionCounters::Snapshot current;
+    double byteRate = 0.0;
+    double frameRate = 0.0;
+    QVariantList deviceRates;
+    double frameGap = 0.0;
+};
+
+#endif // INGESTIONMETRICS_H
@@ -0,0 +1,91 @@
+#include "latencyhistogram.h"
+#include <cmath>
+
+void LatencyHistogram::record(int64_t valueNs)
+{
+    const int64_t value = valueNs < 0 ? 0 : (valueNs > MAX_VALUE ? MAX_VALUE : valueNs);
+
+    counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    totalSum.fetch_add(static_cast<uint64_t>(value), std::memory_order_relaxed);
+
+    // Single recording thread, no compare and swap needed
+    if(!count() || value < minValue.load(std::memory_order_relaxed))
+    {
+        minValue.store(value, std::memory_order_relaxed);
+    }
+    if(value > maxValue.load(std::memory_order_relaxed))
+    {
+        maxValue.store(value, std::memory_order_relaxed);
+    }
+
+    totalCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset()
+{
+    for(std::atomic<uint64_t>& count : counts)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+    totalCount.store(0, std::memory_order_relaxed);
+    totalSum.store(0, std::memory_order_relaxed);
+    minValue.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::valueAtPercentile(double percentile) const
+{
+    const uint64_t total = count();
+    if(!total)
+    {
+        return 0;
+    }
+
+    const double clampedPercentile = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+    uint64_t targetCount = static_cast<uint64_t>(std::ceil(clampedPercentile / 100.0 * double(total)));
+    if(targetCount == 0)
+    {
+        targetCount = 1;
+    }
+
+    uint64_t cumulativeCount = 0;
+    for(size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        cumulativeCount += counts[i].load(std::memory_order_relaxed);
+        if(cumulativeCount >= targetCount)
+        {
+            const int64_t value = highestEquivalentValue(i);
+            return value < max() ? value : max();
+        }
+    }
+
+    return max();
+}
+
+size_t LatencyHistogram::bucketIndex(int64_t value)
+{
+    if(value < int64_t(SUB_BUCKET_COUNT))
+    {
+        return static_cast<size_t>(value);
+    }
+
+    // Keep the SUB_BUCKET_BITS most significant bits of the value, the top one always set
+    const int highestBit = 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+    const int shift = highestBit - (SUB_BUCKET_BITS - 1);
+    const size_t subBucket = static_cast<size_t>(value >> shift) - SUB_BUCKET_HALF_COUNT;
+
+    return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF_COUNT + subBucket;
+}
+
+int64_t LatencyHistogram::highestEquivalentValue(size_t index)
+{
+    if(index < SUB_BUCKET_COUNT)
+    {
+        return static_cast<int64_t>(index);
+    }
+
+    const int shift = static_cast<int>((index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF_COUNT) + 1;
+    const int64_t subBucket = static_cast<int64_t>((index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF_COUNT + SUB_BUCKET_HALF_COUNT);
+
+    return ((subBucket + 1) << shift) - 1;
+}
@@ -0,0 +1,70 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * HDR style histogram of latencies in nanoseconds.
+ *
+ * Buckets are log-linear: exact below SUB_BUCKET_COUNT, then SUB_BUCKET_COUNT / 2 linear sub-buckets per power of two,
+ * so any recorded value is kept with a relative error below 1% up to MAX_VALUE, with a fixed memory footprint and no allocation.
+ *
+ * A single thread records, any thread may read. The counters are atomic, so a read while recording is a close approximation.
+*/
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 8;
+    static constexpr int MAX_VALUE_BITS = 36;
+    // Larger values (~68.7 s) are recorded as MAX_VALUE
+    static constexpr int64_t MAX_VALUE = (int64_t(1) << MAX_VALUE_BITS) - 1;
+
+    LatencyHistogram() { reset(); }
+
+    /*
+     * @brief Record a latency, negative values are recorded as 0
+     *
+     * @return void
+    */
+    void record(int64_t valueNs);
+
+    /*
+     * @brief Forget all the recorded values
+     *
+     * @return void
+    */
+    void reset();
+
+    uint64_t count() const { return totalCount.load(std::memory_order_relaxed); }
+    int64_t min() const { return count() ? minValue.load(std::memory_order_relaxed) : 0; }
+    int64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    double mean() const { return count() ? double(totalSum.load(std::memory_order_relaxed)) / count() : 0.0; }
+
+    /*
+     * @brief Value below or equal to which the given percentage of the recorded values are
+     *
+     * @param percentile    In [0, 100]
+     *
+     * @return The highest value equivalent to the percentile bucket, 0 if nothing is recorded
+    */
+    int64_t valueAtPercentile(double percentile) const;
+
+private:
+    static constexpr size_t SUB_BUCKET_COUNT = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKET_HALF_COUNT;
+
+    static size_t bucketIndex(int64_t value);
+    static int64_t highestEquivalentValue(size_t index);
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts;
+    std::atomic<uint64_t> totalCount;
+    std::atomic<uint64_t> totalSum;
+    std::atomic<int64_t> minValue;
+    std::atomic<int64_t> maxValue;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,245 @@
+#include "latencyprobe.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+
+namespace
+{
+const char* const STAGE_NAMES[] = { "total", "receivedToDecoded", "decodedToPublished", "publishedToSwapped" };
+const double DUMP_PERCENTILES[] = { 0.0, 50.0, 75.0, 90.0, 95.0, 99.0, 99.9, 99.99, 100.0 };
+}
+
+LatencyProbe::LatencyProbe(QObject* parent) : QObject(parent)
+{
+    updateTimer.setInterval(1000);
+    QObject::connect(&updateTimer, &QTimer::timeout, this, [this]()
+    {
+        // Only notify when frames were recorded since the last refresh
+        const quint64 frameCount = histograms[STAGE_TOTAL].count();
+        if(frameCount != reportedFrameCount)
+        {
+            reportedFrameCount = frameCount;
+            emit histogramChanged();
+        }
+    });
+    if(QCoreApplication::instance())
+    {
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &LatencyProbe::dumpOnExit);
+    }
+}
+
+void LatencyProbe::setEnabled(bool enabled)
+{
+    if(probing != enabled)
+    {
+        probing = enabled;
+        updateConnections();
+        emit enabledChanged(enabled);
+    }
+}
+
+void LatencyProbe::setClusterState(ClusterState* clusterState)
+{
+    if(state != clusterState)
+    {
+        state = clusterState;
+        updateConnections();
+        emit clusterStateChanged(clusterState);
+    }
+}
+
+void LatencyProbe::setWindow(QQuickWindow* window)
+{
+    if(probedWindow != window)
+    {
+        probedWindow = window;
+        updateConnections();
+        emit windowChanged(window);
+    }
+}
+
+void LatencyProbe::setBudget(double budget)
+{
+    const qint64 newBudgetNs = static_cast<qint64>(budget * 1e6);
+    if(budgetNs != newBudgetNs)
+    {
+        budgetNs = newBudgetNs;
+        emit budgetChanged(budget);
+    }
+}
+
+void LatencyProbe::setUpdateInterval(int updateInterval)
+{
+    if(updateTimer.interval() != updateInterval && updateInterval > 0)
+    {
+        updateTimer.setInterval(updateInterval);
+        emit updateIntervalChanged(updateInterval);
+    }
+}
+
+void LatencyProbe::setDumpFile(const QString& dumpFile)
+{
+    if(dumpFilePath != dumpFile)
+    {
+        dumpFilePath = dumpFile;
+        emit dumpFileChanged(dumpFile);
+    }
+}
+
+QVariantMap LatencyProbe::histogram() const
+{
+    QVariantMap stages;
+    for(int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        const LatencyHistogram& stageHistogram = histograms[stage];
+        QVariantMap summary;
+        summary[QStringLiteral("count")] = static_cast<double>(stageHistogram.count());
+        summary[QStringLiteral("min")] = stageHistogram.min() / 1e6;
+        summary[QStringLiteral("mean")] = stageHistogram.mean() / 1e6;
+        summary[QStringLiteral("p50")] = stageHistogram.valueAtPercentile(50.0) / 1e6;
+        summary[QStringLiteral("p90")] = stageHistogram.valueAtPercentile(90.0) / 1e6;
+        summary[QStringLiteral("p99")] = stageHistogram.valueAtPercentile(99.0) / 1e6;
+        summary[QStringLiteral("p99.9")] = stageHistogram.valueAtPercentile(99.9) / 1e6;
+        summary[QStringLiteral("max")] = stageHistogram.max() / 1e6;
+        stages[QLatin1String(STAGE_NAMES[stage])] = summary;
+    }
+    return stages;
+}
+
+void LatencyProbe::reset()
+{
+    for(LatencyHistogram& stageHistogram : histograms)
+    {
+        stageHistogram.reset();
+    }
+    overBudgetCount.store(0, std::memory_order_relaxed);
+    reportedFrameCount = 0;
+    emit histogramChanged();
+}
+
+QString LatencyProbe::dump() const
+{
+    QString text;
+    QTextStream stream(&text);
+    stream.setRealNumberNotation(QTextStream::FixedNotation);
+    stream.setRealNumberPrecision(3);
+
+    stream << "# Latency in milliseconds, " << histograms[STAGE_TOTAL].count() << " frames";
+    if(budgetNs > 0)
+    {
+        stream << ", " << overBudgetFrames() << " over the " << budget() << " ms budget";
+    }
+    stream << "\n# Percentile";
+    for(const char* stageName : STAGE_NAMES)
+    {
+        stream << '\t' << stageName;
+    }
+    stream << '\n';
+
+    for(const double percentile : DUMP_PERCENTILES)
+    {
+        stream << percentile;
+        for(const LatencyHistogram& stageHistogram : histograms)
+        {
+            stream << '\t' << stageHistogram.valueAtPercentile(percentile) / 1e6;
+        }
+        stream << '\n';
+    }
+
+    stream << "# Mean";
+    for(const LatencyHistogram& stageHistogram : histograms)
+    {
+        stream << '\t' << stageHistogram.mean() / 1e6;
+    }
+    stream << '\n';
+
+    return text;
+}
+
+void LatencyProbe::updateConnections()
+{
+    for(const QMetaObject::Connection& connection : std::as_const(connections))
+    {
+        QObject::disconnect(connection);
+    }
+    connections.clear();
+    hasPublishedFrame = false;
+    hasSynchronizedFrame = false;
+    updateTimer.stop();
+
+    if(!probing || !state || !probedWindow)
+    {
+        return;
+    }
+
+    connections << QObject::connect(state, &ClusterState::valuesPublished, this, &LatencyProbe::onValuesPublished);
+    // Direct connections, the probe points must be timed on the thread emitting them
+    connections << QObject::connect(probedWindow, &QQuickWindow::beforeSynchronizing, this, &LatencyProbe::onBeforeSynchronizing, Qt::DirectConnection);
+    connections << QObject::connect(probedWindow, &QQuickWindow::frameSwapped, this, &LatencyProbe::onFrameSwapped, Qt::DirectConnection);
+    updateTimer.start();
+}
+
+void LatencyProbe::onValuesPublished(qint64 receivedTimestamp, qint64 decodedTimestamp)
+{
+    publishedFrame.received = receivedTimestamp;
+    publishedFrame.decoded = decodedTimestamp;
+    publishedFrame.published = DeviceSample::currentTimestamp();
+    hasPublishedFrame = true;
+}
+
+void LatencyProbe::onBeforeSynchronizing()
+{
+    // The values published so far make it into this frame
+    if(hasPublishedFrame)
+    {
+        synchronizedFrame = publishedFrame;
+        hasSynchronizedFrame = true;
+        hasPublishedFrame = false;
+    }
+}
+
+void LatencyProbe::onFrameSwapped()
+{
+    if(!hasSynchronizedFrame)
+    {
+        return;
+    }
+    hasSynchronizedFrame = false;
+
+    const qint64 swapped = DeviceSample::currentTimestamp();
+    const qint64 total = swapped - synchronizedFrame.received;
+
+    histograms[STAGE_TOTAL].record(total);
+    histograms[STAGE_RECEIVED_TO_DECODED].record(synchronizedFrame.decoded - synchronizedFrame.received);
+    histograms[STAGE_DECODED_TO_PUBLISHED].record(synchronizedFrame.published - synchronizedFrame.decoded);
+    histograms[STAGE_PUBLISHED_TO_SWAPPED].record(swapped - synchronizedFrame.published);
+
+    if(budgetNs > 0 && total > budgetNs)
+    {
+        overBudgetCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LatencyProbe::dumpOnExit()
+{
+    if(!probing)
+    {
+        return;
+    }
+
+    if(dumpFilePath.isEmpty())
+    {
+        qInfo().noquote() << dump();
+        return;
+    }
+
+    QFile file(dumpFilePath);
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        file.write(dump().toUtf8());
+    }
+    else
+    {
+        qWarning("LatencyProbe: can't write %s", qPrintable(dumpFilePath));
+    }
+}
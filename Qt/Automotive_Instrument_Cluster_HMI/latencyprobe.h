@@ -0,0 +1,149 @@
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QString>
+#include <QTimer>
+#include <QVariantMap>
+#include <atomic>
+#include "clusterstate.h"
+#include "latencyhistogram.h"
+
+/*
+ * End to end latency of the displayed values, from the serial bytes arrival to the frame showing them on screen.
+ *
+ * Every displayed frame that carries new values is timed at four probe points:
+ *  - received:     the bytes completing the newest published sample were read, see DeviceSample::timestamp()
+ *  - decoded:      that sample was decoded, see DeviceSample::decodedTimestamp() (needs latencyProbes on the serial source)
+ *  - published:    ClusterState published the values to QML, see [SIGNAL] ClusterState::valuesPublished()
+ *  - swapped:      the first frame synchronized after the publish was swapped, see [SIGNAL] QQuickWindow::frameSwapped()
+ *
+ * Each stage and the total go into a LatencyHistogram. The frames are recorded on the render thread,
+ * the summary exposed to QML is refreshed every updateInterval milliseconds on the GUI thread.
+ * When enabled, the percentile distribution is dumped to dumpFile (or the log) when the application quits.
+*/
+class LatencyProbe : public QObject
+{
+    Q_OBJECT
+    // Nothing is connected nor recorded while disabled
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(ClusterState* clusterState READ clusterState WRITE setClusterState NOTIFY clusterStateChanged)
+    // Window displaying the values
+    Q_PROPERTY(QQuickWindow* window READ window WRITE setWindow NOTIFY windowChanged)
+    // Latency budget from the bytes arrival to the frame swap in milliseconds, 0 for none
+    Q_PROPERTY(double budget READ budget WRITE setBudget NOTIFY budgetChanged)
+    // Refresh period of histogram and overBudgetFrames in milliseconds
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged)
+    // Dump the percentile distribution to this file on exit, to the log if empty
+    Q_PROPERTY(QString dumpFile READ dumpFile WRITE setDumpFile NOTIFY dumpFileChanged)
+    /*
+     * Summary per stage in milliseconds, keyed "total", "receivedToDecoded", "decodedToPublished" and "publishedToSwapped".
+     * Each is a map of count, min, mean, p50, p90, p99, p99.9 and max
+    */
+    Q_PROPERTY(QVariantMap histogram READ histogram NOTIFY histogramChanged)
+    // Frames over the latency budget
+    Q_PROPERTY(int overBudgetFrames READ overBudgetFrames NOTIFY histogramChanged)
+
+public:
+    LatencyProbe(QObject* parent = nullptr);
+
+    bool enabled() const { return probing; }
+    void setEnabled(bool enabled);
+
+    ClusterState* clusterState() const { return state; }
+    void setClusterState(ClusterState* clusterState);
+
+    QQuickWindow* window() const { return probedWindow; }
+    void setWindow(QQuickWindow* window);
+
+    double budget() const { return budgetNs / 1e6; }
+    void setBudget(double budget);
+
+    int updateInterval() const { return updateTimer.interval(); }
+    void setUpdateInterval(int updateInterval);
+
+    QString dumpFile() const { return dumpFilePath; }
+    void setDumpFile(const QString& dumpFile);
+
+    QVariantMap histogram() const;
+    int overBudgetFrames() const { return static_cast<int>(overBudgetCount.load(std::memory_order_relaxed)); }
+
+    /*
+     * @brief Forget all the recorded frames
+     *
+     * @return void
+    */
+    Q_INVOKABLE void reset();
+
+    /*
+     * @brief Percentile distribution of every stage, as text
+     *
+     * @return The distribution, one line per percentile and stage
+    */
+    Q_INVOKABLE QString dump() const;
+
+Q_SIGNALS:
+    void enabledChanged(bool enabled);
+    void clusterStateChanged(ClusterState* clusterState);
+    void windowChanged(QQuickWindow* window);
+    void budgetChanged(double budget);
+    void updateIntervalChanged(int updateInterval);
+    void dumpFileChanged(QString dumpFile);
+    void histogramChanged();
+
+private:
+    struct FrameTimestamps
+    {
+        qint64 received = 0;
+        qint64 decoded = 0;
+        qint64 published = 0;
+    };
+
+    enum Stage
+    {
+        STAGE_TOTAL,
+        STAGE_RECEIVED_TO_DECODED,
+        STAGE_DECODED_TO_PUBLISHED,
+        STAGE_PUBLISHED_TO_SWAPPED,
+        STAGE_COUNT
+    };
+
+    /*
+     * @brief Connect the probe points if enabled, disconnect them otherwise
+     *
+     * @return void
+    */
+    void updateConnections();
+
+    // [SLOT] GUI thread, connected to [SIGNAL] ClusterState::valuesPublished()
+    void onValuesPublished(qint64 receivedTimestamp, qint64 decodedTimestamp);
+    // [SLOT] Render thread with the GUI thread blocked, connected to [SIGNAL] QQuickWindow::beforeSynchronizing()
+    void onBeforeSynchronizing();
+    // [SLOT] Render thread, connected to [SIGNAL] QQuickWindow::frameSwapped()
+    void onFrameSwapped();
+    // [SLOT] Connected to [SIGNAL] QCoreApplication::aboutToQuit()
+    void dumpOnExit();
+
+    bool probing = false;
+    QPointer<ClusterState> state;
+    QPointer<QQuickWindow> probedWindow;
+    QList<QMetaObject::Connection> connections;
+    qint64 budgetNs = 0;
+    QString dumpFilePath;
+    QTimer updateTimer;
+
+    // Published values waiting for the next synchronization, only touched on the GUI thread or while it is blocked
+    FrameTimestamps publishedFrame;
+    bool hasPublishedFrame = false;
+    // Values synchronized into the scene graph, waiting for their frame swap, only touched on the render thread
+    FrameTimestamps synchronizedFrame;
+    bool hasSynchronizedFrame = false;
+
+    LatencyHistogram histograms[STAGE_COUNT];
+    std::atomic<quint64> overBudgetCount { 0 };
+    quint64 reportedFrameCount = 0;
+};
+
+#endif // LATENCYPROBE_H
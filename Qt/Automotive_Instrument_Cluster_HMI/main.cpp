@@ -1,9 +1,51 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
+#include <cstring>
+#include "capturereplay.h"
+#include "clusterstate.h"
+#include "drivelogger.h"
+#include "filterstage.h"
+#include "headlessingestion.h"
+#include "historymodel.h"
+#include "ingestionmetrics.h"
+#include "latencyprobe.h"
+#include "portmanager.h"
 #include "serial.h"
+#include "sharedstatepublisher.h"
+#include "sourcemanager.h"
+#include "speedometergauge.h"
+#include "threadedserial.h"
+
+/*
+ * @brief Run the ingestion alone on a QCoreApplication, without QML nor a display, see HeadlessIngestion
+ *
+ * @return Process exit code
+*/
+static int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    qRegisterMetaType<DeviceSample>();
+
+    HeadlessIngestion ingestion;
+    if(!ingestion.start(app.arguments()))
+    {
+        return 1;
+    }
+
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    // Checked before any application object is created, a QGuiApplication needs a display
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--headless") == 0)
+        {
+            return runHeadless(argc, argv);
+        }
+    }
+
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 #endif
@@ -11,6 +53,21 @@ int main(int argc, char *argv[])
 
     // Export Serial class to the QML side
     qmlRegisterType<Serial>("Serial", 1, 0, "Serial");
+    qmlRegisterType<ThreadedSerial>("Serial", 1, 0, "ThreadedSerial");
+    qmlRegisterType<CaptureReplay>("Serial", 1, 0, "CaptureReplay");
+    qmlRegisterType<SourceManager>("Serial", 1, 0, "SourceManager");
+    qmlRegisterType<PortManager>("Serial", 1, 0, "PortManager");
+    qmlRegisterType<DriveLogger>("Serial", 1, 0, "DriveLogger");
+    qmlRegisterUncreatableType<IngestionMetrics>("Serial", 1, 0, "IngestionMetrics", QStringLiteral("IngestionMetrics is the metrics property of a serial source"));
+    // Export ClusterState class to the QML side
+    qmlRegisterType<ClusterState>("Cluster", 1, 0, "ClusterState");
+    qmlRegisterType<LatencyProbe>("Cluster", 1, 0, "LatencyProbe");
+    qmlRegisterType<FilterStage>("Cluster", 1, 0, "FilterStage");
+    qmlRegisterType<SharedStatePublisher>("Cluster", 1, 0, "SharedStatePublisher");
+    qmlRegisterType<HistoryModel>("Cluster", 1, 0, "HistoryModel");
+    qmlRegisterType<SpeedometerGauge>("Cluster", 1, 0, "SpeedometerGauge");
+    // DeviceSample is passed by value through signals, including queued connections
+    qRegisterMetaType<DeviceSample>();
 
     QQmlApplicationEngine engine;
     const QUrl url(QStringLiteral("qrc:/main.qml"));
@@ -1,6 +1,7 @@
 import QtQuick 2.15
 import QtQuick.Window 2.15
 import Serial
+import Cluster
 
 Window
 {
@@ -11,77 +12,93 @@ Window
     title: "Automotive Instrument Cluster HMI"
     color: "black"
 
-    Rectangle
+    // Fills from the top and bottom edges as the speed rises, only its fill vertices change with the speed
+    SpeedometerGauge
     {
-        property real velocity: 0
-        readonly property double fillPosition: 0.3
-        readonly property int maxSpeed: 180
         id: speedometer
         width: 300
         height: 300
-        radius: width * 0.5      // Half the width (or height). As a circle is width = height and radius is half of that
-        antialiasing: true
         anchors.centerIn: parent
-        color: "transparent"
-        border.color: "lightgreen"
-        border.width: 5
-        gradient: Gradient
-                  {
-                    /**
-                      * The (+/-)0.0001 to ensure the color gradiant has the min value when (speed.speedValue = 0),
-                      * otherwise this GradientStop mostly would be ignored and give incorrect result
-                     */
-                    GradientStop { position: 0.0; color: speedometer.border.color }
-                    GradientStop { position: ((speed.speedValue * speedometer.fillPosition) / speedometer.maxSpeed) + 0.0001; color: "black" }
-                    GradientStop { position: (1.0 - ((speed.speedValue * speedometer.fillPosition) / speedometer.maxSpeed)) - 0.0001; color: "black" }
-                    GradientStop { position: 1.0; color: speedometer.border.color }
-                  }
-
-        Serial
+        value: speed.speedValue
+        maxValue: 180
+        fillPosition: 0.3
+        color: "lightgreen"
+        interiorColor: "black"
+        borderWidth: 5
+
+        // Reads and parses the ports on I/O threads, their samples are merged in arrival order once per frame of this window
+        SourceManager
         {
-            property real accelerometer: 0
             id: serial
-            baudRate: Serial.Baud4800
-            dataBits: Serial.Data8
-            parity: Serial.NoParity
-            stopBits: Serial.OneStop
-            portName:"COM1"
-            openMode: 0x0001 | 0x0002  // Open in ReadWrite mode
-            onDeviceDataAvailable:
-                function (device)
-                {
-                    var deviceAddress = device[0]
-                    var deviceData = device[1]
-
-                    if(deviceAddress === Serial.DEVICE_INTERNAL_ADDRESS_ACCELEROMETER)
-                    {
-                        // Set the data
-                        accelerometer = deviceData
-                    }
-                }
+            window: window
+            latencyProbes: latencyProbe.enabled
+            // Read the link counters only while they are shown
+            metrics.interval: metricsOverlay.visible ? 500 : 0
         }
 
-        Timer {
-            id: timer
-            interval: 1000 // Update every 1 second
-            repeat: true
-            running: true
+        // Finds the port and baud rate of the HMI node in the background, and reconnects the source whenever the port is lost
+        PortManager
+        {
+            id: portManager
+            source: serial
+            preferredPorts: ["COM1"]
+            active: true
+        }
 
-            onTriggered:
-            {
-                // Convert (G)s to (km/h)/s
-                var KMHPerS = serial.accelerometer * 35.30394
+        // Smooths the accelerometer ADC noise before it's integrated into the speed, and the temperature jitter
+        FilterStage
+        {
+            id: filteredSerial
+            source: serial
+            filters: ({
+                "ACCELEROMETER": { "lowPass": "biquad", "cutoffFrequency": 5, "sampleRate": 100, "kalman": true, "processNoise": 0.05, "measurementNoise": 0.01 },
+                "LM35": { "lowPass": "exponential", "cutoffFrequency": 0.5, "sampleRate": 100 }
+            })
+        }
 
-                // Update the current velocity while keeping the max (speed) to speedometer.maxSpeed, if exceeded we just ignore the accelerometer value
-                // Set a cap for min/max velocity to -speedometer.maxSpeed/speedometer.maxSpeed for both directions of the velocity
-                speedometer.velocity = speedometer.velocity >= 0 ? Math.min(speedometer.maxSpeed, speedometer.velocity + KMHPerS) : Math.max(-speedometer.maxSpeed, speedometer.velocity + KMHPerS)
-            }
+        // Latest gauge values, published once per frame of this window
+        ClusterState
+        {
+            id: clusterState
+            source: filteredSerial
+            window: window
+            maxSpeed: speedometer.maxValue
+        }
+
+        // Latest values and recent raw samples for other processes, see SharedStateReader. Enabled with the --shared-state command line argument
+        SharedStatePublisher
+        {
+            id: sharedState
+            active: Qt.application.arguments.indexOf("--shared-state") !== -1
+            clusterState: clusterState
+            source: serial
+        }
+
+        // Raw samples of the whole drive, see DriveLogReader and tools/drivelog. Enabled with the --drive-log <file> command line argument
+        DriveLogger
+        {
+            id: driveLogger
+            readonly property int argumentIndex: Qt.application.arguments.indexOf("--drive-log")
+            filePath: argumentIndex !== -1 && argumentIndex + 1 < Qt.application.arguments.length ? Qt.application.arguments[argumentIndex + 1] : ""
+            active: filePath !== ""
+            source: serial
+            quanta: ({ "LM35": 0.01, "ACCELEROMETER": 0.001 })
+        }
+
+        // Bytes arrival to frame swap latency of the gauges, enabled with the --latency-probes command line argument
+        LatencyProbe
+        {
+            id: latencyProbe
+            enabled: Qt.application.arguments.indexOf("--latency-probes") !== -1
+            clusterState: clusterState
+            window: window
+            budget: 50
         }
 
         Text
         {
-            // Convert the velocity to speed (get the absolute value) and round the result to int
-            property int speedValue: Math.abs(speedometer.velocity)
+            // Round the speed to int
+            property int speedValue: clusterState.speed
             id: speed
             anchors.top: parent.top
             anchors.topMargin: 70
@@ -91,9 +108,10 @@ Window
             font.pixelSize: 80
             antialiasing: true
 
+            // Short smoothing only, the speed is already integrated at the full sample rate
             Behavior on speedValue
             {
-                NumberAnimation { duration: 1000 }
+                NumberAnimation { duration: 100 }
             }
 
             Text
@@ -103,11 +121,62 @@ Window
                 anchors.topMargin: 100
                 anchors.horizontalCenter: parent.horizontalCenter
                 text: "Km/h"
-                color: speedometer.border.color
+                color: speedometer.color
                 font.pixelSize: 30
                 font.bold: true
                 antialiasing: true
             }
         }
     }
+
+    // Connection status, hidden while the node is connected
+    Text
+    {
+        id: connectionStatus
+        anchors.bottom: parent.bottom
+        anchors.bottomMargin: 10
+        anchors.horizontalCenter: parent.horizontalCenter
+        visible: portManager.state !== PortManager.STATE_CONNECTED
+        text: portManager.state === PortManager.STATE_SCANNING ? "Searching for the HMI node..."
+            : portManager.state === PortManager.STATE_CONNECTING ? "Connecting to " + portManager.portName + "..."
+            : portManager.state === PortManager.STATE_WAITING ? portManager.errorString + ", retrying in " + (portManager.backoff / 1000).toFixed(1) + " s"
+            : ""
+        color: "gray"
+        font.pixelSize: 14
+    }
+
+    // Link health of the serial source, shown with the --metrics command line argument and toggled with F3
+    Text
+    {
+        id: metricsOverlay
+        anchors.top: parent.top
+        anchors.left: parent.left
+        anchors.margins: 8
+        visible: Qt.application.arguments.indexOf("--metrics") !== -1
+        // A single plain text node, laid out again only when the metrics refresh
+        textFormat: Text.PlainText
+        text: visible ? describe(serial.metrics) : ""
+        color: "gray"
+        font.family: "monospace"
+        font.pixelSize: 12
+
+        function describe(metrics)
+        {
+            var lines = [(metrics.bytesPerSecond / 1000).toFixed(1) + " kB/s  " + metrics.framesPerSecond.toFixed(0) + " frames/s  max gap " + metrics.maxFrameGap.toFixed(0) + " ms"]
+            var deviceRates = metrics.deviceFrameRates
+            for(var i = 0; i < deviceRates.length; i++)
+            {
+                var name = deviceRates[i].name !== "" ? deviceRates[i].name : "0x" + deviceRates[i].address.toString(16)
+                lines.push(name + "  " + deviceRates[i].framesPerSecond.toFixed(0) + " frames/s")
+            }
+            lines.push("resyncs " + metrics.resyncs + "  lost " + metrics.lostFrames + "  unknown " + metrics.unknownFrames + "  overflows " + metrics.bufferOverflows)
+            return lines.join("\n")
+        }
+    }
+
+    Shortcut
+    {
+        sequence: "F3"
+        onActivated: metricsOverlay.visible = !metricsOverlay.visible
+    }
 }
@@ -0,0 +1,338 @@
+#include "portmanager.h"
+#include "portprober.h"
+
+// A connection must stay up this long before the backoff is reset, so a port that keeps dropping right after it opens still backs off, in milliseconds
+#define STABLE_CONNECTION_TIME 5000
+
+PortManager::PortManager(QObject* parent) : QObject(parent)
+{
+    candidateBaudRates = { QSerialPort::Baud4800, QSerialPort::Baud9600, QSerialPort::Baud19200,
+                           QSerialPort::Baud38400, QSerialPort::Baud57600, QSerialPort::Baud115200 };
+
+    backoffTimer.setSingleShot(true);
+    QObject::connect(&backoffTimer, &QTimer::timeout, this, &PortManager::startScan);
+
+    stableTimer.setSingleShot(true);
+    stableTimer.setInterval(STABLE_CONNECTION_TIME);
+    QObject::connect(&stableTimer, &QTimer::timeout, this, [this]()
+    {
+        failureCount = 0;
+        backoffInterval = 0;
+        emit stateChanged(connectionState);
+    });
+
+    prober = new PortProber();
+    prober->moveToThread(&proberThread);
+    QObject::connect(prober, &PortProber::portsEnumerated, this, [this](const QStringList& enumeratedPorts)
+    {
+        if(portNames != enumeratedPorts)
+        {
+            portNames = enumeratedPorts;
+            emit availablePortsChanged(portNames);
+        }
+    });
+    QObject::connect(prober, &PortProber::portFound, this, &PortManager::onPortFound);
+    QObject::connect(prober, &PortProber::portNotFound, this, &PortManager::onPortNotFound);
+    proberThread.setObjectName(QStringLiteral("PortProber"));
+    proberThread.start();
+}
+
+PortManager::~PortManager()
+{
+    stop();
+
+    // A probe in progress returns within probeTime once cancelled
+    proberThread.quit();
+    proberThread.wait();
+    delete prober;
+}
+
+void PortManager::setSource(SourceManager* source)
+{
+    if(sourceManager == source)
+    {
+        return;
+    }
+
+    stop();
+    for(const QMetaObject::Connection& connection : sourceConnections)
+    {
+        QObject::disconnect(connection);
+    }
+    sourceConnections.clear();
+
+    sourceManager = source;
+    if(sourceManager)
+    {
+        // Queued, as the handlers stop the source and must not do so from within its own signals
+        sourceConnections.append(QObject::connect(sourceManager, &SourceManager::openPortsChanged, this, &PortManager::onOpenPortsChanged, Qt::QueuedConnection));
+        sourceConnections.append(QObject::connect(sourceManager, &SourceManager::errorOccurred, this, &PortManager::onSourceError, Qt::QueuedConnection));
+        sourceConnections.append(QObject::connect(sourceManager, &SourceManager::statisticsChanged, this, &PortManager::onSourceStatistics, Qt::QueuedConnection));
+    }
+    emit sourceChanged(source);
+
+    restart();
+}
+
+void PortManager::setPreferredPorts(const QStringList& preferredPorts)
+{
+    if(preferred != preferredPorts)
+    {
+        preferred = preferredPorts;
+        emit preferredPortsChanged(preferredPorts);
+    }
+}
+
+QVariantList PortManager::baudRates() const
+{
+    QVariantList rates;
+    for(qint32 rate : candidateBaudRates)
+    {
+        rates.append(rate);
+    }
+    return rates;
+}
+
+void PortManager::setBaudRates(const QVariantList& baudRates)
+{
+    QList<qint32> rates;
+    for(const QVariant& rate : baudRates)
+    {
+        if(rate.toInt() > 0)
+        {
+            rates.append(rate.toInt());
+        }
+    }
+
+    if(candidateBaudRates != rates)
+    {
+        candidateBaudRates = rates;
+        emit baudRatesChanged();
+    }
+}
+
+void PortManager::setProbeTime(int probeTime)
+{
+    if(probeDuration != probeTime && probeTime > 0)
+    {
+        probeDuration = probeTime;
+        emit probeTimeChanged(probeTime);
+    }
+}
+
+void PortManager::setMinimumBackoff(int minimumBackoff)
+{
+    if(minimumBackoffInterval != minimumBackoff && minimumBackoff > 0)
+    {
+        minimumBackoffInterval = minimumBackoff;
+        emit minimumBackoffChanged(minimumBackoff);
+    }
+}
+
+void PortManager::setMaximumBackoff(int maximumBackoff)
+{
+    if(maximumBackoffInterval != maximumBackoff && maximumBackoff > 0)
+    {
+        maximumBackoffInterval = maximumBackoff;
+        emit maximumBackoffChanged(maximumBackoff);
+    }
+}
+
+void PortManager::setSilenceTimeout(int silenceTimeout)
+{
+    if(silenceTimeoutInterval != silenceTimeout && silenceTimeout >= 0)
+    {
+        silenceTimeoutInterval = silenceTimeout;
+        emit silenceTimeoutChanged(silenceTimeout);
+    }
+}
+
+void PortManager::setActive(bool active)
+{
+    if(activeRequested != active)
+    {
+        activeRequested = active;
+        emit activeChanged(active);
+        restart();
+    }
+}
+
+void PortManager::componentComplete()
+{
+    // Start with the final settings, rather than once per property assigned from QML
+    componentCompleted = true;
+    restart();
+}
+
+void PortManager::rescan()
+{
+    if(activeRequested && sourceManager && componentCompleted)
+    {
+        stop();
+        startScan();
+    }
+}
+
+void PortManager::restart()
+{
+    if(!componentCompleted)
+    {
+        return;
+    }
+
+    stop();
+    failureCount = 0;
+    backoffInterval = 0;
+
+    if(activeRequested && sourceManager)
+    {
+        startScan();
+    }
+}
+
+void PortManager::stop()
+{
+    // Before stopping the source, so its notifications aren't taken for a lost connection
+    setState(STATE_IDLE);
+
+    backoffTimer.stop();
+    stableTimer.stop();
+    // Also cancels the scan still queued on the prober thread, if any. Its result is ignored
+    prober->cancel(currentScanId);
+    currentScanId++;
+
+    if(sourceManager)
+    {
+        sourceManager->setActive(false);
+    }
+}
+
+void PortManager::startScan()
+{
+    // The last match first, it's the likeliest after a lost connection
+    QStringList ports = preferred;
+    QList<qint32> rates = candidateBaudRates;
+    if(!foundPortName.isEmpty())
+    {
+        ports.prepend(foundPortName);
+        rates.removeAll(foundBaudRate);
+        rates.prepend(foundBaudRate);
+    }
+
+    currentScanId++;
+    setState(STATE_SCANNING);
+
+    QMetaObject::invokeMethod(prober, [prober = prober, ports, rates, probeTime = probeDuration, scanId = currentScanId]()
+    {
+        prober->scan(ports, rates, probeTime, scanId);
+    }, Qt::QueuedConnection);
+}
+
+void PortManager::fail(const QString& errorString)
+{
+    lastError = errorString;
+    failureCount++;
+    stableTimer.stop();
+    backoffInterval = backoffInterval == 0 ? minimumBackoffInterval : qMin(backoffInterval * 2, maximumBackoffInterval);
+    setState(STATE_WAITING);
+
+    if(sourceManager)
+    {
+        sourceManager->setActive(false);
+    }
+    backoffTimer.start(backoffInterval);
+}
+
+void PortManager::onPortFound(int scanId, const QString& portName, qint32 baudRate, int frameProtocol)
+{
+    if(scanId != currentScanId || connectionState != STATE_SCANNING)
+    {
+        return;
+    }
+
+    if(foundPortName != portName || foundBaudRate != baudRate || foundFrameProtocol != frameProtocol)
+    {
+        foundPortName = portName;
+        foundBaudRate = baudRate;
+        foundFrameProtocol = static_cast<Serial::FrameProtocol>(frameProtocol);
+        emit portChanged();
+    }
+
+    setState(STATE_CONNECTING);
+
+    // The source is inactive since the scan started, so these only take effect once it's activated again
+    sourceManager->setFrameProtocol(foundFrameProtocol);
+    sourceManager->setBaudRate(foundBaudRate);
+    sourceManager->setPorts({ foundPortName });
+    sourceManager->setActive(true);
+}
+
+void PortManager::onPortNotFound(int scanId)
+{
+    if(scanId == currentScanId && connectionState == STATE_SCANNING)
+    {
+        fail(portNames.isEmpty() ? QStringLiteral("No serial port available") : QStringLiteral("No device data frames on any serial port"));
+    }
+}
+
+void PortManager::onOpenPortsChanged(int openPorts)
+{
+    if(connectionState == STATE_CONNECTING && openPorts > 0)
+    {
+        // The backoff is only reset once the connection has stayed up, see STABLE_CONNECTION_TIME
+        stableTimer.start();
+        lastError.clear();
+        lastSampleCount = -1.0;
+        silenceClock.start();
+        setState(STATE_CONNECTED);
+    }
+    else if(connectionState == STATE_CONNECTED && openPorts == 0)
+    {
+        fail(QStringLiteral("%1 closed").arg(foundPortName));
+    }
+}
+
+void PortManager::onSourceError(int sourceId, const QString& errorString)
+{
+    Q_UNUSED(sourceId)
+
+    if(connectionState == STATE_CONNECTING || connectionState == STATE_CONNECTED)
+    {
+        fail(QStringLiteral("%1: %2").arg(foundPortName, errorString));
+    }
+}
+
+void PortManager::onSourceStatistics()
+{
+    if(connectionState != STATE_CONNECTED || silenceTimeoutInterval == 0)
+    {
+        return;
+    }
+
+    const QVariantList statistics = sourceManager->sourceStatistics();
+    if(statistics.isEmpty())
+    {
+        return;
+    }
+
+    const double sampleCount = statistics.first().toMap().value(QStringLiteral("samples")).toDouble();
+    if(sampleCount != lastSampleCount)
+    {
+        lastSampleCount = sampleCount;
+        silenceClock.start();
+    }
+    else if(silenceClock.elapsed() >= silenceTimeoutInterval)
+    {
+        // Opened but nothing decodable comes, e.g. the node was reset at another baud rate
+        fail(QStringLiteral("No device data frames from %1 for %2 ms").arg(foundPortName).arg(silenceTimeoutInterval));
+    }
+}
+
+void PortManager::setState(ConnectionState state)
+{
+    if(connectionState != state)
+    {
+        connectionState = state;
+        emit stateChanged(state);
+    }
+}
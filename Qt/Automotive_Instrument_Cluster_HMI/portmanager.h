@@ -0,0 +1,201 @@
+#ifndef PORTMANAGER_H
+#define PORTMANAGER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QQmlParserStatus>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QVariantList>
+#include "serial.h"
+#include "sourcemanager.h"
+
+class PortProber;
+
+/*
+ * Keeps a SourceManager connected to the HMI node, whatever port it shows up on.
+ *
+ * A PortProber enumerates the serial ports and finds the port, baud rate and wire format the node sends valid frames on,
+ * on a background thread, so the cluster is shown right away and the GUI thread never waits on a port.
+ * The match is handed to the source, which opens it on its own I/O threads.
+ *
+ * When the port fails (unplugged cable, open error) or goes silent for silenceTimeout, the source is stopped and the
+ * scan starts over after a backoff that doubles from minimumBackoff up to maximumBackoff, with the last port and baud rate
+ * tried first. A scan that finds nothing backs off the same way. A connection that stays up for a few seconds resets the backoff.
+*/
+class PortManager : public QObject, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+    // The SourceManager driven, its ports, baudRate, frameProtocol and active properties are set by the manager
+    Q_PROPERTY(SourceManager* source READ source WRITE setSource NOTIFY sourceChanged)
+    // Ports probed first when available, e.g. the one of the last run
+    Q_PROPERTY(QStringList preferredPorts READ preferredPorts WRITE setPreferredPorts NOTIFY preferredPortsChanged)
+    // Candidate baud rates, probed in this order
+    Q_PROPERTY(QVariantList baudRates READ baudRates WRITE setBaudRates NOTIFY baudRatesChanged)
+    // Time to listen at each port and baud rate for valid frames, in milliseconds
+    Q_PROPERTY(int probeTime READ probeTime WRITE setProbeTime NOTIFY probeTimeChanged)
+    // Shortest and longest wait before scanning again after a failure, in milliseconds
+    Q_PROPERTY(int minimumBackoff READ minimumBackoff WRITE setMinimumBackoff NOTIFY minimumBackoffChanged)
+    Q_PROPERTY(int maximumBackoff READ maximumBackoff WRITE setMaximumBackoff NOTIFY maximumBackoffChanged)
+    // A connected port without any sample for this long is considered lost, in milliseconds. 0 to never time out
+    Q_PROPERTY(int silenceTimeout READ silenceTimeout WRITE setSilenceTimeout NOTIFY silenceTimeoutChanged)
+    // Scan and keep the source connected when true, stop the source when false
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+
+    Q_PROPERTY(ConnectionState state READ state NOTIFY stateChanged)
+    // Port, baud rate and wire format of the last match
+    Q_PROPERTY(QString portName READ portName NOTIFY portChanged)
+    Q_PROPERTY(qint32 baudRate READ baudRate NOTIFY portChanged)
+    Q_PROPERTY(Serial::FrameProtocol frameProtocol READ frameProtocol NOTIFY portChanged)
+    // Serial ports seen by the last scan
+    Q_PROPERTY(QStringList availablePorts READ availablePorts NOTIFY availablePortsChanged)
+    // Failed scans and lost connections since the last connection that stayed up
+    Q_PROPERTY(int failures READ failures NOTIFY stateChanged)
+    // Wait before the next scan while STATE_WAITING, in milliseconds
+    Q_PROPERTY(int backoff READ backoff NOTIFY stateChanged)
+    Q_PROPERTY(QString errorString READ errorString NOTIFY stateChanged)
+
+public:
+    enum ConnectionState
+    {
+        // Not active
+        STATE_IDLE,
+        // Looking for the node on the available ports
+        STATE_SCANNING,
+        // Found, the source is opening the port
+        STATE_CONNECTING,
+        STATE_CONNECTED,
+        // Backing off before the next scan
+        STATE_WAITING
+    };
+    Q_ENUM(ConnectionState)
+
+    PortManager(QObject* parent = nullptr);
+    ~PortManager();
+
+    SourceManager* source() const { return sourceManager; }
+    void setSource(SourceManager* source);
+
+    QStringList preferredPorts() const { return preferred; }
+    void setPreferredPorts(const QStringList& preferredPorts);
+
+    QVariantList baudRates() const;
+    void setBaudRates(const QVariantList& baudRates);
+
+    int probeTime() const { return probeDuration; }
+    void setProbeTime(int probeTime);
+
+    int minimumBackoff() const { return minimumBackoffInterval; }
+    void setMinimumBackoff(int minimumBackoff);
+
+    int maximumBackoff() const { return maximumBackoffInterval; }
+    void setMaximumBackoff(int maximumBackoff);
+
+    int silenceTimeout() const { return silenceTimeoutInterval; }
+    void setSilenceTimeout(int silenceTimeout);
+
+    bool active() const { return activeRequested; }
+    void setActive(bool active);
+
+    ConnectionState state() const { return connectionState; }
+    QString portName() const { return foundPortName; }
+    qint32 baudRate() const { return foundBaudRate; }
+    Serial::FrameProtocol frameProtocol() const { return foundFrameProtocol; }
+    QStringList availablePorts() const { return portNames; }
+    int failures() const { return failureCount; }
+    int backoff() const { return backoffInterval; }
+    QString errorString() const { return lastError; }
+
+    void classBegin() override { componentCompleted = false; }
+    void componentComplete() override;
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Drop the current connection, if any, and scan right away
+     *
+     * @return void
+    */
+    void rescan();
+
+Q_SIGNALS:
+    void sourceChanged(SourceManager* source);
+    void preferredPortsChanged(QStringList preferredPorts);
+    void baudRatesChanged();
+    void probeTimeChanged(int probeTime);
+    void minimumBackoffChanged(int minimumBackoff);
+    void maximumBackoffChanged(int maximumBackoff);
+    void silenceTimeoutChanged(int silenceTimeout);
+    void activeChanged(bool active);
+    void stateChanged(PortManager::ConnectionState state);
+    void portChanged();
+    void availablePortsChanged(QStringList availablePorts);
+
+private:
+    // Start or stop scanning depending on active and source
+    void restart();
+
+    /*
+     * @brief Cancel any scan and stop the source
+     *
+     * @return void
+    */
+    void stop();
+
+    // Queue a scan on the prober thread
+    void startScan();
+
+    /*
+     * @brief Stop the source and wait the current backoff before scanning again, doubling it for the next failure
+     *
+     * @return void
+    */
+    void fail(const QString& errorString);
+
+    // [SLOT] Results of PortProber::scan()
+    void onPortFound(int scanId, const QString& portName, qint32 baudRate, int frameProtocol);
+    void onPortNotFound(int scanId);
+
+    // [SLOT] SourceManager notifications
+    void onOpenPortsChanged(int openPorts);
+    void onSourceError(int sourceId, const QString& errorString);
+    void onSourceStatistics();
+
+    void setState(ConnectionState state);
+
+    QPointer<SourceManager> sourceManager;
+    QList<QMetaObject::Connection> sourceConnections;
+    QStringList preferred;
+    QList<qint32> candidateBaudRates;
+    int probeDuration = 600;
+    int minimumBackoffInterval = 250;
+    int maximumBackoffInterval = 8000;
+    int silenceTimeoutInterval = 3000;
+    bool activeRequested = false;
+    bool componentCompleted = true;
+
+    ConnectionState connectionState = STATE_IDLE;
+    QString foundPortName;
+    qint32 foundBaudRate = 0;
+    Serial::FrameProtocol foundFrameProtocol = Serial::FRAME_PROTOCOL_V2;
+    QStringList portNames;
+    int failureCount = 0;
+    int backoffInterval = 0;
+    QString lastError;
+
+    // Samples of the source at the last statistics refresh, and since when it has stayed the same
+    double lastSampleCount = -1.0;
+    QElapsedTimer silenceClock;
+
+    QThread proberThread;
+    PortProber* prober = nullptr;
+    int currentScanId = 0;
+    QTimer backoffTimer;
+    // Resets the backoff once the connection has stayed up
+    QTimer stableTimer;
+};
+
+#endif // PORTMANAGER_H
@@ -0,0 +1,123 @@
+#include "portprober.h"
+#include <QElapsedTimer>
+#include <QSerialPort>
+#include <QSerialPortInfo>
+
+// Valid v2 frames from known devices needed to recognize the port, their CRC-8 makes a false positive very unlikely
+#define PROBE_MIN_V2_FRAMES 2
+// Valid v1 frames from known devices needed, with at most a quarter as many misparsed or unknown ones
+#define PROBE_MIN_V1_FRAMES 4
+
+PortProber::PortProber(QObject* parent) : QObject(parent)
+{
+}
+
+void PortProber::scan(const QStringList& preferredPorts, const QList<qint32>& baudRates, int probeTime, int scanId)
+{
+    QStringList portNames;
+    for(const QSerialPortInfo& portInfo : QSerialPortInfo::availablePorts())
+    {
+        portNames.append(portInfo.portName());
+    }
+    emit portsEnumerated(portNames);
+
+    // The preferred ports first, then the others in enumeration order
+    QStringList probeOrder;
+    for(const QString& portName : preferredPorts)
+    {
+        if(portNames.contains(portName) && !probeOrder.contains(portName))
+        {
+            probeOrder.append(portName);
+        }
+    }
+    for(const QString& portName : portNames)
+    {
+        if(!probeOrder.contains(portName))
+        {
+            probeOrder.append(portName);
+        }
+    }
+
+    for(const QString& portName : probeOrder)
+    {
+        for(qint32 baudRate : baudRates)
+        {
+            if(isCancelled(scanId))
+            {
+                emit portNotFound(scanId);
+                return;
+            }
+
+            const int frameProtocol = probe(portName, baudRate, probeTime, scanId);
+            if(frameProtocol != 0)
+            {
+                emit portFound(scanId, portName, baudRate, frameProtocol);
+                return;
+            }
+        }
+    }
+
+    emit portNotFound(scanId);
+}
+
+int PortProber::probe(const QString& portName, qint32 baudRate, int probeTime, int scanId)
+{
+    QSerialPort port;
+    port.setPortName(portName);
+    port.setBaudRate(baudRate);
+    port.setDataBits(QSerialPort::Data8);
+    port.setParity(QSerialPort::NoParity);
+    port.setStopBits(QSerialPort::OneStop);
+    if(!port.open(QIODevice::ReadOnly))
+    {
+        // Missing, busy or not a serial device
+        return 0;
+    }
+
+    DeviceDataParser parserV1;
+    parserV1.setFrameProtocol(DeviceDataParser::FRAME_PROTOCOL_V1);
+    DeviceDataParser parserV2;
+    parserV2.setFrameProtocol(DeviceDataParser::FRAME_PROTOCOL_V2);
+    size_t knownFramesV1 = 0;
+    size_t unknownFramesV1 = 0;
+    size_t knownFramesV2 = 0;
+
+    QElapsedTimer probeClock;
+    probeClock.start();
+    while(!isCancelled(scanId) && probeClock.elapsed() < probeTime)
+    {
+        if(!port.waitForReadyRead(static_cast<int>(qMax<qint64>(1, probeTime - probeClock.elapsed()))))
+        {
+            if(port.error() != QSerialPort::NoError && port.error() != QSerialPort::TimeoutError)
+            {
+                break;
+            }
+            continue;
+        }
+
+        const QByteArray data = port.readAll();
+        const qint64 timestamp = DeviceSample::currentTimestamp();
+        parserV2.parse(data.constData(), static_cast<size_t>(data.size()), timestamp, [&knownFramesV2](const DeviceSample& sample)
+        {
+            knownFramesV2 += sample.payloadType() != DeviceSample::PAYLOAD_TYPE_NONE ? 1 : 0;
+        });
+        parserV1.parse(data.constData(), static_cast<size_t>(data.size()), timestamp, [&knownFramesV1, &unknownFramesV1](const DeviceSample& sample)
+        {
+            (sample.payloadType() != DeviceSample::PAYLOAD_TYPE_NONE ? knownFramesV1 : unknownFramesV1)++;
+        });
+
+        // v2 is what current firmware sends, and can't be mistaken, so it's accepted as soon as seen
+        if(knownFramesV2 >= PROBE_MIN_V2_FRAMES)
+        {
+            return DeviceDataParser::FRAME_PROTOCOL_V2;
+        }
+    }
+
+    // Line noise at a wrong baud rate gives as many misparsed and unknown v1 frames as valid looking ones
+    if(knownFramesV2 == 0 && knownFramesV1 >= PROBE_MIN_V1_FRAMES && (parserV1.corruptedFrameCount() + unknownFramesV1) * 4 <= knownFramesV1)
+    {
+        return DeviceDataParser::FRAME_PROTOCOL_V1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef PORTPROBER_H
+#define PORTPROBER_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include "devicedataparser.h"
+
+/*
+ * Finds the serial port, baud rate and wire format the HMI node is sending on, by listening for valid device data frames.
+ *
+ * Every available port is opened at every candidate baud rate for a short while, and the received bytes are fed to a v2 and a v1
+ * DeviceDataParser. A v2 frame carries a CRC-8, so a couple of valid frames from known devices are enough. A v1 frame has no check,
+ * so it takes more of them with few misparsed ones. Ports and baud rates are tried in the given order, the first match wins.
+ *
+ * Opening and listening block, so scan() must run on a thread of its own (see PortManager). It can be cancelled from any thread.
+*/
+class PortProber : public QObject
+{
+    Q_OBJECT
+
+public:
+    PortProber(QObject* parent = nullptr);
+
+    /*
+     * @brief Make the scans up to scanId return as soon as possible, without a result. Also applies to those still queued
+     *
+     * Thread safe
+     *
+     * @return void
+    */
+    void cancel(int scanId) { cancelledScanId.store(scanId, std::memory_order_relaxed); }
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Enumerate the serial ports and probe them, emitting [SIGNAL] portsEnumerated() then [SIGNAL] portFound() or [SIGNAL] portNotFound()
+     *
+     * @param preferredPorts    Probed first, in this order, when available
+     * @param baudRates         Candidate baud rates, probed in this order
+     * @param probeTime         Time to listen at each port and baud rate, in milliseconds
+     * @param scanId            Passed back by the signals, to tell the result of a cancelled scan from the current one. Must increase from one scan to the next
+     *
+     * @return void
+    */
+    void scan(const QStringList& preferredPorts, const QList<qint32>& baudRates, int probeTime, int scanId);
+
+Q_SIGNALS:
+    void portsEnumerated(const QStringList& portNames);
+    void portFound(int scanId, const QString& portName, qint32 baudRate, int frameProtocol);
+    // Also emitted by a cancelled scan
+    void portNotFound(int scanId);
+
+private:
+    /*
+     * @brief Listen on a port at a baud rate and tell the wire format of the frames received
+     *
+     * @return The DeviceDataParser::FrameProtocol recognized, 0 if none or the port can't be opened
+    */
+    int probe(const QString& portName, qint32 baudRate, int probeTime, int scanId);
+
+    bool isCancelled(int scanId) const { return scanId <= cancelledScanId.load(std::memory_order_relaxed); }
+
+    // Latest scan cancelled, compared rather than reset by scan() so a cancel() issued while the scan is queued isn't lost
+    std::atomic<int> cancelledScanId { 0 };
+};
+
+#endif // PORTPROBER_H
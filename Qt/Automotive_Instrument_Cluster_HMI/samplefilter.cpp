@@ -0,0 +1,129 @@
+#include "samplefilter.h"
+#include <algorithm>
+#include <cmath>
+
+// Cutoff frequencies are kept under this fraction of the sample rate, the biquad design breaks down towards Nyquist
+#define MAX_CUTOFF_TO_SAMPLE_RATE 0.45
+// Smallest noise variance, so the Kalman gain stays defined
+#define MIN_NOISE_VARIANCE 1e-12
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+}
+
+void SampleFilter::setSettings(uint8_t deviceAddress, const SampleFilterSettings& settings)
+{
+    Design& design = designs[deviceAddress];
+    design = Design();
+    design.settings = settings;
+    design.settings.sampleRate = settings.sampleRate > 0.0 ? settings.sampleRate : SampleFilterSettings().sampleRate;
+    design.settings.cutoffFrequency = std::clamp(settings.cutoffFrequency, 0.0, design.settings.sampleRate * MAX_CUTOFF_TO_SAMPLE_RATE);
+    design.settings.processNoise = std::max(settings.processNoise, MIN_NOISE_VARIANCE);
+    design.settings.measurementNoise = std::max(settings.measurementNoise, MIN_NOISE_VARIANCE);
+    design.enabled = design.settings.lowPass != SampleFilterSettings::LOW_PASS_NONE || design.settings.kalman;
+
+    const double samplePeriod = 1.0 / design.settings.sampleRate;
+
+    // Exact discretization of a first order low-pass with this cutoff
+    const double timeConstant = 1.0 / (2.0 * PI * std::max(design.settings.cutoffFrequency, MIN_NOISE_VARIANCE));
+    design.exponentialAlpha = 1.0 - std::exp(-samplePeriod / timeConstant);
+
+    designBiquad(design);
+
+    design.kalmanProcessVariance = design.settings.processNoise * samplePeriod;
+
+    for(SourceStates& sourceStates : states)
+    {
+        sourceStates[deviceAddress] = State();
+    }
+}
+
+void SampleFilter::clearSettings()
+{
+    designs.fill(Design());
+    reset();
+}
+
+void SampleFilter::reset()
+{
+    for(SourceStates& sourceStates : states)
+    {
+        for(State& state : sourceStates)
+        {
+            state.primed = false;
+        }
+    }
+}
+
+void SampleFilter::filter(DeviceSample* samples, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        filter(samples[i]);
+    }
+}
+
+void SampleFilter::designBiquad(Design& design)
+{
+    // Butterworth low-pass, Q = 1/sqrt(2), from the bilinear transform (RBJ audio EQ cookbook)
+    const double omega = 2.0 * PI * design.settings.cutoffFrequency / design.settings.sampleRate;
+    const double cosOmega = std::cos(omega);
+    const double alpha = std::sin(omega) / (2.0 * std::sqrt(0.5));
+    const double a0 = 1.0 + alpha;
+
+    design.b0 = (1.0 - cosOmega) / 2.0 / a0;
+    design.b1 = (1.0 - cosOmega) / a0;
+    design.b2 = design.b0;
+    design.a1 = -2.0 * cosOmega / a0;
+    design.a2 = (1.0 - alpha) / a0;
+}
+
+double SampleFilter::filterValue(const Design& design, State& state, double value)
+{
+    const SampleFilterSettings& settings = design.settings;
+
+    if(!state.primed)
+    {
+        // Start settled on the first sample rather than ramping up from 0
+        state.primed = true;
+        state.kalmanEstimate = value;
+        state.kalmanVariance = settings.measurementNoise;
+        state.lowPassValue = value;
+        state.z2 = value * (design.b2 - design.a2);
+        state.z1 = value * (design.b1 - design.a1) + state.z2;
+        return value;
+    }
+
+    if(settings.kalman)
+    {
+        // Predict: the value stays the same, its uncertainty grows. Update: blend in the measurement by their uncertainties
+        state.kalmanVariance += design.kalmanProcessVariance;
+        const double gain = state.kalmanVariance / (state.kalmanVariance + settings.measurementNoise);
+        state.kalmanEstimate += gain * (value - state.kalmanEstimate);
+        state.kalmanVariance *= 1.0 - gain;
+        value = state.kalmanEstimate;
+    }
+
+    switch(settings.lowPass)
+    {
+    case SampleFilterSettings::LOW_PASS_EXPONENTIAL:
+        state.lowPassValue += design.exponentialAlpha * (value - state.lowPassValue);
+        value = state.lowPassValue;
+        break;
+
+    case SampleFilterSettings::LOW_PASS_BIQUAD:
+    {
+        const double output = design.b0 * value + state.z1;
+        state.z1 = design.b1 * value - design.a1 * output + state.z2;
+        state.z2 = design.b2 * value - design.a2 * output;
+        value = output;
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return value;
+}
@@ -0,0 +1,140 @@
+#ifndef SAMPLEFILTER_H
+#define SAMPLEFILTER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "devicesample.h"
+
+// Sources with a filter state of their own, see DeviceSample::sourceId(). The samples of the others pass through unchanged
+#define SAMPLE_FILTER_MAX_SOURCES 8
+
+// Filter of the float samples of one device, see SampleFilter
+struct SampleFilterSettings
+{
+    enum LowPass
+    {
+        LOW_PASS_NONE,
+        // First order, y += alpha * (x - y)
+        LOW_PASS_EXPONENTIAL,
+        // Second order Butterworth, steeper roll-off for the same lag
+        LOW_PASS_BIQUAD
+    };
+
+    LowPass lowPass = LOW_PASS_NONE;
+    // -3 dB cutoff frequency of the low-pass in Hz
+    double cutoffFrequency = 5.0;
+    // Nominal sample rate of the device in Hz, the filters are designed for it
+    double sampleRate = 100.0;
+
+    // 1-D Kalman filter of a value drifting as a random walk, applied before the low-pass
+    bool kalman = false;
+    // Variance the true value drifts by per second, in the device unit squared. Higher follows changes faster
+    double processNoise = 0.01;
+    // Variance of the measurement noise, in the device unit squared. Higher smooths more
+    double measurementNoise = 0.1;
+};
+
+/*
+ * Smooths the float samples of the devices it has settings for, e.g. the accelerometer ADC noise before it's integrated into the speed.
+ *
+ * The settings are per device address, the filter state is per device address of each source (see DeviceSample::sourceId()),
+ * so the same device on two merged ports is filtered as two separate signals. Filtering a sample is a table lookup and a few multiply-adds:
+ * constant time, no allocation, the states of SAMPLE_FILTER_MAX_SOURCES sources are allocated up front. The filters are designed once from the nominal sample rate rather than per sample from the timestamps,
+ * as samples decoded from the same chunk share an arrival timestamp. This also makes a replay filter exactly like the live run.
+ *
+ * Byte samples, unknown devices, devices without settings and sources from SAMPLE_FILTER_MAX_SOURCES on pass through unchanged.
+*/
+class SampleFilter
+{
+public:
+    SampleFilter() : states(SAMPLE_FILTER_MAX_SOURCES) {}
+
+    /*
+     * @brief Set the filter of a device, restarting its state from the next sample
+     *
+     * Out of range values are clamped: the cutoff frequency stays under half the sample rate, the noises stay positive
+     *
+     * @return void
+    */
+    void setSettings(uint8_t deviceAddress, const SampleFilterSettings& settings);
+
+    // Settings of a device, LOW_PASS_NONE without Kalman if never set
+    const SampleFilterSettings& settings(uint8_t deviceAddress) const { return designs[deviceAddress].settings; }
+
+    /*
+     * @brief Remove the filter of every device
+     *
+     * @return void
+    */
+    void clearSettings();
+
+    /*
+     * @brief Restart every filter from the next sample, keeping the settings. E.g. when the source is reopened or a replay seeks
+     *
+     * @return void
+    */
+    void reset();
+
+    /*
+     * @brief Filter a sample in place
+     *
+     * @return void
+    */
+    void filter(DeviceSample& sample)
+    {
+        const uint8_t deviceAddress = static_cast<uint8_t>(sample.deviceAddress());
+        const size_t sourceId = static_cast<size_t>(sample.sourceId());
+        const Design& design = designs[deviceAddress];
+        if(design.enabled && sample.payloadType() == DeviceSample::PAYLOAD_TYPE_FLOAT && sourceId < SAMPLE_FILTER_MAX_SOURCES)
+        {
+            sample.setFloatData(static_cast<float>(filterValue(design, states[sourceId][deviceAddress], sample.floatData())));
+        }
+    }
+
+    /*
+     * @brief Filter a span of samples in place, in order. Same result as filtering them one by one
+     *
+     * @param samples   First sample of the span, e.g. a replayed capture or a SampleHistory range
+     * @param count     Number of samples
+     *
+     * @return void
+    */
+    void filter(DeviceSample* samples, size_t count);
+
+private:
+    // Filter of a device address, designed by setSettings()
+    struct Design
+    {
+        SampleFilterSettings settings;
+        bool enabled = false;
+
+        double exponentialAlpha = 1.0;
+        // Normalized by a0, see designBiquad()
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+        double kalmanProcessVariance = 0.0;
+    };
+
+    // Filter state of a device address of one source, restarted by reset()
+    struct State
+    {
+        bool primed = false;
+        double lowPassValue = 0.0;
+        // Transposed direct form II delay line
+        double z1 = 0.0, z2 = 0.0;
+        double kalmanEstimate = 0.0;
+        double kalmanVariance = 0.0;
+    };
+
+    using SourceStates = std::array<State, 256>;
+
+    static void designBiquad(Design& design);
+    static double filterValue(const Design& design, State& state, double value);
+
+    std::array<Design, 256> designs;
+    // Indexed by source id, SAMPLE_FILTER_MAX_SOURCES of them. On the heap, they take ~12 KB per source
+    std::vector<SourceStates> states;
+};
+
+#endif // SAMPLEFILTER_H
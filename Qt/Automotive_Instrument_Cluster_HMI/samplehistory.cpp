@@ -0,0 +1,200 @@
+#include "samplehistory.h"
+#include <algorithm>
+
+SampleHistory::SampleHistory(size_t memoryBudget)
+{
+    size_t samples = 1;
+    for(int level = 0; level < LEVEL_COUNT; level++)
+    {
+        samplesPerEntry[level] = samples;
+        samples *= FANOUT;
+    }
+
+    reset(memoryBudget);
+}
+
+void SampleHistory::reset(size_t memoryBudget)
+{
+    budget = memoryBudget;
+
+    // Power of two capacity, so the ring index is a mask
+    const size_t maxCapacity = std::max<size_t>(budget / (LEVEL_COUNT * sizeof(Entry)), 2);
+    capacity = 1;
+    while(capacity * 2 <= maxCapacity)
+    {
+        capacity *= 2;
+    }
+
+    for(Level& level : levels)
+    {
+        level.entries.assign(capacity, Entry { 0, 0.0f, 0.0f });
+        level.entries.shrink_to_fit();
+    }
+
+    clear();
+}
+
+void SampleHistory::clear()
+{
+    for(Level& level : levels)
+    {
+        level.head = 0;
+        level.size = 0;
+    }
+    for(PendingEntry& pendingEntry : pending)
+    {
+        pendingEntry.count = 0;
+    }
+    appendedSamples = 0;
+    newest = 0;
+}
+
+void SampleHistory::append(int64_t timestamp, float value)
+{
+    if(appendedSamples && timestamp < newest)
+    {
+        timestamp = newest;
+    }
+    newest = timestamp;
+    appendedSamples++;
+
+    levels[0].push(Entry { timestamp, value, value }, capacity);
+
+    for(int level = 1; level < LEVEL_COUNT; level++)
+    {
+        PendingEntry& pendingEntry = pending[level];
+        if(!pendingEntry.count)
+        {
+            pendingEntry.entry = Entry { timestamp, value, value };
+        }
+        else
+        {
+            pendingEntry.entry.min = std::min(pendingEntry.entry.min, value);
+            pendingEntry.entry.max = std::max(pendingEntry.entry.max, value);
+        }
+
+        if(++pendingEntry.count == samplesPerEntry[level])
+        {
+            levels[level].push(pendingEntry.entry, capacity);
+            pendingEntry.count = 0;
+        }
+    }
+}
+
+int SampleHistory::query(int64_t from, int64_t to, size_t columnCount, std::vector<Column>& columns) const
+{
+    columns.assign(columnCount, Column { 0.0f, 0.0f, false });
+    if(!columnCount || to <= from || !appendedSamples)
+    {
+        return 0;
+    }
+
+    const double columnDuration = double(to - from) / columnCount;
+
+    // The finest level still holding the start of the window, the coarsest one holds what's left of the history otherwise
+    int level = 0;
+    while(level < LEVEL_COUNT - 1 && levels[level].size == capacity && levels[level].at(0, capacity).timestamp > from)
+    {
+        level++;
+    }
+
+    // Then coarser while the entries of the next level are still no longer than a column, so a column reads at most FANOUT entries
+    while(level < LEVEL_COUNT - 1 && levels[level + 1].size > 1 && levels[level + 1].entryDuration(capacity) <= columnDuration)
+    {
+        level++;
+    }
+
+    const Level& source = levels[level];
+    // Start with the entry spanning from, the last one starting at or before it
+    size_t index = source.upperBound(from, capacity);
+    if(index > 0)
+    {
+        index--;
+    }
+
+    const auto addEntry = [from, columnDuration, columnCount, &columns](const Entry& entry)
+    {
+        const int64_t offset = std::max<int64_t>(entry.timestamp - from, 0);
+        const size_t column = std::min(static_cast<size_t>(offset / columnDuration), columnCount - 1);
+        Column& target = columns[column];
+        if(!target.valid)
+        {
+            target = Column { entry.min, entry.max, true };
+        }
+        else
+        {
+            target.min = std::min(target.min, entry.min);
+            target.max = std::max(target.max, entry.max);
+        }
+    };
+
+    for(; index < source.size; index++)
+    {
+        const Entry& entry = source.at(index, capacity);
+        if(entry.timestamp > to)
+        {
+            return level;
+        }
+        addEntry(entry);
+    }
+
+    // The newest samples are still being aggregated above level 0
+    if(level > 0 && pending[level].count && pending[level].entry.timestamp <= to)
+    {
+        addEntry(pending[level].entry);
+    }
+
+    return level;
+}
+
+int64_t SampleHistory::oldestTimestamp() const
+{
+    // Coarser levels reach further back
+    for(int level = LEVEL_COUNT - 1; level >= 0; level--)
+    {
+        if(levels[level].size)
+        {
+            return levels[level].at(0, capacity).timestamp;
+        }
+    }
+    return 0;
+}
+
+void SampleHistory::Level::push(const Entry& entry, size_t capacity)
+{
+    if(size < capacity)
+    {
+        entries[(head + size) & (capacity - 1)] = entry;
+        size++;
+    }
+    else
+    {
+        // Overwrite the oldest entry
+        entries[head] = entry;
+        head = (head + 1) & (capacity - 1);
+    }
+}
+
+double SampleHistory::Level::entryDuration(size_t capacity) const
+{
+    return size > 1 ? double(at(size - 1, capacity).timestamp - at(0, capacity).timestamp) / (size - 1) : 0.0;
+}
+
+size_t SampleHistory::Level::upperBound(int64_t timestamp, size_t capacity) const
+{
+    size_t low = 0;
+    size_t high = size;
+    while(low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if(at(middle, capacity).timestamp <= timestamp)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
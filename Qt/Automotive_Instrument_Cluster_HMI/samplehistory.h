@@ -0,0 +1,116 @@
+#ifndef SAMPLEHISTORY_H
+#define SAMPLEHISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * History of a single device's values, for trend graphs.
+ *
+ * Samples are kept in a min/max decimation pyramid of LEVEL_COUNT ring buffers of the same length:
+ * level 0 holds the raw samples, every entry of level k holds the min and max of FANOUT^k consecutive samples.
+ * Each level thus spans FANOUT times longer than the previous one, so long histories fit a fixed memory budget
+ * while recent data stays at full resolution.
+ *
+ * query() resamples any time window to a given number of columns by reading the finest level that still covers the window
+ * with at most FANOUT entries per column, in O(columns) whatever the length of the history is.
+*/
+class SampleHistory
+{
+public:
+    static constexpr int LEVEL_COUNT = 8;
+    static constexpr size_t FANOUT = 8;
+
+    // Min and max of the values in a time span starting at timestamp
+    struct Entry
+    {
+        int64_t timestamp;
+        float min;
+        float max;
+    };
+
+    // A column of a query() result, invalid when no sample falls in it
+    struct Column
+    {
+        float min;
+        float max;
+        bool valid;
+    };
+
+    /*
+     * @param memoryBudget  Bytes used by the history, split evenly between the levels
+    */
+    explicit SampleHistory(size_t memoryBudget = 16 * 1024 * 1024);
+
+    /*
+     * @brief Append a sample. Timestamps going backward are clamped to the newest one
+     *
+     * @param timestamp     Monotonic time of the sample in nanoseconds
+     *
+     * @return void
+    */
+    void append(int64_t timestamp, float value);
+
+    /*
+     * @brief Resample the history between from and to into columns of equal duration
+     *
+     * @param from          Start of the window, monotonic time in nanoseconds
+     * @param to            End of the window, monotonic time in nanoseconds
+     * @param columnCount   Number of columns, typically the width of the graph in pixels
+     * @param columns       Receives columnCount columns, resized if needed
+     *
+     * @return The level that was read
+    */
+    int query(int64_t from, int64_t to, size_t columnCount, std::vector<Column>& columns) const;
+
+    /*
+     * @brief Drop every sample and resize the levels to a new memory budget
+     *
+     * @return void
+    */
+    void reset(size_t memoryBudget);
+    void clear();
+
+    size_t memoryBudget() const { return budget; }
+    // Entries per level
+    size_t levelCapacity() const { return capacity; }
+    size_t levelSize(int level) const { return levels[level].size; }
+    uint64_t sampleCount() const { return appendedSamples; }
+    // 0 when empty
+    int64_t oldestTimestamp() const;
+    int64_t newestTimestamp() const { return newest; }
+
+private:
+    struct Level
+    {
+        std::vector<Entry> entries;
+        // Index of the oldest entry
+        size_t head = 0;
+        size_t size = 0;
+
+        const Entry& at(size_t index, size_t capacity) const { return entries[(head + index) & (capacity - 1)]; }
+        void push(const Entry& entry, size_t capacity);
+        // Average time between two entries, 0 with less than two entries
+        double entryDuration(size_t capacity) const;
+        // Index of the first entry with a timestamp after the given one, size if none
+        size_t upperBound(int64_t timestamp, size_t capacity) const;
+    };
+
+    // Entry being aggregated for a level above 0
+    struct PendingEntry
+    {
+        Entry entry;
+        size_t count = 0;
+    };
+
+    size_t budget = 0;
+    size_t capacity = 0;
+    Level levels[LEVEL_COUNT];
+    PendingEntry pending[LEVEL_COUNT];
+    size_t samplesPerEntry[LEVEL_COUNT];
+    uint64_t appendedSamples = 0;
+    int64_t newest = 0;
+};
+
+#endif // SAMPLEHISTORY_H
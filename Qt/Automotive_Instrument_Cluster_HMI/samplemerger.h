@@ -0,0 +1,164 @@
+#ifndef SAMPLEMERGER_H
+#define SAMPLEMERGER_H
+
+#include <QtGlobal>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "devicesample.h"
+
+/*
+ * Merges the samples of several sources into a single stream ordered by arrival timestamp.
+ *
+ * The samples of each source are in timestamp order, so the next sample of a source can't be older than the newest one
+ * taken from it. A sample is released once every active source has delivered something at least as new (the watermark),
+ * or once it is older than the reorder window, so an idle or slow source delays the others by at most the window.
+ * A sample arriving after newer ones were released is released right away and counted as late.
+*/
+class SampleMerger
+{
+public:
+    explicit SampleMerger(size_t sourceCount = 0) { reset(sourceCount); }
+
+    /*
+     * @brief Drop every held sample and set the number of sources, all of them inactive
+     *
+     * @return void
+    */
+    void reset(size_t sourceCount)
+    {
+        queues.assign(sourceCount, Queue());
+        lastReleasedTimestamp = std::numeric_limits<qint64>::min();
+        late = 0;
+    }
+
+    /*
+     * @brief Hold a sample of a source, in the order the source produced them
+     *
+     * @return void
+    */
+    void add(size_t source, const DeviceSample& sample)
+    {
+        Queue& queue = queues[source];
+        queue.samples.push_back(sample);
+        queue.newestTimestamp = sample.timestamp();
+    }
+
+    /*
+     * @brief Only active sources hold back the release of the other sources' samples, e.g. the opened ports
+     *
+     * @return void
+    */
+    void setSourceActive(size_t source, bool active) { queues[source].active = active; }
+
+    /*
+     * @brief Release the held samples that can't be preceded by a sample to come anymore, in timestamp order
+     *
+     * @param now               Current monotonic time in nanoseconds, see DeviceSample::currentTimestamp()
+     * @param reorderWindow     Longest time a sample is held in nanoseconds
+     * @param onSample          Callable with the signature void(const DeviceSample&)
+     *
+     * @return Number of released samples
+    */
+    template<typename SampleCallback>
+    size_t release(qint64 now, qint64 reorderWindow, SampleCallback&& onSample)
+    {
+        qint64 watermark = std::numeric_limits<qint64>::max();
+        for(const Queue& queue : queues)
+        {
+            if(queue.active && queue.newestTimestamp < watermark)
+            {
+                watermark = queue.newestTimestamp;
+            }
+        }
+        const qint64 horizon = qMax(watermark, now - reorderWindow);
+
+        size_t released = 0;
+        for(;;)
+        {
+            // Oldest head among the sources, linear in the number of sources
+            Queue* oldest = nullptr;
+            for(Queue& queue : queues)
+            {
+                if(queue.head < queue.samples.size() && (!oldest || queue.front().timestamp() < oldest->front().timestamp()))
+                {
+                    oldest = &queue;
+                }
+            }
+            if(!oldest || oldest->front().timestamp() > horizon)
+            {
+                break;
+            }
+
+            const DeviceSample& sample = oldest->front();
+            if(sample.timestamp() < lastReleasedTimestamp)
+            {
+                late++;
+            }
+            else
+            {
+                lastReleasedTimestamp = sample.timestamp();
+            }
+            onSample(sample);
+            released++;
+
+            // Reuse the storage once the queue is empty
+            if(++oldest->head == oldest->samples.size())
+            {
+                oldest->samples.clear();
+                oldest->head = 0;
+            }
+        }
+
+        return released;
+    }
+
+    /*
+     * @brief Time the oldest held sample gets released by the reorder window, at the latest
+     *
+     * @return Monotonic time in nanoseconds, std::numeric_limits<qint64>::max() if no sample is held
+    */
+    qint64 nextReleaseTimestamp(qint64 reorderWindow) const
+    {
+        qint64 oldestTimestamp = std::numeric_limits<qint64>::max();
+        for(const Queue& queue : queues)
+        {
+            if(queue.head < queue.samples.size() && queue.front().timestamp() < oldestTimestamp)
+            {
+                oldestTimestamp = queue.front().timestamp();
+            }
+        }
+        return oldestTimestamp == std::numeric_limits<qint64>::max() ? oldestTimestamp : oldestTimestamp + reorderWindow;
+    }
+
+    size_t heldSamples() const
+    {
+        size_t held = 0;
+        for(const Queue& queue : queues)
+        {
+            held += queue.samples.size() - queue.head;
+        }
+        return held;
+    }
+
+    // Samples released after newer ones, they arrived later than the reorder window
+    quint64 lateSamples() const { return late; }
+
+private:
+    struct Queue
+    {
+        std::vector<DeviceSample> samples;
+        size_t head = 0;
+        // Nothing is known about the source until its first sample
+        qint64 newestTimestamp = std::numeric_limits<qint64>::min();
+        bool active = false;
+
+        const DeviceSample& front() const { return samples[head]; }
+    };
+
+    std::vector<Queue> queues;
+    qint64 lastReleasedTimestamp = std::numeric_limits<qint64>::min();
+    quint64 late = 0;
+};
+
+#endif // SAMPLEMERGER_H
@@ -0,0 +1,109 @@
+#include "samplewriter.h"
+#include <QtEndian>
+#include <cstdio>
+#include <cstring>
+
+// Buffered records are written once the buffer holds this many bytes
+#define SAMPLE_WRITER_FLUSH_SIZE (256 * 1024)
+// Longest CSV line: 20 digits timestamp, source id, device address, payload type, 16 characters float and separators
+#define SAMPLE_WRITER_MAX_CSV_LINE_SIZE 64
+
+bool SampleWriter::open(const QString& filePath, Format format)
+{
+    close();
+
+    file.setFileName(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("SampleWriter: can't open %s: %s", qPrintable(filePath), qPrintable(file.errorString()));
+        return false;
+    }
+
+    fileFormat = format;
+    samples = 0;
+    buffer.reserve(SAMPLE_WRITER_FLUSH_SIZE + SAMPLE_WRITER_MAX_CSV_LINE_SIZE);
+
+    if(fileFormat == FORMAT_BINARY)
+    {
+        char header[SAMPLE_FILE_HEADER_SIZE] = { 0 };
+        memcpy(header, SAMPLE_FILE_MAGIC, 8);
+        qToLittleEndian<quint32>(SAMPLE_FILE_VERSION, header + 8);
+        buffer.append(header, sizeof(header));
+    }
+    else
+    {
+        buffer.append("timestamp_ns,source_id,device_address,payload_type,value\n");
+    }
+
+    return true;
+}
+
+void SampleWriter::close()
+{
+    if(file.isOpen())
+    {
+        flush();
+        file.close();
+    }
+}
+
+void SampleWriter::write(const DeviceSample& sample)
+{
+    if(!file.isOpen())
+    {
+        return;
+    }
+
+    if(fileFormat == FORMAT_BINARY)
+    {
+        char record[SAMPLE_FILE_RECORD_SIZE];
+        qToLittleEndian<qint64>(sample.timestamp(), record);
+        qToLittleEndian<float>(static_cast<float>(sample.value()), record + 8);
+        record[12] = static_cast<char>(sample.deviceAddress());
+        record[13] = static_cast<char>(sample.payloadType());
+        record[14] = static_cast<char>(sample.sourceId());
+        record[15] = 0;
+        buffer.append(record, sizeof(record));
+    }
+    else
+    {
+        char line[SAMPLE_WRITER_MAX_CSV_LINE_SIZE];
+        int lineSize;
+        if(sample.payloadType() == DeviceSample::PAYLOAD_TYPE_FLOAT)
+        {
+            lineSize = snprintf(line, sizeof(line), "%lld,%d,%d,%d,%.9g\n", static_cast<long long>(sample.timestamp()), sample.sourceId(),
+                                sample.deviceAddress(), static_cast<int>(sample.payloadType()), static_cast<double>(sample.floatData()));
+        }
+        else if(sample.payloadType() == DeviceSample::PAYLOAD_TYPE_BYTE)
+        {
+            lineSize = snprintf(line, sizeof(line), "%lld,%d,%d,%d,%d\n", static_cast<long long>(sample.timestamp()), sample.sourceId(),
+                                sample.deviceAddress(), static_cast<int>(sample.payloadType()), sample.byteData());
+        }
+        else
+        {
+            // Unknown device, no value
+            lineSize = snprintf(line, sizeof(line), "%lld,%d,%d,%d,\n", static_cast<long long>(sample.timestamp()), sample.sourceId(),
+                                sample.deviceAddress(), static_cast<int>(sample.payloadType()));
+        }
+        buffer.append(line, qMin<int>(lineSize, sizeof(line) - 1));
+    }
+
+    samples++;
+    if(buffer.size() >= SAMPLE_WRITER_FLUSH_SIZE)
+    {
+        flush();
+    }
+}
+
+void SampleWriter::flush()
+{
+    if(!buffer.isEmpty())
+    {
+        if(file.write(buffer) != buffer.size())
+        {
+            qWarning("SampleWriter: can't write %s: %s", qPrintable(file.fileName()), qPrintable(file.errorString()));
+        }
+        // Keeps the capacity, so the next records don't allocate
+        buffer.resize(0);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SAMPLEWRITER_H
+#define SAMPLEWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include "devicesample.h"
+
+/*
+ * Binary sample file.
+ *
+ * Header (16 bytes): SAMPLE_FILE_MAGIC (8 bytes) -> Format version (uint32) -> Reserved (uint32)
+ * Then one SAMPLE_FILE_RECORD_SIZE bytes record per decoded sample:
+ *      Arrival timestamp in nanoseconds (int64) -> Value (IEEE 754 float32) -> Device address (uint8) -> Payload type (uint8, DeviceSample::PayloadType)
+ *      -> Source id (uint8) -> Reserved (uint8)
+ *
+ * All the fields are little-endian. Byte payloads are stored as their float value, unknown devices as 0.
+*/
+#define SAMPLE_FILE_MAGIC "AICHSMP\0"
+#define SAMPLE_FILE_VERSION 1
+#define SAMPLE_FILE_HEADER_SIZE 16
+#define SAMPLE_FILE_RECORD_SIZE 16
+
+/*
+ * Writes decoded samples to a CSV or binary sample file.
+ *
+ * The records are formatted into a reused buffer and written in large blocks, so writing a sample costs no allocation
+ * nor system call. Not thread safe, it must be used by the thread receiving the samples.
+*/
+class SampleWriter
+{
+public:
+    enum Format
+    {
+        // timestamp_ns,source_id,device_address,payload_type,value
+        FORMAT_CSV,
+        // See SAMPLE_FILE_MAGIC
+        FORMAT_BINARY
+    };
+
+    ~SampleWriter() { close(); }
+
+    /*
+     * @brief Create (or truncate) the file and write its header
+     *
+     * @return false if the file can't be written
+    */
+    bool open(const QString& filePath, Format format);
+
+    /*
+     * @brief Write the buffered records and close the file
+     *
+     * @return void
+    */
+    void close();
+
+    bool isOpen() const { return file.isOpen(); }
+
+    /*
+     * @brief Append a sample
+     *
+     * @return void
+    */
+    void write(const DeviceSample& sample);
+
+    // Samples written since open()
+    quint64 sampleCount() const { return samples; }
+
+private:
+    void flush();
+
+    QFile file;
+    Format fileFormat = FORMAT_CSV;
+    QByteArray buffer;
+    quint64 samples = 0;
+};
+
+#endif // SAMPLEWRITER_H
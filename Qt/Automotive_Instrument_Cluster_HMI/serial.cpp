@@ -1,84 +1,122 @@
 #include "serial.h"
 
-#define DEVICE_DATA_FRAME_START_DELIMITER '|'
-#define DEVICE_DATA_FRAME_END_DELIMITER '\r'
-
-Serial::Serial(QObject* parent) : QSerialPort(parent)
+Serial::Serial(QObject* parent) : QSerialPort(parent), ingestionMetrics(new IngestionMetrics(this))
 {
+    ingestionMetrics->setCounters({ &parser.counters() });
+
     // Create signal slot connection to make readAndParseDeviceData() called whenever there is a new data ready to be read
     QObject::connect(this, &QIODevice::readyRead, this, &Serial::readAndParseDeviceData);
 }
 
 void Serial::readAndParseDeviceData()
 {
+    /*
+     * Drain everything available in one go. readyRead() is not re-emitted for bytes that are left in the buffer,
+     * so reading less than bytesAvailable() leaves complete frames waiting until more data arrives
+    */
+    const qint64 availableBytes = bytesAvailable();
+    if(availableBytes <= 0)
+    {
+        return;
+    }
 
-    if(startOfDeviceDataFrameReceieved)
+    // All the frames completed by this chunk share its arrival time
+    const qint64 timestamp = DeviceSample::currentTimestamp();
+
+    readBuffer.resize(availableBytes);
+    const qint64 readBytes = read(readBuffer.data(), availableBytes);
+    if(readBytes > 0)
     {
-        // Read a byte from the received device data frame into the receivedDataBuffer at the receivedDataBufferIndex position
-        if(read((receivedDataBuffer + receivedDataBufferIndex), 1))
+        bytes += static_cast<quint64>(readBytes);
+        captureRecorder.record(readBuffer.constData(), static_cast<size_t>(readBytes), timestamp);
+        parseDeviceData(readBuffer.constData(), static_cast<size_t>(readBytes), timestamp);
+    }
+}
+
+size_t Serial::parseDeviceData(const char* data, size_t size, qint64 timestamp)
+{
+    const size_t previousCorruptedFrames = parser.corruptedFrameCount();
+    const size_t previousLostFrames = parser.lostFrameCount();
+
+    const size_t samples = parser.parse(data, size, timestamp, [this](const DeviceSample& sample)
+    {
+        // Emit device sample available signal with the device data
+        emit deviceSampleAvailable(sample);
+
+        if(legacyDeviceData)
         {
-            /*
-             * If reached the end of the frame, then parse the device data and set it up in the correct
-             * device output format to be called in [SIGNAL] deviceDataAvailable(deviceOutput)
-            */
-            if(receivedDataBuffer[receivedDataBufferIndex] == DEVICE_DATA_FRAME_END_DELIMITER)
-            {
-                /* Process the received device data frame in the buffer */
-                QList<QVariant> deviceDataOut(2);
-                // First byte in the device data frame is the device address
-                uint8_t deviceAddress = receivedDataBuffer[0];
-
-                switch (deviceAddress)
-                {
-                    case DEVICE_INTERNAL_ADDRESS_MOTOR:
-                        deviceDataOut[0] = DEVICE_INTERNAL_ADDRESS_MOTOR;
-                        deviceDataOut[1] = receivedDataBuffer[1];
-                        break;
-                    case DEVICE_INTERNAL_ADDRESS_ACCELEROMETER:
-                        deviceDataOut[0] = DEVICE_INTERNAL_ADDRESS_ACCELEROMETER;
-
-                        // Convert the received four data bytes back to float
-                        float accelerometerValue;
-                        memcpy (&accelerometerValue, (receivedDataBuffer + 1), 4);
-                        deviceDataOut[1] = accelerometerValue;
-                        break;
-                    case DEVICE_INTERNAL_ADDRESS_LM35:
-                        deviceDataOut[0] = DEVICE_INTERNAL_ADDRESS_LM35;
-
-                        // Convert the received four data bytes back to float
-                        float tempratureValue;
-                        memcpy (&tempratureValue, (receivedDataBuffer + 1), 4);
-                        deviceDataOut[1] = tempratureValue;
-                        break;
-                    default:
-                        // Error Handing: Unknown device address
-                        break;
-                }
-
-                // Emit device data available signal with the device data
-                 emit deviceDataAvailable(deviceDataOut);
-
-                // Reset the start of frame received status
-                startOfDeviceDataFrameReceieved = false;
-                // Reset the buffer index
-                receivedDataBufferIndex = 0;
-            }
-            /*
-             * If DEVICE_DATA_FRAME_END_DELIMITER hasn't been reached yet, then move to the next index in the buffer to write the next byte
-            */
-            else
-            {
-                receivedDataBufferIndex++;
-            }
+            emitLegacyDeviceData(sample);
         }
+    });
+
+    if(parser.corruptedFrameCount() != previousCorruptedFrames || parser.lostFrameCount() != previousLostFrames)
+    {
+        emit frameErrorsChanged();
     }
-    /*
-     * Check if the received byte is the DEVICE_DATA_FRAME_START_DELIMITER, so we can start
-     * reading the device data into the buffer on the next readAndParseDeviceData() call
-    */
-    else if(read(receivedDataBuffer, 1) && receivedDataBuffer[0] == DEVICE_DATA_FRAME_START_DELIMITER)
+
+    return samples;
+}
+
+void Serial::setFrameProtocol(FrameProtocol frameProtocol)
+{
+    if(parser.frameProtocol() != static_cast<DeviceDataParser::FrameProtocol>(frameProtocol))
+    {
+        parser.setFrameProtocol(static_cast<DeviceDataParser::FrameProtocol>(frameProtocol));
+        emit frameProtocolChanged(frameProtocol);
+    }
+}
+
+void Serial::setLatencyProbes(bool enabled)
+{
+    if(parser.decodeTimestamps() != enabled)
+    {
+        parser.setDecodeTimestamps(enabled);
+        emit latencyProbesChanged(enabled);
+    }
+}
+
+void Serial::setCaptureFile(const QString& captureFile)
+{
+    if(captureFilePath != captureFile)
+    {
+        captureFilePath = captureFile;
+        captureRecorder.close();
+        if(!captureFile.isEmpty())
+        {
+            captureRecorder.open(captureFile);
+        }
+        emit captureFileChanged(captureFile);
+    }
+}
+
+void Serial::setLegacyDeviceDataEnabled(bool enabled)
+{
+    if(legacyDeviceData != enabled)
+    {
+        legacyDeviceData = enabled;
+        emit legacyDeviceDataEnabledChanged(enabled);
+    }
+}
+
+void Serial::emitLegacyDeviceData(const DeviceSample& sample)
+{
+    QList<QVariant> deviceDataOut(2);
+
+    switch (sample.payloadType())
     {
-        startOfDeviceDataFrameReceieved = true;
+        case DeviceSample::PAYLOAD_TYPE_BYTE:
+            deviceDataOut[0] = sample.deviceAddress();
+            deviceDataOut[1] = sample.byteData();
+            break;
+        case DeviceSample::PAYLOAD_TYPE_FLOAT:
+            deviceDataOut[0] = sample.deviceAddress();
+            deviceDataOut[1] = sample.floatData();
+            break;
+        default:
+            // Unknown device address, emitted with empty device data as before
+            break;
     }
 
+    // Emit device data available signal with the device data
+    emit deviceDataAvailable(deviceDataOut);
 }
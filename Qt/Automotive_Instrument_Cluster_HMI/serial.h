@@ -4,43 +4,123 @@
 #include <QSerialPort>
 #include <QVariant>
 #include <QList>
+#include <QByteArray>
+#include "capturefile.h"
+#include "devicedataparser.h"
+#include "devicesample.h"
+#include "ingestionmetrics.h"
 
 class Serial : public QSerialPort
 {
     Q_OBJECT
     Q_PROPERTY(QString portName READ portName WRITE setPortName NOTIFY portNameChanged)
     Q_PROPERTY(QIODeviceBase::OpenMode openMode READ openMode WRITE open NOTIFY openModeChanged)
+    // Opt-in compatibility path: also emit every frame as a QList<QVariant> through [SIGNAL] deviceDataAvailable()
+    Q_PROPERTY(bool legacyDeviceDataEnabled READ legacyDeviceDataEnabled WRITE setLegacyDeviceDataEnabled NOTIFY legacyDeviceDataEnabledChanged)
+    // Record the raw bytes read from the port to this capture file, see CaptureRecorder. Empty to stop recording
+    Q_PROPERTY(QString captureFile READ captureFile WRITE setCaptureFile NOTIFY captureFileChanged)
+    Q_PROPERTY(FrameProtocol frameProtocol READ frameProtocol WRITE setFrameProtocol NOTIFY frameProtocolChanged)
+    // Stamp every sample with its decode time for LatencyProbe, see DeviceDataParser::setDecodeTimestamps()
+    Q_PROPERTY(bool latencyProbes READ latencyProbes WRITE setLatencyProbes NOTIFY latencyProbesChanged)
+    // Frames rejected because of a bad encoding, length or checksum
+    Q_PROPERTY(int corruptedFrames READ corruptedFrames NOTIFY frameErrorsChanged)
+    // Frames missing from the sequence numbers, only counted by FRAME_PROTOCOL_V2
+    Q_PROPERTY(int lostFrames READ lostFrames NOTIFY frameErrorsChanged)
+    // Throughput, frame rate per device and decoding errors of the port, refreshed while metrics.interval is set
+    Q_PROPERTY(IngestionMetrics* metrics READ metrics CONSTANT)
 
 public:
+    // Listed one by one for moc, which doesn't expand DEVICE_PROTOCOL_DEVICES. A device missing here is still decoded, QML just has no name for it
     enum DeviceInternalAddress
     {
-        DEVICE_INTERNAL_ADDRESS_MOTOR			=     0x01,
-        DEVICE_INTERNAL_ADDRESS_ACCELEROMETER	=     0x02,
-        DEVICE_INTERNAL_ADDRESS_LM35			=     0x03
+        DEVICE_INTERNAL_ADDRESS_MOTOR			=     DeviceDataParser::DEVICE_INTERNAL_ADDRESS_MOTOR,
+        DEVICE_INTERNAL_ADDRESS_ACCELEROMETER	=     DeviceDataParser::DEVICE_INTERNAL_ADDRESS_ACCELEROMETER,
+        DEVICE_INTERNAL_ADDRESS_LM35			=     DeviceDataParser::DEVICE_INTERNAL_ADDRESS_LM35
     };
     // Add Q_ENUM to make it callable in the QML side
     Q_ENUM(DeviceInternalAddress)
 
+    // See DeviceDataParser::FrameProtocol
+    enum FrameProtocol
+    {
+        FRAME_PROTOCOL_V1       =     DeviceDataParser::FRAME_PROTOCOL_V1,
+        FRAME_PROTOCOL_V2       =     DeviceDataParser::FRAME_PROTOCOL_V2
+    };
+    Q_ENUM(FrameProtocol)
+
     Serial(QObject* parent = nullptr);
 
     /*
-     * @brief [SLOT] Read and parse device data frame from the serial port
+     * @brief [SLOT] Read and parse all the device data frames available in the serial port
      *
      * This slot is connected to [SIGNAL] QIODevice::readyRead()
-     * And emits [SIGNAL] deviceDataAvailable() when a complete device data frame is received
+     * It drains every byte the OS has handed over and emits [SIGNAL] deviceSampleAvailable() for each complete device data frame in them
      *
      * @return void
     */
     void readAndParseDeviceData();
 
+    /*
+     * @brief Parse a chunk of received bytes, emitting [SIGNAL] deviceSampleAvailable() for each complete device data frame
+     *
+     * Frames may be split across chunks, the parser state is kept between calls
+     *
+     * @param data          Received bytes
+     * @param size          Number of received bytes
+     * @param timestamp     Monotonic arrival time of the chunk in nanoseconds, see DeviceSample::currentTimestamp()
+     *
+     * @return Number of complete device data frames parsed from the chunk
+    */
+    size_t parseDeviceData(const char* data, size_t size, qint64 timestamp);
+
+    bool legacyDeviceDataEnabled() const { return legacyDeviceData; }
+    void setLegacyDeviceDataEnabled(bool enabled);
+
+    QString captureFile() const { return captureFilePath; }
+    void setCaptureFile(const QString& captureFile);
+
+    FrameProtocol frameProtocol() const { return static_cast<FrameProtocol>(parser.frameProtocol()); }
+    /*
+     * @brief Switch the wire format of the received device data frames, any partially received frame is dropped
+     *
+     * @return void
+    */
+    void setFrameProtocol(FrameProtocol frameProtocol);
+
+    bool latencyProbes() const { return parser.decodeTimestamps(); }
+    void setLatencyProbes(bool enabled);
+
+    int corruptedFrames() const { return static_cast<int>(parser.corruptedFrameCount()); }
+    int lostFrames() const { return static_cast<int>(parser.lostFrameCount()); }
+    // Bytes read from the port since it was created
+    quint64 receivedBytes() const { return bytes; }
+    IngestionMetrics* metrics() const { return ingestionMetrics; }
+
 Q_SIGNALS:
     /* These signals (portNameChanged, openModeChanged) are currently not emitted/used, they are mostly here to avoid Qt warnings */
     void portNameChanged(QString portName);
     void openModeChanged(QIODeviceBase::OpenMode openMode);
 
+    void legacyDeviceDataEnabledChanged(bool enabled);
+    void frameProtocolChanged(Serial::FrameProtocol frameProtocol);
+    void captureFileChanged(QString captureFile);
+    void latencyProbesChanged(bool enabled);
+    void frameErrorsChanged();
+
     /*
      * @brief [SIGNAL] Emitted/Called whenever a complete device data frame is read
      *
+     * @param sample The decoded device data, carried by value without any heap allocation
+     *
+     * @return void
+    */
+    void deviceSampleAvailable(DeviceSample sample);
+
+    /*
+     * @brief [SIGNAL] Emitted/Called whenever a complete device data frame is read, only when legacyDeviceDataEnabled is set
+     *
+     * Kept for compatibility, it allocates a list and boxes the device data for every frame. Prefer deviceSampleAvailable()
+     *
      * @param deviceData { DeviceAddress, DeviceData }. Where DeviceData can be a byte or a float depending on which DeviceAddress is it
      *
      * @return void
@@ -49,16 +129,20 @@ Q_SIGNALS:
 
 private:
     /*
-     * Buffer size = Max device data frame size:
-     *          1 byte for the device address, 4 bytes max for devices's data(as float is 4 bytes) ,or 1 byte, and 1 byte for the DEVICE_DATA_FRAME_END_DELIMITER
+     * @brief Set up the device sample in the legacy device output format and emit [SIGNAL] deviceDataAvailable(deviceOutput)
      *
-     * Note that DEVICE_DATA_FRAME_START_DELIMITER gets always overridden in the buffer by the first
-     * byte of the device data, as such there is no space allocated in the buffer for it.
+     * @return void
     */
-    char receivedDataBuffer[6] = { 0 };
-    size_t receivedDataBufferIndex = 0;
-    // Indication when true that data is being written to receivedDataBuffer
-    bool startOfDeviceDataFrameReceieved = false;
+    void emitLegacyDeviceData(const DeviceSample& sample);
+
+    DeviceDataParser parser;
+    // Reused between reads, so draining the port doesn't allocate once it has grown to the typical chunk size
+    QByteArray readBuffer;
+    bool legacyDeviceData = false;
+    quint64 bytes = 0;
+    QString captureFilePath;
+    CaptureRecorder captureRecorder;
+    IngestionMetrics* ingestionMetrics;
 };
 
 #endif // SERIAL_H
@@ -0,0 +1,120 @@
+#include "serialworker.h"
+#include <QSerialPort>
+
+SerialWorker::SerialWorker(SpscRingBuffer<DeviceSample>* sampleRing, QObject* parent) : QObject(parent), ring(sampleRing)
+{
+}
+
+size_t SerialWorker::ingest(const char* data, size_t size, qint64 timestamp)
+{
+    size_t pushed = 0;
+    size_t dropped = 0;
+
+    parser.setDecodeTimestamps(decodeTimestamps.load(std::memory_order_relaxed));
+
+    parser.parse(data, size, timestamp, [this, &pushed, &dropped](const DeviceSample& sample)
+    {
+        if(ring->push(sample))
+        {
+            pushed++;
+        }
+        else
+        {
+            dropped++;
+        }
+    });
+
+    if(dropped)
+    {
+        parser.counters().addDroppedSamples(dropped);
+    }
+
+    if(pushed)
+    {
+        pushedSamples.fetch_add(pushed, std::memory_order_relaxed);
+
+        // Wake the consumer only once per drain, not once per chunk
+        if(!wakePending.exchange(true, std::memory_order_acq_rel))
+        {
+            emit samplesAvailable();
+        }
+    }
+
+    return pushed;
+}
+
+void SerialWorker::open(const QString& portName, qint32 baudRate, int frameProtocol)
+{
+    close();
+
+    parser.setFrameProtocol(static_cast<DeviceDataParser::FrameProtocol>(frameProtocol));
+
+    // Created here so the port and its notifiers live on the worker thread
+    port = new QSerialPort(this);
+    port->setPortName(portName);
+    port->setBaudRate(baudRate);
+    port->setDataBits(QSerialPort::Data8);
+    port->setParity(QSerialPort::NoParity);
+    port->setStopBits(QSerialPort::OneStop);
+    QObject::connect(port, &QIODevice::readyRead, this, &SerialWorker::readAndParseDeviceData);
+
+    if(port->open(QIODevice::ReadWrite))
+    {
+        // A device removed while opened (unplugged USB adapter or cable) leaves a dead port, close it so the owner can reconnect
+        QObject::connect(port, &QSerialPort::errorOccurred, this, [this](QSerialPort::SerialPortError error)
+        {
+            if(error == QSerialPort::ResourceError)
+            {
+                emit errorOccurred(port->errorString());
+                // Not from within the port's own signal, close() deletes it
+                QMetaObject::invokeMethod(this, &SerialWorker::close, Qt::QueuedConnection);
+            }
+        });
+        emit openChanged(true);
+    }
+    else
+    {
+        emit errorOccurred(port->errorString());
+        delete port;
+        port = nullptr;
+    }
+}
+
+void SerialWorker::close()
+{
+    if(port)
+    {
+        port->close();
+        delete port;
+        port = nullptr;
+        if(captureRecorder)
+        {
+            captureRecorder->flush();
+        }
+        emit openChanged(false);
+    }
+}
+
+void SerialWorker::readAndParseDeviceData()
+{
+    // Drain everything available in one go, see Serial::readAndParseDeviceData()
+    const qint64 availableBytes = port->bytesAvailable();
+    if(availableBytes <= 0)
+    {
+        return;
+    }
+
+    // All the frames completed by this chunk share its arrival time
+    const qint64 timestamp = DeviceSample::currentTimestamp();
+
+    readBuffer.resize(availableBytes);
+    const qint64 readBytes = port->read(readBuffer.data(), availableBytes);
+    if(readBytes > 0)
+    {
+        if(captureRecorder)
+        {
+            captureRecorder->record(readBuffer.constData(), static_cast<size_t>(readBytes), timestamp);
+        }
+        ingest(readBuffer.constData(), static_cast<size_t>(readBytes), timestamp);
+    }
+}
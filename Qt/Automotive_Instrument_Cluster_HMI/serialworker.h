@@ -0,0 +1,130 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include "capturefile.h"
+#include "devicedataparser.h"
+#include "devicesample.h"
+#include "spscringbuffer.h"
+
+class QSerialPort;
+
+/*
+ * Reads and parses a serial port on a dedicated I/O thread.
+ *
+ * Decoded samples are pushed into a SpscRingBuffer owned by the consumer (see ThreadedSerial), the worker never waits for it.
+ * Samples that don't fit in a full ring are dropped and counted, so a stalled consumer can't slow down ingestion.
+ *
+ * All the slots must run on the worker thread, the port is created there on open().
+*/
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    SerialWorker(SpscRingBuffer<DeviceSample>* sampleRing, QObject* parent = nullptr);
+
+    /*
+     * @brief Parse a chunk of received bytes and push every decoded sample into the ring
+     *
+     * Called for every chunk read from the port, it's also the entry point to feed bytes from another source
+     *
+     * @param data          Received bytes
+     * @param size          Number of received bytes
+     * @param timestamp     Monotonic arrival time of the chunk in nanoseconds, see DeviceSample::currentTimestamp()
+     *
+     * @return Number of samples pushed into the ring
+    */
+    size_t ingest(const char* data, size_t size, qint64 timestamp);
+
+    /*
+     * @brief Re-arm samplesAvailable(). Called by the consumer right before it drains the ring
+     *
+     * Thread safe
+     *
+     * @return void
+    */
+    void acknowledgeSamples() { wakePending.store(false, std::memory_order_release); }
+
+    /*
+     * @brief Stamp the samples with their decode time, see DeviceDataParser::setDecodeTimestamps(). Applied from the next chunk
+     *
+     * Thread safe
+     *
+     * @return void
+    */
+    void setDecodeTimestamps(bool enabled) { decodeTimestamps.store(enabled, std::memory_order_relaxed); }
+
+    /*
+     * @brief Tag the samples with the id of their port, see DeviceSample::sourceId(). Must be called before the worker is moved to its thread
+     *
+     * @return void
+    */
+    void setSourceId(uint8_t sourceId) { parser.setSourceId(sourceId); }
+
+    /*
+     * @brief Record the raw bytes read from the port to a capture, none if null. Must be called before the worker is moved to its thread
+     *
+     * The recorder is owned by the caller, so the capture outlives the worker (see ThreadedSerial), and must only be used by it again
+     * once the worker thread is stopped
+     *
+     * @return void
+    */
+    void setCaptureRecorder(CaptureRecorder* recorder) { captureRecorder = recorder; }
+
+    // Thread safe counters
+    quint64 ingestedSamples() const { return pushedSamples.load(std::memory_order_relaxed); }
+    quint64 droppedSamples() const { return parser.counters().droppedSampleCount(); }
+    // Bytes, frames and errors of the port, thread safe. Valid as long as the worker
+    const IngestionCounters& counters() const { return parser.counters(); }
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Open the port with 8 data bits, no parity and 1 stop bit. Any previously opened port is closed first
+     *
+     * @return void
+    */
+    void open(const QString& portName, qint32 baudRate, int frameProtocol);
+
+    /*
+     * @brief [SLOT] Close the port if opened. The capture, if any, is flushed but stays open
+     *
+     * @return void
+    */
+    void close();
+
+Q_SIGNALS:
+    /*
+     * @brief [SIGNAL] Emitted once new samples are in the ring, then not again until acknowledgeSamples() is called
+     *
+     * @return void
+    */
+    void samplesAvailable();
+
+    void openChanged(bool open);
+    void errorOccurred(const QString& errorString);
+
+private:
+    /*
+     * @brief [SLOT] Drain the port into the parser. Connected to [SIGNAL] QIODevice::readyRead()
+     *
+     * @return void
+    */
+    void readAndParseDeviceData();
+
+    SpscRingBuffer<DeviceSample>* ring;
+    QSerialPort* port = nullptr;
+    DeviceDataParser parser;
+    // Reused between reads, so draining the port doesn't allocate once it has grown to the typical chunk size
+    QByteArray readBuffer;
+    CaptureRecorder* captureRecorder = nullptr;
+
+    std::atomic<bool> wakePending { false };
+    std::atomic<bool> decodeTimestamps { false };
+    std::atomic<quint64> pushedSamples { 0 };
+};
+
+#endif // SERIALWORKER_H
@@ -0,0 +1,98 @@
+#ifndef SHAREDSTATELAYOUT_H
+#define SHAREDSTATELAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Layout of the POSIX shared memory segment the application publishes the vehicle state to, see SharedStateWriter and SharedStateReader.
+ *
+ *  - SharedStateSegment: header, then the latest SharedVehicleState behind a seqlock
+ *  - then ringCapacity SharedSamples, the most recent decoded samples, overwritten oldest first
+ *
+ * There is one writer and any number of readers, the writer never waits for them. Everything readers may see while it's written
+ * is stored as relaxed 64-bit atomics, so a torn read is detected (and retried or dropped) rather than being a data race.
+ * Only for processes on the same machine and build of this header: the values are native endian.
+*/
+
+#define SHARED_STATE_MAGIC "AICHSHM"
+#define SHARED_STATE_VERSION 1
+// Segment name passed to shm_open(), see SharedStatePublisher::name
+#define SHARED_STATE_DEFAULT_NAME "/automotive_cluster_state"
+
+// Latest published gauge values, see ClusterState
+struct SharedVehicleState
+{
+    // Arrival time of the newest sample in the values, see DeviceSample::timestamp()
+    int64_t timestamp;
+    // Speed in Km/h
+    double speed;
+    // Accelerometer in (G)s
+    double accelerometer;
+    // Temperature in Celsius
+    double temperature;
+    // Motor PWM duty cycle
+    int32_t motorDuty;
+    uint32_t reserved;
+    // Publishes since the writer opened the segment, 0 if the values were never published
+    uint64_t publishCount;
+};
+
+// A decoded device sample, same fields as a SampleWriter binary record
+struct SharedSample
+{
+    // Arrival time in nanoseconds, see DeviceSample::timestamp()
+    int64_t timestamp;
+    float value;
+    uint8_t deviceAddress;
+    // DeviceSample::PayloadType
+    uint8_t payloadType;
+    uint8_t sourceId;
+    uint8_t reserved;
+};
+
+constexpr size_t SHARED_VEHICLE_STATE_WORDS = sizeof(SharedVehicleState) / sizeof(uint64_t);
+constexpr size_t SHARED_SAMPLE_WORDS = sizeof(SharedSample) / sizeof(uint64_t);
+
+static_assert(sizeof(SharedVehicleState) % sizeof(uint64_t) == 0, "SharedVehicleState must be copied as whole words");
+static_assert(sizeof(SharedSample) == 2 * sizeof(uint64_t), "SharedSample must be copied as whole words");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Atomics shared between processes must be lock-free");
+
+struct SharedStateSegment
+{
+    enum WriterState : uint64_t
+    {
+        // Being set up, nothing valid yet
+        WRITER_STATE_STARTING,
+        WRITER_STATE_LIVE,
+        // The writer closed the segment, a new one may have replaced it under the same name
+        WRITER_STATE_CLOSED
+    };
+
+    char magic[8];
+    uint32_t version;
+    // Number of samples in the ring, a power of two
+    uint32_t ringCapacity;
+    std::atomic<uint64_t> writerState;
+    // Process of the writer, so a segment left by one that crashed can be told from one in use. Set before the writer goes live
+    std::atomic<int64_t> writerPid;
+
+    // Odd while the writer updates the state
+    alignas(64) std::atomic<uint64_t> stateSequence;
+    std::atomic<uint64_t> state[SHARED_VEHICLE_STATE_WORDS];
+
+    // Samples pushed so far, sample i is in slot i % ringCapacity
+    alignas(64) std::atomic<uint64_t> ringHead;
+    // Samples being pushed or pushed. Ahead of ringHead while the slot of sample ringHead is written, i.e. sample ringHead - ringCapacity is overwritten
+    std::atomic<uint64_t> ringClaimed;
+
+    // The ring follows the header, on its own cache line
+    std::atomic<uint64_t>* ring() { return reinterpret_cast<std::atomic<uint64_t>*>(reinterpret_cast<char*>(this) + ringOffset()); }
+    const std::atomic<uint64_t>* ring() const { return reinterpret_cast<const std::atomic<uint64_t>*>(reinterpret_cast<const char*>(this) + ringOffset()); }
+
+    static constexpr size_t ringOffset() { return (sizeof(SharedStateSegment) + 63) / 64 * 64; }
+    static constexpr size_t size(uint32_t ringCapacity) { return ringOffset() + size_t(ringCapacity) * sizeof(SharedSample); }
+};
+
+#endif // SHAREDSTATELAYOUT_H
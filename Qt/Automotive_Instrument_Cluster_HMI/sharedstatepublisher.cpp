@@ -0,0 +1,147 @@
+#include "sharedstatepublisher.h"
+
+SharedStatePublisher::SharedStatePublisher(QObject* parent) : QObject(parent)
+{
+}
+
+void SharedStatePublisher::setName(const QString& name)
+{
+    if(segmentName != name)
+    {
+        segmentName = name;
+        emit nameChanged(name);
+        applySettings();
+    }
+}
+
+void SharedStatePublisher::setRingCapacity(int ringCapacity)
+{
+    if(capacity != ringCapacity && ringCapacity > 0)
+    {
+        capacity = ringCapacity;
+        emit ringCapacityChanged(ringCapacity);
+        applySettings();
+    }
+}
+
+void SharedStatePublisher::setClusterState(ClusterState* clusterState)
+{
+    if(state == clusterState)
+    {
+        return;
+    }
+
+    QObject::disconnect(stateConnection);
+    state = clusterState;
+    if(state)
+    {
+        stateConnection = QObject::connect(state, &ClusterState::valuesPublished, this, &SharedStatePublisher::writeState);
+    }
+    emit clusterStateChanged(clusterState);
+}
+
+void SharedStatePublisher::setSource(QObject* source)
+{
+    if(sampleSource == source)
+    {
+        return;
+    }
+
+    QObject::disconnect(sourceConnection);
+    sampleSource = source;
+    if(sampleSource)
+    {
+        // String based, so any object with the signal can feed the ring
+        sourceConnection = QObject::connect(sampleSource, SIGNAL(deviceSampleAvailable(DeviceSample)), this, SLOT(addSample(DeviceSample)));
+        if(!sourceConnection)
+        {
+            qWarning("SharedStatePublisher: source has no deviceSampleAvailable(DeviceSample) signal");
+        }
+    }
+    emit sourceChanged(source);
+}
+
+void SharedStatePublisher::setActive(bool active)
+{
+    if(activeRequested != active)
+    {
+        activeRequested = active;
+        emit activeChanged(active);
+        applySettings();
+    }
+}
+
+void SharedStatePublisher::componentComplete()
+{
+    // Open with the final settings, rather than once per property assigned from QML
+    componentCompleted = true;
+    applySettings();
+}
+
+void SharedStatePublisher::addSample(const DeviceSample& sample)
+{
+    if(!writer.isOpen())
+    {
+        return;
+    }
+
+    SharedSample sharedSample;
+    sharedSample.timestamp = sample.timestamp();
+    sharedSample.value = static_cast<float>(sample.value());
+    sharedSample.deviceAddress = static_cast<uint8_t>(sample.deviceAddress());
+    sharedSample.payloadType = static_cast<uint8_t>(sample.payloadType());
+    sharedSample.sourceId = static_cast<uint8_t>(sample.sourceId());
+    sharedSample.reserved = 0;
+    writer.pushSample(sharedSample);
+}
+
+void SharedStatePublisher::applySettings()
+{
+    if(!componentCompleted)
+    {
+        return;
+    }
+
+    const bool wasOpen = writer.isOpen();
+    writer.close();
+    publishCount = 0;
+
+    if(activeRequested)
+    {
+        if(writer.open(segmentName.toLocal8Bit().constData(), static_cast<uint32_t>(capacity)))
+        {
+            // Readers get the current values right away rather than on the next change
+            if(state)
+            {
+                writeState(0);
+            }
+        }
+        else
+        {
+            qWarning("SharedStatePublisher: can't create %s: %s", qPrintable(segmentName), writer.errorString().c_str());
+        }
+    }
+
+    if(wasOpen != writer.isOpen())
+    {
+        emit isOpenChanged(writer.isOpen());
+    }
+}
+
+void SharedStatePublisher::writeState(qint64 receivedTimestamp)
+{
+    if(!writer.isOpen())
+    {
+        return;
+    }
+
+    SharedVehicleState sharedState;
+    sharedState.timestamp = receivedTimestamp;
+    sharedState.speed = state->speed();
+    sharedState.accelerometer = state->accelerometer();
+    sharedState.temperature = state->temperature();
+    sharedState.motorDuty = state->motorDuty();
+    sharedState.reserved = 0;
+    sharedState.publishCount = ++publishCount;
+    writer.writeState(sharedState);
+}
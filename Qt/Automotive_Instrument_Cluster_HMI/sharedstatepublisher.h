@@ -0,0 +1,105 @@
+#ifndef SHAREDSTATEPUBLISHER_H
+#define SHAREDSTATEPUBLISHER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQmlParserStatus>
+#include <QString>
+#include "clusterstate.h"
+#include "devicesample.h"
+#include "sharedstatewriter.h"
+
+/*
+ * Publishes the vehicle state to a POSIX shared memory segment, for other processes to read without opening the serial port.
+ *
+ * The gauge values are written to the seqlock state record every time the ClusterState publishes them, i.e. at most once per
+ * displayed frame, and every sample of the source is appended to the ring of recent samples. Both are a handful of stores on
+ * the GUI thread, readers never hold them up. See sharedstatelayout.h for the layout and SharedStateReader for the reader library.
+ *
+ * POSIX only, the segment can't be created elsewhere.
+*/
+class SharedStatePublisher : public QObject, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+    // Segment name for shm_open(), starting with '/'. Reopens the segment
+    Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
+    // Number of recent samples kept in the ring, rounded up to a power of two. Reopens the segment
+    Q_PROPERTY(int ringCapacity READ ringCapacity WRITE setRingCapacity NOTIFY ringCapacityChanged)
+    // Values written to the state record
+    Q_PROPERTY(ClusterState* clusterState READ clusterState WRITE setClusterState NOTIFY clusterStateChanged)
+    // Object emitting deviceSampleAvailable(DeviceSample) whose samples go to the ring, e.g. Serial or SourceManager
+    Q_PROPERTY(QObject* source READ source WRITE setSource NOTIFY sourceChanged)
+    // Create the segment when true, remove it when false
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(bool isOpen READ isOpen NOTIFY isOpenChanged)
+
+public:
+    SharedStatePublisher(QObject* parent = nullptr);
+
+    QString name() const { return segmentName; }
+    void setName(const QString& name);
+
+    int ringCapacity() const { return capacity; }
+    void setRingCapacity(int ringCapacity);
+
+    ClusterState* clusterState() const { return state; }
+    void setClusterState(ClusterState* clusterState);
+
+    QObject* source() const { return sampleSource; }
+    void setSource(QObject* source);
+
+    bool active() const { return activeRequested; }
+    void setActive(bool active);
+
+    bool isOpen() const { return writer.isOpen(); }
+
+    void classBegin() override { componentCompleted = false; }
+    void componentComplete() override;
+
+public Q_SLOTS:
+    /*
+     * @brief [SLOT] Append a sample to the ring
+     *
+     * @return void
+    */
+    void addSample(const DeviceSample& sample);
+
+Q_SIGNALS:
+    void nameChanged(QString name);
+    void ringCapacityChanged(int ringCapacity);
+    void clusterStateChanged(ClusterState* clusterState);
+    void sourceChanged(QObject* source);
+    void activeChanged(bool active);
+    void isOpenChanged(bool isOpen);
+
+private:
+    /*
+     * @brief (Re)create the segment with the current settings, or remove it if not active
+     *
+     * @return void
+    */
+    void applySettings();
+
+    /*
+     * @brief [SLOT] Write the values the ClusterState just published to the state record
+     *
+     * @return void
+    */
+    void writeState(qint64 receivedTimestamp);
+
+    QString segmentName = QStringLiteral(SHARED_STATE_DEFAULT_NAME);
+    int capacity = 4096;
+    bool activeRequested = false;
+    bool componentCompleted = true;
+
+    SharedStateWriter writer;
+    quint64 publishCount = 0;
+
+    QPointer<ClusterState> state;
+    QMetaObject::Connection stateConnection;
+    QPointer<QObject> sampleSource;
+    QMetaObject::Connection sourceConnection;
+};
+
+#endif // SHAREDSTATEPUBLISHER_H
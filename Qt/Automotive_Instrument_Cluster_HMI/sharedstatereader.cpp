@@ -0,0 +1,151 @@
+#include "sharedstatereader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Attempts at a consistent state copy before giving up, a writer killed mid-update leaves the sequence odd for good
+#define MAX_STATE_READ_ATTEMPTS 100000
+
+bool SharedStateReader::open(const char* name)
+{
+    close();
+
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if(fd < 0)
+    {
+        lastError = std::string("shm_open: ") + strerror(errno);
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < SharedStateSegment::size(0))
+    {
+        lastError = "not a shared state segment";
+        ::close(fd);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(status.st_size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(address == MAP_FAILED)
+    {
+        lastError = std::string("mmap: ") + strerror(errno);
+        return false;
+    }
+
+    const SharedStateSegment* mapped = static_cast<const SharedStateSegment*>(address);
+    // The writer sets up the header before going live
+    const bool live = mapped->writerState.load(std::memory_order_acquire) != SharedStateSegment::WRITER_STATE_STARTING;
+    if(!live || memcmp(mapped->magic, SHARED_STATE_MAGIC, sizeof(mapped->magic)) != 0 || mapped->version != SHARED_STATE_VERSION
+       || size < SharedStateSegment::size(mapped->ringCapacity))
+    {
+        lastError = live ? "not a version " + std::to_string(SHARED_STATE_VERSION) + " shared state segment" : "segment not ready";
+        munmap(address, size);
+        return false;
+    }
+
+    segment = mapped;
+    segmentSize = size;
+    lastError.clear();
+    return true;
+}
+
+void SharedStateReader::close()
+{
+    if(segment)
+    {
+        munmap(const_cast<SharedStateSegment*>(segment), segmentSize);
+        segment = nullptr;
+        segmentSize = 0;
+    }
+}
+
+bool SharedStateReader::isWriterLive() const
+{
+    return segment && segment->writerState.load(std::memory_order_acquire) == SharedStateSegment::WRITER_STATE_LIVE;
+}
+
+bool SharedStateReader::readState(SharedVehicleState& state) const
+{
+    uint64_t words[SHARED_VEHICLE_STATE_WORDS];
+
+    for(int attempt = 0; attempt < MAX_STATE_READ_ATTEMPTS; attempt++)
+    {
+        const uint64_t sequence = segment->stateSequence.load(std::memory_order_acquire);
+        if(sequence & 1)
+        {
+            // Mid-update
+            continue;
+        }
+
+        for(size_t i = 0; i < SHARED_VEHICLE_STATE_WORDS; i++)
+        {
+            words[i] = segment->state[i].load(std::memory_order_relaxed);
+        }
+
+        // Keeps the word loads before the sequence check
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(segment->stateSequence.load(std::memory_order_relaxed) == sequence)
+        {
+            memcpy(&state, words, sizeof(state));
+            return state.publishCount != 0;
+        }
+    }
+
+    return false;
+}
+
+size_t SharedStateReader::readSamples(uint64_t& cursor, SharedSample* samples, size_t maxCount, uint64_t* missed) const
+{
+    const uint64_t capacity = segment->ringCapacity;
+    const uint64_t mask = capacity - 1;
+    const std::atomic<uint64_t>* ring = segment->ring();
+
+    const uint64_t head = segment->ringHead.load(std::memory_order_acquire);
+    const uint64_t oldest = head > capacity ? head - capacity : 0;
+    uint64_t first = std::max(cursor, oldest);
+    const uint64_t end = std::min(head, first + maxCount);
+    if(first >= end)
+    {
+        cursor = std::max(cursor, first);
+        return 0;
+    }
+
+    uint64_t words[SHARED_SAMPLE_WORDS];
+    for(uint64_t index = first; index < end; index++)
+    {
+        const std::atomic<uint64_t>* slot = ring + (index & mask) * SHARED_SAMPLE_WORDS;
+        for(size_t i = 0; i < SHARED_SAMPLE_WORDS; i++)
+        {
+            words[i] = slot[i].load(std::memory_order_relaxed);
+        }
+        memcpy(&samples[index - first], words, sizeof(SharedSample));
+    }
+
+    // Samples whose slot the writer claimed again meanwhile may be torn, they are dropped
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t claimed = segment->ringClaimed.load(std::memory_order_relaxed);
+    const uint64_t firstValid = claimed > capacity ? claimed - capacity : 0;
+
+    size_t copied = static_cast<size_t>(end - first);
+    if(firstValid > first)
+    {
+        const size_t torn = static_cast<size_t>(std::min(firstValid, end) - first);
+        memmove(samples, samples + torn, (copied - torn) * sizeof(SharedSample));
+        copied -= torn;
+        first += torn;
+    }
+
+    // Starting from 0 means from the oldest sample available, whatever came before isn't missed
+    if(missed && cursor != 0)
+    {
+        *missed += first - std::min(cursor, first);
+    }
+    cursor = end;
+    return copied;
+}
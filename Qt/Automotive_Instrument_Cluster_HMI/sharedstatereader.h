@@ -0,0 +1,79 @@
+#ifndef SHAREDSTATEREADER_H
+#define SHAREDSTATEREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "sharedstatelayout.h"
+
+/*
+ * Reader side of the shared vehicle state segment, for other processes on the cluster computer (logger, diagnostics, test harness).
+ * POSIX only, no Qt dependency: build it from tools/sharedstatereader as a static library.
+ *
+ * The segment is mapped read-only and read in place. Readers never block the writer nor each other: a state copy torn by
+ * a concurrent write is retried, samples overwritten while being copied are dropped and counted.
+ *
+ * A reader is meant to be used by one thread at a time, open one per thread.
+*/
+class SharedStateReader
+{
+public:
+    SharedStateReader() = default;
+    ~SharedStateReader() { close(); }
+    SharedStateReader(const SharedStateReader&) = delete;
+    SharedStateReader& operator=(const SharedStateReader&) = delete;
+
+    /*
+     * @brief Map the segment written by the application, see SharedStatePublisher. Any previously opened segment is closed first
+     *
+     * @param name  Segment name for shm_open(), starting with '/'
+     *
+     * @return false if the segment doesn't exist (yet) or isn't a compatible one, see errorString()
+    */
+    bool open(const char* name = SHARED_STATE_DEFAULT_NAME);
+
+    /*
+     * @brief Unmap the segment
+     *
+     * @return void
+    */
+    void close();
+
+    bool isOpen() const { return segment != nullptr; }
+    // Reason of the last open() failure
+    const std::string& errorString() const { return lastError; }
+
+    // false once the writer closed the segment, e.g. the application quit or restarted. open() again to follow a new one
+    bool isWriterLive() const;
+
+    /*
+     * @brief Copy the latest vehicle state
+     *
+     * Retries while the writer is updating it, which only lasts a few word stores
+     *
+     * @return false if the state was never published, or the writer died while updating it
+    */
+    bool readState(SharedVehicleState& state) const;
+
+    /*
+     * @brief Copy the samples pushed since the last call, oldest first
+     *
+     * @param cursor        Index of the next sample to read, 0 to start from the oldest one in the ring. Advanced past the samples read
+     * @param samples       Receives up to maxCount samples
+     * @param maxCount      Size of samples
+     * @param missed        If not null, incremented by the samples overwritten before they could be read
+     *
+     * @return Number of samples copied
+    */
+    size_t readSamples(uint64_t& cursor, SharedSample* samples, size_t maxCount, uint64_t* missed = nullptr) const;
+
+    // Number of samples kept in the ring, 0 if not opened
+    uint32_t ringCapacity() const { return segment ? segment->ringCapacity : 0; }
+
+private:
+    const SharedStateSegment* segment = nullptr;
+    size_t segmentSize = 0;
+    std::string lastError;
+};
+
+#endif // SHAREDSTATEREADER_H
@@ -0,0 +1,203 @@
+#include "sharedstatewriter.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // Unlink a segment name only if it still refers to the given segment, another writer may have replaced it since
+    void unlinkSegment(const char* name, dev_t device, ino_t inode)
+    {
+        const int fd = shm_open(name, O_RDONLY, 0);
+        if(fd < 0)
+        {
+            return;
+        }
+
+        struct stat status;
+        const bool sameSegment = fstat(fd, &status) == 0 && status.st_dev == device && status.st_ino == inode;
+        ::close(fd);
+        if(sameSegment)
+        {
+            shm_unlink(name);
+        }
+    }
+
+    /*
+     * @brief Unlink an existing segment if its writer is gone, e.g. it crashed or was killed before close()
+     *
+     * @param inUse     Why the segment was kept, when it's still in use
+     *
+     * @return false if the segment is kept
+    */
+    bool removeAbandonedSegment(const char* name, std::string& inUse)
+    {
+        const int fd = shm_open(name, O_RDONLY, 0);
+        if(fd < 0)
+        {
+            // Unlinked meanwhile
+            if(errno == ENOENT)
+            {
+                return true;
+            }
+            inUse = std::string("shm_open: ") + strerror(errno);
+            return false;
+        }
+
+        struct stat status;
+        bool valid = false;
+        uint64_t writerState = SharedStateSegment::WRITER_STATE_STARTING;
+        int64_t writerPid = 0;
+        if(fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= SharedStateSegment::size(0))
+        {
+            void* address = mmap(nullptr, SharedStateSegment::size(0), PROT_READ, MAP_SHARED, fd, 0);
+            if(address != MAP_FAILED)
+            {
+                const SharedStateSegment* existing = static_cast<const SharedStateSegment*>(address);
+                valid = memcmp(existing->magic, SHARED_STATE_MAGIC, sizeof(existing->magic)) == 0 && existing->version == SHARED_STATE_VERSION;
+                writerState = existing->writerState.load(std::memory_order_acquire);
+                writerPid = existing->writerPid.load(std::memory_order_relaxed);
+                munmap(address, SharedStateSegment::size(0));
+            }
+        }
+        ::close(fd);
+
+        // Without a pid it's not ours, or a writer is still setting it up
+        if(!valid || writerPid <= 0)
+        {
+            inUse = std::string(name) + " exists and is not a shared state segment, or is being created";
+            return false;
+        }
+
+        // EPERM: alive, under another user
+        const bool writerGone = writerState == SharedStateSegment::WRITER_STATE_CLOSED
+                                || (kill(static_cast<pid_t>(writerPid), 0) != 0 && errno == ESRCH);
+        if(!writerGone)
+        {
+            inUse = std::string(name) + " is published by the running process " + std::to_string(writerPid);
+            return false;
+        }
+
+        unlinkSegment(name, status.st_dev, status.st_ino);
+        return true;
+    }
+}
+
+bool SharedStateWriter::open(const char* name, uint32_t ringCapacity)
+{
+    close();
+
+    uint32_t capacity = 1;
+    while(capacity < ringCapacity && capacity < (1u << 30))
+    {
+        capacity <<= 1;
+    }
+
+    // Never takes over a segment of a live writer, only replaces one left by a writer that is gone.
+    // The segments unlinked below when failing are this writer's own
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd < 0 && errno == EEXIST)
+    {
+        std::string inUse;
+        if(!removeAbandonedSegment(name, inUse))
+        {
+            lastError = "shm_open: " + inUse;
+            return false;
+        }
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if(fd < 0)
+    {
+        lastError = std::string("shm_open: ") + strerror(errno);
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(fd, &status) != 0)
+    {
+        lastError = std::string("fstat: ") + strerror(errno);
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    const size_t size = SharedStateSegment::size(capacity);
+    if(ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        lastError = std::string("ftruncate: ") + strerror(errno);
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping stays valid without the descriptor
+    ::close(fd);
+    if(address == MAP_FAILED)
+    {
+        lastError = std::string("mmap: ") + strerror(errno);
+        shm_unlink(name);
+        return false;
+    }
+
+    // ftruncate() zero filled it, which is a valid initial state for every atomic
+    segment = new(address) SharedStateSegment;
+    segment->writerPid.store(getpid(), std::memory_order_relaxed);
+    memcpy(segment->magic, SHARED_STATE_MAGIC, sizeof(segment->magic));
+    segment->version = SHARED_STATE_VERSION;
+    segment->ringCapacity = capacity;
+    ring = segment->ring();
+    ringMask = capacity - 1;
+    segmentSize = size;
+    segmentName = name;
+    segmentDevice = status.st_dev;
+    segmentInode = status.st_ino;
+    lastError.clear();
+
+    // Last, readers check it before anything else
+    segment->writerState.store(SharedStateSegment::WRITER_STATE_LIVE, std::memory_order_release);
+    return true;
+}
+
+void SharedStateWriter::close()
+{
+    if(!segment)
+    {
+        return;
+    }
+
+    segment->writerState.store(SharedStateSegment::WRITER_STATE_CLOSED, std::memory_order_release);
+    munmap(segment, segmentSize);
+
+    unlinkSegment(segmentName.c_str(), static_cast<dev_t>(segmentDevice), static_cast<ino_t>(segmentInode));
+
+    segment = nullptr;
+    ring = nullptr;
+    segmentSize = 0;
+    segmentName.clear();
+    segmentDevice = 0;
+    segmentInode = 0;
+}
+
+#else
+
+bool SharedStateWriter::open(const char* name, uint32_t ringCapacity)
+{
+    (void)name;
+    (void)ringCapacity;
+    lastError = "POSIX shared memory isn't available on this platform";
+    return false;
+}
+
+void SharedStateWriter::close()
+{
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef SHAREDSTATEWRITER_H
+#define SHAREDSTATEWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "sharedstatelayout.h"
+
+/*
+ * Writer side of the shared vehicle state segment, see sharedstatelayout.h. POSIX only, open() fails elsewhere.
+ *
+ * Writing never waits for the readers: the state is a seqlock, readers retry a copy torn by a concurrent write,
+ * and the sample ring is overwritten oldest first, readers drop the samples overwritten while they copied them.
+ * Writing the state costs two sequence increments and a few word stores, pushing a sample two word stores and the head.
+ *
+ * Single writer: the methods must be called from one thread at a time.
+*/
+class SharedStateWriter
+{
+public:
+    SharedStateWriter() = default;
+    ~SharedStateWriter() { close(); }
+    SharedStateWriter(const SharedStateWriter&) = delete;
+    SharedStateWriter& operator=(const SharedStateWriter&) = delete;
+
+    /*
+     * @brief Create the segment. Any previously opened segment is closed first
+     *
+     * A segment of the same name left by a writer that is gone (crashed or killed) is replaced. Fails if its writer is still running,
+     * rather than taking the segment over
+     *
+     * @param name          Segment name for shm_open(), starting with '/'
+     * @param ringCapacity  Number of recent samples kept, rounded up to a power of two
+     *
+     * @return false on failure, see errorString()
+    */
+    bool open(const char* name, uint32_t ringCapacity);
+
+    /*
+     * @brief Mark the segment closed for the readers, unmap it and unlink its name, unless the name now refers to another segment
+     *
+     * @return void
+    */
+    void close();
+
+    bool isOpen() const { return segment != nullptr; }
+    // Reason of the last open() failure
+    const std::string& errorString() const { return lastError; }
+
+    /*
+     * @brief Publish the latest vehicle state
+     *
+     * @return void
+    */
+    void writeState(const SharedVehicleState& state)
+    {
+        uint64_t words[SHARED_VEHICLE_STATE_WORDS];
+        memcpy(words, &state, sizeof(words));
+
+        // Odd while writing. The release fence keeps the words from being seen before the odd sequence
+        const uint64_t sequence = segment->stateSequence.load(std::memory_order_relaxed);
+        segment->stateSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for(size_t i = 0; i < SHARED_VEHICLE_STATE_WORDS; i++)
+        {
+            segment->state[i].store(words[i], std::memory_order_relaxed);
+        }
+        segment->stateSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /*
+     * @brief Append a sample to the ring, overwriting the oldest one once full
+     *
+     * @return void
+    */
+    void pushSample(const SharedSample& sample)
+    {
+        uint64_t words[SHARED_SAMPLE_WORDS];
+        memcpy(words, &sample, sizeof(words));
+
+        // The slot of the sample ringCapacity behind is reused. Claimed first, so readers that may have copied it torn can tell
+        const uint64_t head = segment->ringHead.load(std::memory_order_relaxed);
+        std::atomic<uint64_t>* slot = ring + (head & ringMask) * SHARED_SAMPLE_WORDS;
+        segment->ringClaimed.store(head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for(size_t i = 0; i < SHARED_SAMPLE_WORDS; i++)
+        {
+            slot[i].store(words[i], std::memory_order_relaxed);
+        }
+        segment->ringHead.store(head + 1, std::memory_order_release);
+    }
+
+private:
+    SharedStateSegment* segment = nullptr;
+    std::atomic<uint64_t>* ring = nullptr;
+    uint64_t ringMask = 0;
+    size_t segmentSize = 0;
+    std::string segmentName;
+    // Identity of the segment created, to unlink only that one
+    uint64_t segmentDevice = 0;
+    uint64_t segmentInode = 0;
+    std::string lastError;
+};
+
+#endif // SHAREDSTATEWRITER_H
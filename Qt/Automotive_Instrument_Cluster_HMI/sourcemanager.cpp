@@ -0,0 +1,354 @@
+#include "sourcemanager.h"
+#include "serialworker.h"
+
+SourceManager::SourceManager(QObject* parent) : QObject(parent), ingestionMetrics(new IngestionMetrics(this))
+{
+    releaseTimer.setSingleShot(true);
+    releaseTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&releaseTimer, &QTimer::timeout, this, &SourceManager::releaseSamples);
+
+    statisticsTimer.setInterval(1000);
+    QObject::connect(&statisticsTimer, &QTimer::timeout, this, &SourceManager::updateStatistics);
+}
+
+SourceManager::~SourceManager()
+{
+    stopWorkers();
+}
+
+void SourceManager::setPorts(const QStringList& ports)
+{
+    if(portList != ports)
+    {
+        portList = ports;
+        emit portsChanged(ports);
+        applyPortSettings();
+    }
+}
+
+void SourceManager::setBaudRate(qint32 baudRate)
+{
+    if(baud != baudRate)
+    {
+        baud = baudRate;
+        emit baudRateChanged(baudRate);
+        applyPortSettings();
+    }
+}
+
+void SourceManager::setFrameProtocol(Serial::FrameProtocol frameProtocol)
+{
+    if(protocol != frameProtocol)
+    {
+        protocol = frameProtocol;
+        emit frameProtocolChanged(frameProtocol);
+        applyPortSettings();
+    }
+}
+
+void SourceManager::setBufferCapacity(int bufferCapacity)
+{
+    if(capacity != bufferCapacity && bufferCapacity > 0)
+    {
+        capacity = bufferCapacity;
+        emit bufferCapacityChanged(bufferCapacity);
+    }
+}
+
+void SourceManager::setIoThreadCount(int ioThreadCount)
+{
+    if(threadCount != ioThreadCount && ioThreadCount >= 0)
+    {
+        threadCount = ioThreadCount;
+        emit ioThreadCountChanged(ioThreadCount);
+    }
+}
+
+void SourceManager::setReorderWindow(int reorderWindow)
+{
+    const qint64 windowNs = static_cast<qint64>(reorderWindow) * 1000000;
+    if(reorderWindowNs != windowNs && reorderWindow >= 0)
+    {
+        reorderWindowNs = windowNs;
+        emit reorderWindowChanged(reorderWindow);
+        releaseSamples();
+    }
+}
+
+void SourceManager::setWindow(QQuickWindow* window)
+{
+    if(paceWindow == window)
+    {
+        return;
+    }
+
+    QObject::disconnect(paceConnection);
+    paceWindow = window;
+    if(paceWindow)
+    {
+        // Same pacing as ThreadedSerial::setWindow()
+        paceConnection = QObject::connect(paceWindow, &QQuickWindow::afterAnimating, this, &SourceManager::drainSamples);
+    }
+    emit windowChanged(window);
+}
+
+void SourceManager::setLatencyProbes(bool enabled)
+{
+    if(decodeTimestamps != enabled)
+    {
+        decodeTimestamps = enabled;
+        for(const std::unique_ptr<Source>& source : sources)
+        {
+            source->worker->setDecodeTimestamps(enabled);
+        }
+        emit latencyProbesChanged(enabled);
+    }
+}
+
+void SourceManager::setActive(bool active)
+{
+    if(activeRequested != active)
+    {
+        activeRequested = active;
+        emit activeChanged(active);
+        applyPortSettings();
+    }
+}
+
+int SourceManager::openPorts() const
+{
+    int open = 0;
+    for(const std::unique_ptr<Source>& source : sources)
+    {
+        open += source->opened ? 1 : 0;
+    }
+    return open;
+}
+
+QVariantList SourceManager::sourceStatistics() const
+{
+    QVariantList statistics;
+    for(size_t i = 0; i < sources.size(); i++)
+    {
+        const Source& source = *sources[i];
+        QVariantMap sourceStatistic;
+        sourceStatistic[QStringLiteral("sourceId")] = static_cast<int>(i);
+        sourceStatistic[QStringLiteral("portName")] = source.portName;
+        sourceStatistic[QStringLiteral("isOpen")] = source.opened;
+        sourceStatistic[QStringLiteral("errorString")] = source.errorString;
+        sourceStatistic[QStringLiteral("samples")] = static_cast<double>(source.samples);
+        sourceStatistic[QStringLiteral("sampleRate")] = source.sampleRate;
+        sourceStatistic[QStringLiteral("droppedSamples")] = static_cast<double>(source.worker->droppedSamples());
+        statistics.append(sourceStatistic);
+    }
+    return statistics;
+}
+
+void SourceManager::componentComplete()
+{
+    // Open with the final settings, rather than once per property assigned from QML
+    componentCompleted = true;
+    applyPortSettings();
+}
+
+void SourceManager::drainSamples()
+{
+    for(size_t i = 0; i < sources.size(); i++)
+    {
+        Source& source = *sources[i];
+
+        // Re-arm the wake up before draining, so samples pushed meanwhile trigger another one
+        source.worker->acknowledgeSamples();
+        source.samples += source.ring->drain([this, i](const DeviceSample& sample) { merger.add(i, sample); });
+    }
+
+    releaseSamples();
+}
+
+void SourceManager::applyPortSettings()
+{
+    if(!componentCompleted)
+    {
+        return;
+    }
+
+    stopWorkers();
+
+    if(!activeRequested || portList.isEmpty())
+    {
+        return;
+    }
+
+    if(portList.size() > MAX_PORT_COUNT)
+    {
+        qWarning("SourceManager: only the first %d ports are opened", MAX_PORT_COUNT);
+    }
+    const int portCount = qMin<int>(portList.size(), MAX_PORT_COUNT);
+
+    // A port mostly waits for its notifier, so a thread can serve several of them without one slowing the others down
+    const int ioThreadTotal = qMin(portCount, threadCount > 0 ? threadCount : qMax(1, QThread::idealThreadCount()));
+    for(int i = 0; i < ioThreadTotal; i++)
+    {
+        std::unique_ptr<QThread> ioThread = std::make_unique<QThread>();
+        ioThread->setObjectName(QStringLiteral("SerialIO-%1").arg(i));
+        ioThreads.push_back(std::move(ioThread));
+    }
+
+    merger.reset(static_cast<size_t>(portCount));
+
+    for(int i = 0; i < portCount; i++)
+    {
+        std::unique_ptr<Source> source = std::make_unique<Source>();
+
+        // "name:baudRate", the name alone takes the default baud rate
+        const QString& port = portList.at(i);
+        const qsizetype separator = port.lastIndexOf(QLatin1Char(':'));
+        bool validBaudRate = false;
+        const qint32 portBaudRate = separator > 0 ? port.mid(separator + 1).toInt(&validBaudRate) : 0;
+        source->portName = validBaudRate ? port.left(separator) : port;
+        source->baudRate = validBaudRate ? portBaudRate : baud;
+
+        source->ring = std::make_unique<SpscRingBuffer<DeviceSample>>(static_cast<size_t>(capacity));
+        source->worker = new SerialWorker(source->ring.get());
+        source->worker->setSourceId(static_cast<uint8_t>(i));
+        source->worker->setDecodeTimestamps(decodeTimestamps);
+        source->worker->moveToThread(ioThreads[i % ioThreadTotal].get());
+
+        // The worker signals are queued, they may be delivered after the ports were reopened, hence the generation check
+        QObject::connect(source->worker, &SerialWorker::samplesAvailable, this, &SourceManager::onSamplesAvailable);
+        QObject::connect(source->worker, &SerialWorker::errorOccurred, this, [this, i, generation = sourcesGeneration](const QString& errorString)
+        {
+            if(generation != sourcesGeneration)
+            {
+                return;
+            }
+            sources[i]->errorString = errorString;
+            emit errorOccurred(i, errorString);
+        });
+        QObject::connect(source->worker, &SerialWorker::openChanged, this, [this, i, generation = sourcesGeneration](bool open)
+        {
+            Source* sourcePointer = generation == sourcesGeneration ? sources[i].get() : nullptr;
+            if(sourcePointer && sourcePointer->opened != open)
+            {
+                sourcePointer->opened = open;
+                if(open)
+                {
+                    sourcePointer->errorString.clear();
+                }
+                // A closed port must not hold back the merge of the others
+                merger.setSourceActive(static_cast<size_t>(i), open);
+                emit openPortsChanged(openPorts());
+            }
+        });
+
+        sources.push_back(std::move(source));
+    }
+
+    QList<const IngestionCounters*> counters;
+    for(const std::unique_ptr<Source>& source : sources)
+    {
+        counters.append(&source->worker->counters());
+    }
+    ingestionMetrics->setCounters(counters);
+
+    for(const std::unique_ptr<QThread>& ioThread : ioThreads)
+    {
+        ioThread->start();
+    }
+
+    for(const std::unique_ptr<Source>& source : sources)
+    {
+        QMetaObject::invokeMethod(source->worker, [worker = source->worker, port = source->portName, baudRate = source->baudRate, protocol = protocol]()
+        {
+            worker->open(port, baudRate, protocol);
+        }, Qt::QueuedConnection);
+    }
+
+    statisticsClock.start();
+    statisticsTimer.start();
+}
+
+void SourceManager::onSamplesAvailable()
+{
+    if(sources.empty())
+    {
+        return;
+    }
+
+    if(paceWindow)
+    {
+        // Make sure a frame is coming, the rings are drained on its afterAnimating()
+        paceWindow->update();
+    }
+    else
+    {
+        drainSamples();
+    }
+}
+
+void SourceManager::releaseSamples()
+{
+    const qint64 now = DeviceSample::currentTimestamp();
+    merger.release(now, reorderWindowNs, [this](const DeviceSample& sample) { emit deviceSampleAvailable(sample); });
+
+    const qint64 nextRelease = merger.nextReleaseTimestamp(reorderWindowNs);
+    if(nextRelease == std::numeric_limits<qint64>::max())
+    {
+        releaseTimer.stop();
+    }
+    else
+    {
+        // Round up, so the held sample has left the window when the timer fires
+        releaseTimer.start(static_cast<int>(qMax<qint64>(0, (nextRelease - now + 999999) / 1000000)));
+    }
+}
+
+void SourceManager::updateStatistics()
+{
+    const double elapsedSeconds = statisticsClock.restart() / 1000.0;
+    for(const std::unique_ptr<Source>& source : sources)
+    {
+        source->sampleRate = elapsedSeconds > 0.0 ? (source->samples - source->statisticsSamples) / elapsedSeconds : 0.0;
+        source->statisticsSamples = source->samples;
+    }
+    emit statisticsChanged();
+}
+
+void SourceManager::stopWorkers()
+{
+    if(sources.empty())
+    {
+        return;
+    }
+
+    statisticsTimer.stop();
+    releaseTimer.stop();
+
+    // Close the ports on their own threads, then stop the threads so the workers can be deleted from here
+    for(const std::unique_ptr<Source>& source : sources)
+    {
+        QMetaObject::invokeMethod(source->worker, &SerialWorker::close, Qt::BlockingQueuedConnection);
+    }
+    for(const std::unique_ptr<QThread>& ioThread : ioThreads)
+    {
+        ioThread->quit();
+        ioThread->wait();
+    }
+
+    const bool hadOpenPorts = openPorts() > 0;
+    ingestionMetrics->setCounters({});
+    for(const std::unique_ptr<Source>& source : sources)
+    {
+        delete source->worker;
+    }
+    sources.clear();
+    ioThreads.clear();
+    merger.reset(0);
+    sourcesGeneration++;
+
+    if(hadOpenPorts)
+    {
+        emit openPortsChanged(0);
+    }
+    emit statisticsChanged();
+}
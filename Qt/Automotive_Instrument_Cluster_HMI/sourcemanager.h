@@ -0,0 +1,199 @@
+#ifndef SOURCEMANAGER_H
+#define SOURCEMANAGER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QQmlParserStatus>
+#include <QQuickWindow>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QVariantList>
+#include <memory>
+#include <vector>
+#include "devicesample.h"
+#include "ingestionmetrics.h"
+#include "samplemerger.h"
+#include "serial.h"
+#include "spscringbuffer.h"
+
+class SerialWorker;
+
+/*
+ * Several serial ports merged into a single stream of samples, e.g. the HMI node and an extra sensor board.
+ *
+ * Every port has its own SerialWorker (so its own decoder) and its own SpscRingBuffer, and the workers are spread over
+ * a few I/O threads. A port that stalls or floods only fills its own ring, it never blocks the others.
+ * The samples are tagged with their port index (DeviceSample::sourceId()) and merged on the GUI thread into arrival
+ * timestamp order by a SampleMerger, holding them at most reorderWindow milliseconds, then emitted as [SIGNAL] deviceSampleAvailable().
+ *
+ * Like ThreadedSerial the rings are drained once per frame of the given window, or as soon as samples arrive without a window.
+ * Every port is opened with 8 data bits, no parity and 1 stop bit.
+*/
+class SourceManager : public QObject, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+    // Ports to open, as "name" or "name:baudRate". The index of a port is the source id of its samples
+    Q_PROPERTY(QStringList ports READ ports WRITE setPorts NOTIFY portsChanged)
+    // Baud rate of the ports that don't give one
+    Q_PROPERTY(qint32 baudRate READ baudRate WRITE setBaudRate NOTIFY baudRateChanged)
+    Q_PROPERTY(Serial::FrameProtocol frameProtocol READ frameProtocol WRITE setFrameProtocol NOTIFY frameProtocolChanged)
+    // Max number of samples of a port waiting for the GUI thread. Applied on the next open
+    Q_PROPERTY(int bufferCapacity READ bufferCapacity WRITE setBufferCapacity NOTIFY bufferCapacityChanged)
+    // I/O threads the ports are spread over, 0 for one per port up to QThread::idealThreadCount(). Applied on the next open
+    Q_PROPERTY(int ioThreadCount READ ioThreadCount WRITE setIoThreadCount NOTIFY ioThreadCountChanged)
+    // Longest time a sample is held to be ordered with the other ports' samples, in milliseconds
+    Q_PROPERTY(int reorderWindow READ reorderWindow WRITE setReorderWindow NOTIFY reorderWindowChanged)
+    // Window whose frames pace the draining of the rings
+    Q_PROPERTY(QQuickWindow* window READ window WRITE setWindow NOTIFY windowChanged)
+    // Stamp every sample with its decode time for LatencyProbe, see DeviceDataParser::setDecodeTimestamps()
+    Q_PROPERTY(bool latencyProbes READ latencyProbes WRITE setLatencyProbes NOTIFY latencyProbesChanged)
+    // Open the ports when true, close them when false
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(int openPorts READ openPorts NOTIFY openPortsChanged)
+    /*
+     * One map per port, refreshed every second: sourceId, portName, isOpen, errorString,
+     * samples, sampleRate (samples per second over the last second) and droppedSamples
+    */
+    Q_PROPERTY(QVariantList sourceStatistics READ sourceStatistics NOTIFY statisticsChanged)
+    // Samples that arrived later than the reorder window, emitted out of order
+    Q_PROPERTY(int lateSamples READ lateSamples NOTIFY statisticsChanged)
+    // Throughput, frame rate per device and decoding errors of all the ports, refreshed while metrics.interval is set
+    Q_PROPERTY(IngestionMetrics* metrics READ metrics CONSTANT)
+
+public:
+    // Source ids are a byte, see DeviceSample::sourceId()
+    static constexpr int MAX_PORT_COUNT = 256;
+
+    SourceManager(QObject* parent = nullptr);
+    ~SourceManager();
+
+    QStringList ports() const { return portList; }
+    void setPorts(const QStringList& ports);
+
+    qint32 baudRate() const { return baud; }
+    void setBaudRate(qint32 baudRate);
+
+    Serial::FrameProtocol frameProtocol() const { return protocol; }
+    void setFrameProtocol(Serial::FrameProtocol frameProtocol);
+
+    int bufferCapacity() const { return capacity; }
+    void setBufferCapacity(int bufferCapacity);
+
+    int ioThreadCount() const { return threadCount; }
+    void setIoThreadCount(int ioThreadCount);
+
+    int reorderWindow() const { return static_cast<int>(reorderWindowNs / 1000000); }
+    void setReorderWindow(int reorderWindow);
+
+    QQuickWindow* window() const { return paceWindow; }
+    void setWindow(QQuickWindow* window);
+
+    bool latencyProbes() const { return decodeTimestamps; }
+    void setLatencyProbes(bool enabled);
+
+    bool active() const { return activeRequested; }
+    void setActive(bool active);
+
+    int openPorts() const;
+    QVariantList sourceStatistics() const;
+    int lateSamples() const { return static_cast<int>(merger.lateSamples()); }
+    IngestionMetrics* metrics() const { return ingestionMetrics; }
+
+    /*
+     * @brief Drain every port's ring and emit [SIGNAL] deviceSampleAvailable() for the samples the merge releases
+     *
+     * @return void
+    */
+    void drainSamples();
+
+    void classBegin() override { componentCompleted = false; }
+    void componentComplete() override;
+
+Q_SIGNALS:
+    void portsChanged(QStringList ports);
+    void baudRateChanged(qint32 baudRate);
+    void frameProtocolChanged(Serial::FrameProtocol frameProtocol);
+    void bufferCapacityChanged(int bufferCapacity);
+    void ioThreadCountChanged(int ioThreadCount);
+    void reorderWindowChanged(int reorderWindow);
+    void windowChanged(QQuickWindow* window);
+    void latencyProbesChanged(bool enabled);
+    void activeChanged(bool active);
+    void openPortsChanged(int openPorts);
+    void statisticsChanged();
+    void errorOccurred(int sourceId, QString errorString);
+
+    /*
+     * @brief [SIGNAL] Emitted on the GUI thread for every decoded device data frame of every port, in arrival timestamp order
+     *
+     * @return void
+    */
+    void deviceSampleAvailable(DeviceSample sample);
+
+private:
+    struct Source
+    {
+        QString portName;
+        qint32 baudRate = 0;
+        std::unique_ptr<SpscRingBuffer<DeviceSample>> ring;
+        SerialWorker* worker = nullptr;
+        bool opened = false;
+        QString errorString;
+        quint64 samples = 0;
+        quint64 statisticsSamples = 0;
+        double sampleRate = 0.0;
+    };
+
+    /*
+     * @brief (Re)open every port on the worker threads with the current settings, or close them if not active
+     *
+     * @return void
+    */
+    void applyPortSettings();
+
+    /*
+     * @brief [SLOT] A worker pushed samples into an empty ring, request a frame to drain them (or drain right away without a window)
+     *
+     * @return void
+    */
+    void onSamplesAvailable();
+
+    /*
+     * @brief Emit the samples the merge releases, and come back when the oldest held one leaves the reorder window
+     *
+     * @return void
+    */
+    void releaseSamples();
+
+    // [SLOT] Connected to the 1 second statistics timer
+    void updateStatistics();
+
+    void stopWorkers();
+
+    QStringList portList;
+    qint32 baud = QSerialPort::Baud4800;
+    Serial::FrameProtocol protocol = Serial::FRAME_PROTOCOL_V2;
+    int capacity = 65536;
+    int threadCount = 0;
+    qint64 reorderWindowNs = 20000000;
+    QPointer<QQuickWindow> paceWindow;
+    QMetaObject::Connection paceConnection;
+    bool decodeTimestamps = false;
+    bool activeRequested = false;
+    bool componentCompleted = true;
+
+    std::vector<std::unique_ptr<QThread>> ioThreads;
+    std::vector<std::unique_ptr<Source>> sources;
+    // Incremented whenever the sources are deleted
+    quint64 sourcesGeneration = 0;
+    SampleMerger merger;
+    QTimer releaseTimer;
+    QTimer statisticsTimer;
+    QElapsedTimer statisticsClock;
+    IngestionMetrics* ingestionMetrics;
+};
+
+#endif // SOURCEMANAGER_H
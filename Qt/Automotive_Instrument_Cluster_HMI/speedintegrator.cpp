@@ -0,0 +1,63 @@
+#include "speedintegrator.h"
+#include <algorithm>
+
+void SpeedIntegrator::addSample(double accelerationG, int64_t timestampNs)
+{
+    if(!hasPreviousSample)
+    {
+        previousAccelerationG = accelerationG;
+        previousTimestampNs = timestampNs;
+        chunkTimestampNs = timestampNs;
+        chunkSampleCount = 1;
+        hasPreviousChunk = false;
+        hasPreviousSample = true;
+        return;
+    }
+
+    int64_t stepNs = 0;
+    if(timestampNs == chunkTimestampNs)
+    {
+        // Arrived with the previous sample, one sample period after it
+        stepNs = samplePeriodNs;
+        chunkSampleCount++;
+    }
+    else if(timestampNs > chunkTimestampNs)
+    {
+        // The previous chunk is complete: its samples were received since the chunk before it, which estimates the sample period
+        if(hasPreviousChunk && chunkTimestampNs - previousChunkTimestampNs <= MAX_INTEGRATION_STEP_NS)
+        {
+            samplePeriodNs = std::max<int64_t>((chunkTimestampNs - previousChunkTimestampNs) / chunkSampleCount, 1);
+        }
+        previousChunkTimestampNs = chunkTimestampNs;
+        hasPreviousChunk = true;
+        chunkTimestampNs = timestampNs;
+        chunkSampleCount = 1;
+
+        // Up to the arrival time, nothing while the samples before already took that time
+        stepNs = std::max<int64_t>(timestampNs - previousTimestampNs, 0);
+    }
+    // else an older sample, e.g. a late one merged from another source, its time is already integrated
+
+    stepNs = std::min(stepNs, MAX_INTEGRATION_STEP_NS);
+
+    // Trapezoidal rule: the mean of both ends of the step times the step duration
+    const double deltaVelocity = (previousAccelerationG + accelerationG) * 0.5 * KMH_PER_SECOND_PER_G * (stepNs * 1e-9);
+
+    velocityKmh = std::clamp(velocityKmh + deltaVelocity, -maxSpeedKmh, maxSpeedKmh);
+
+    previousAccelerationG = accelerationG;
+    // A gap longer than MAX_INTEGRATION_STEP_NS restarts from the arrival time
+    previousTimestampNs = std::max(previousTimestampNs + stepNs, timestampNs);
+}
+
+void SpeedIntegrator::reset()
+{
+    velocityKmh = 0.0;
+    previousAccelerationG = 0.0;
+    previousTimestampNs = 0;
+    hasPreviousSample = false;
+    chunkTimestampNs = 0;
+    chunkSampleCount = 0;
+    previousChunkTimestampNs = 0;
+    hasPreviousChunk = false;
+}
@@ -0,0 +1,74 @@
+#ifndef SPEEDINTEGRATOR_H
+#define SPEEDINTEGRATOR_H
+
+#include <cstdint>
+
+/*
+ * Integrates the accelerometer samples into the vehicle velocity.
+ *
+ * Every sample is used with its own arrival timestamp, integrating with the trapezoidal rule between consecutive samples,
+ * so the velocity is as accurate as the sample rate allows whatever the rate is.
+ * The frames of one read chunk share its arrival time (see SerialWorker), a sample with the same timestamp as the previous one is integrated
+ * over the sample period instead. The period is estimated from each completed chunk, as the time since the chunk before it over the number
+ * of samples it carried. The next chunk only integrates the time not already accounted for, nothing while the integrated time is ahead
+ * of its arrival time, so the integrated time keeps following the arrival times.
+ * The velocity is capped to [-maxSpeed, maxSpeed] for both directions of travel.
+*/
+class SpeedIntegrator
+{
+public:
+    // Convert (G)s to (km/h)/s
+    static constexpr double KMH_PER_SECOND_PER_G = 35.30394;
+    // Longest step integrated between two samples, a longer gap means the link was down and the step is shortened to this
+    static constexpr int64_t MAX_INTEGRATION_STEP_NS = 1000000000;
+    // Sample period assumed until it is estimated from the arrival times
+    static constexpr int64_t DEFAULT_SAMPLE_PERIOD_NS = 20000000;
+
+    explicit SpeedIntegrator(double maxSpeed = 180.0) : maxSpeedKmh(maxSpeed) {}
+
+    /*
+     * @brief Integrate an accelerometer sample
+     *
+     * @param accelerationG     Acceleration in (G)s
+     * @param timestampNs       Monotonic arrival time of the sample in nanoseconds
+     *
+     * @return void
+    */
+    void addSample(double accelerationG, int64_t timestampNs);
+
+    /*
+     * @brief Forget the integrated velocity and the previous sample
+     *
+     * @return void
+    */
+    void reset();
+
+    // Signed velocity in Km/h
+    double velocity() const { return velocityKmh; }
+    // Absolute velocity in Km/h
+    double speed() const { return velocityKmh < 0.0 ? -velocityKmh : velocityKmh; }
+
+    double maxSpeed() const { return maxSpeedKmh; }
+    void setMaxSpeed(double maxSpeed) { maxSpeedKmh = maxSpeed; }
+
+    // Period a sample sharing the timestamp of the previous one is integrated over, replaced by the estimate once samples arrive at different times
+    int64_t samplePeriod() const { return samplePeriodNs; }
+    void setSamplePeriod(int64_t periodNs) { samplePeriodNs = periodNs > 0 ? periodNs : DEFAULT_SAMPLE_PERIOD_NS; }
+
+private:
+    double maxSpeedKmh;
+    double velocityKmh = 0.0;
+    double previousAccelerationG = 0.0;
+    // Integrated up to here. Ahead of the arrival time of the previous sample when it shared its timestamp with the samples before it
+    int64_t previousTimestampNs = 0;
+    bool hasPreviousSample = false;
+    int64_t samplePeriodNs = DEFAULT_SAMPLE_PERIOD_NS;
+    // Arrival time of the current chunk and its number of samples so far
+    int64_t chunkTimestampNs = 0;
+    int64_t chunkSampleCount = 0;
+    // Arrival time of the chunk before, if any
+    int64_t previousChunkTimestampNs = 0;
+    bool hasPreviousChunk = false;
+};
+
+#endif // SPEEDINTEGRATOR_H
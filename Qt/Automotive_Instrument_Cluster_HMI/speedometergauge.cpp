@@ -0,0 +1,476 @@
+#include "speedometergauge.h"
+#include <QImage>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGRectangleNode>
+#include <QSGRendererInterface>
+#include <QSGVertexColorMaterial>
+#include <QtMath>
+#include <vector>
+
+namespace
+{
+
+// Rows of the triangle strips approximating the circle, their edges are hidden under the border
+constexpr int DISC_ROW_COUNT = 128;
+constexpr int BAND_ROW_COUNT = 64;
+constexpr int RING_SEGMENT_COUNT = 180;
+constexpr double ARC_START_DEGREES = 225.0;
+constexpr double ARC_SWEEP_DEGREES = 270.0;
+constexpr double TICK_WIDTH = 2.0;
+// Tick length as a fraction of the radius
+constexpr double TICK_LENGTH = 0.08;
+
+struct GaugeStyle
+{
+    QPointF center;
+    double radius;
+    QColor color;
+    QColor interiorColor;
+    double borderWidth;
+    int tickCount;
+    double fillPosition;
+};
+
+QColor interpolate(const QColor& from, const QColor& to, double t)
+{
+    return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * t,
+                            from.greenF() + (to.greenF() - from.greenF()) * t,
+                            from.blueF() + (to.blueF() - from.blueF()) * t,
+                            from.alphaF() + (to.alphaF() - from.alphaF()) * t);
+}
+
+// Half the width of the circle at the given distance from its top (or bottom)
+double halfChord(double radius, double offset)
+{
+    const double distanceToCenter = radius - offset;
+    return qSqrt(qMax(0.0, radius * radius - distanceToCenter * distanceToCenter));
+}
+
+QPointF pointOnCircle(const QPointF& center, double radius, double angleDegrees)
+{
+    const double angle = qDegreesToRadians(angleDegrees);
+    return QPointF(center.x() + radius * qCos(angle), center.y() - radius * qSin(angle));
+}
+
+double tickAngle(const GaugeStyle& style, int tick)
+{
+    return ARC_START_DEGREES - ARC_SWEEP_DEGREES * tick / (style.tickCount - 1);
+}
+
+void setVertex(QSGGeometry::ColoredPoint2D& vertex, const QPointF& position, const QColor& color, double opacity = 1.0)
+{
+    // QSGVertexColorMaterial expects premultiplied colors
+    const double alpha = color.alphaF() * opacity;
+    vertex.set(float(position.x()), float(position.y()),
+               uchar(qRound(color.redF() * alpha * 255)), uchar(qRound(color.greenF() * alpha * 255)),
+               uchar(qRound(color.blueF() * alpha * 255)), uchar(qRound(alpha * 255)));
+}
+
+QSGGeometryNode* createColoredNode(int vertexCount, int indexCount, QSGGeometry::DrawingMode drawingMode)
+{
+    QSGGeometry* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), vertexCount, indexCount);
+    geometry->setDrawingMode(drawingMode);
+
+    QSGGeometryNode* node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setMaterial(new QSGVertexColorMaterial);
+    node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+    return node;
+}
+
+/*
+ * @brief Write a triangle strip covering the circle from its top (or bottom) down (or up) to the given height
+ *
+ * The color goes linearly from fromColor at the edge to toColor at the given height, as a vertical linear gradient does
+ *
+ * @return void
+*/
+void writeCircleStrip(QSGGeometry* geometry, const GaugeStyle& style, double radius, double height, bool fromTop,
+                      const QColor& fromColor, const QColor& toColor)
+{
+    QSGGeometry::ColoredPoint2D* vertices = geometry->vertexDataAsColoredPoint2D();
+    const int rowCount = geometry->vertexCount() / 2 - 1;
+
+    for(int row = 0; row <= rowCount; row++)
+    {
+        const double t = double(row) / rowCount;
+        const double offset = t * height;
+        const double halfWidth = halfChord(radius, offset);
+        const double y = fromTop ? style.center.y() - radius + offset : style.center.y() + radius - offset;
+        const QColor color = interpolate(fromColor, toColor, t);
+
+        setVertex(vertices[row * 2], QPointF(style.center.x() - halfWidth, y), color);
+        setVertex(vertices[row * 2 + 1], QPointF(style.center.x() + halfWidth, y), color);
+    }
+}
+
+class GaugeNode : public QSGNode
+{
+public:
+    /*
+     * @brief Rebuild the circle, border and ticks
+     *
+     * @return void
+    */
+    virtual void rebuild(const GaugeStyle& style, QQuickWindow* window) = 0;
+
+    /*
+     * @brief Update the two fill bands to the given height, a fraction of the diameter
+     *
+     * @return void
+    */
+    virtual void updateFill(const GaugeStyle& style, double fillFraction) = 0;
+};
+
+/*
+ * Gauge made of vertex colored geometry, for the hardware accelerated backends.
+ * A value change only rewrites the vertices of the two fill bands
+*/
+class GaugeGeometryNode : public GaugeNode
+{
+public:
+    GaugeGeometryNode()
+    {
+        disc = createColoredNode((DISC_ROW_COUNT + 1) * 2, 0, QSGGeometry::DrawTriangleStrip);
+        topBand = createColoredNode((BAND_ROW_COUNT + 1) * 2, 0, QSGGeometry::DrawTriangleStrip);
+        bottomBand = createColoredNode((BAND_ROW_COUNT + 1) * 2, 0, QSGGeometry::DrawTriangleStrip);
+        frame = createColoredNode(0, 0, QSGGeometry::DrawTriangles);
+
+        appendChildNode(disc);
+        appendChildNode(topBand);
+        appendChildNode(bottomBand);
+        appendChildNode(frame);
+    }
+
+    void rebuild(const GaugeStyle& style, QQuickWindow*) override
+    {
+        // The disc reaches under the middle of the border, so its straight edges don't show
+        const double discRadius = qMax(0.0, style.radius - style.borderWidth / 2);
+        writeCircleStrip(disc->geometry(), style, discRadius, discRadius * 2, true, style.interiorColor, style.interiorColor);
+        disc->markDirty(QSGNode::DirtyGeometry);
+
+        rebuildFrame(style);
+    }
+
+    void updateFill(const GaugeStyle& style, double fillFraction) override
+    {
+        const double height = fillFraction * style.radius * 2;
+        writeCircleStrip(topBand->geometry(), style, style.radius, height, true, style.color, style.interiorColor);
+        writeCircleStrip(bottomBand->geometry(), style, style.radius, height, false, style.color, style.interiorColor);
+        topBand->markDirty(QSGNode::DirtyGeometry);
+        bottomBand->markDirty(QSGNode::DirtyGeometry);
+    }
+
+private:
+    /*
+     * @brief Antialiased border ring, faded over one pixel on both of its edges, and the ticks
+     *
+     * @return void
+    */
+    void rebuildFrame(const GaugeStyle& style)
+    {
+        const int ticks = style.tickCount >= 2 ? style.tickCount : 0;
+        QSGGeometry* geometry = frame->geometry();
+        geometry->allocate(RING_SEGMENT_COUNT * 4 + ticks * 4, RING_SEGMENT_COUNT * 18 + ticks * 6);
+
+        QSGGeometry::ColoredPoint2D* vertices = geometry->vertexDataAsColoredPoint2D();
+        quint16* indices = geometry->indexDataAsUShort();
+
+        const double innerRadius = style.radius - style.borderWidth;
+        const double radii[4] = { style.radius + 0.5, style.radius - 0.5, innerRadius + 0.5, innerRadius - 0.5 };
+        const double opacities[4] = { 0.0, 1.0, 1.0, 0.0 };
+
+        for(int segment = 0; segment < RING_SEGMENT_COUNT; segment++)
+        {
+            const double angle = 360.0 * segment / RING_SEGMENT_COUNT;
+            for(int ring = 0; ring < 4; ring++)
+            {
+                setVertex(vertices[segment * 4 + ring], pointOnCircle(style.center, qMax(0.0, radii[ring]), angle), style.color, opacities[ring]);
+            }
+
+            const int next = (segment + 1) % RING_SEGMENT_COUNT;
+            for(int ring = 0; ring < 3; ring++)
+            {
+                const quint16 quad[4] = { quint16(segment * 4 + ring), quint16(segment * 4 + ring + 1), quint16(next * 4 + ring), quint16(next * 4 + ring + 1) };
+                quint16* triangles = indices + (segment * 3 + ring) * 6;
+                triangles[0] = quad[0]; triangles[1] = quad[1]; triangles[2] = quad[2];
+                triangles[3] = quad[1]; triangles[4] = quad[3]; triangles[5] = quad[2];
+            }
+        }
+
+        const int firstTickVertex = RING_SEGMENT_COUNT * 4;
+        for(int tick = 0; tick < ticks; tick++)
+        {
+            const double angle = tickAngle(style, tick);
+            const QPointF outer = pointOnCircle(style.center, innerRadius, angle);
+            const QPointF inner = pointOnCircle(style.center, innerRadius - style.radius * TICK_LENGTH, angle);
+            // Perpendicular to the tick, half its width long
+            const QPointF side = pointOnCircle(QPointF(0.0, 0.0), TICK_WIDTH / 2, angle + 90.0);
+
+            const int vertex = firstTickVertex + tick * 4;
+            setVertex(vertices[vertex], outer - side, style.color);
+            setVertex(vertices[vertex + 1], outer + side, style.color);
+            setVertex(vertices[vertex + 2], inner - side, style.color);
+            setVertex(vertices[vertex + 3], inner + side, style.color);
+
+            quint16* triangles = indices + RING_SEGMENT_COUNT * 18 + tick * 6;
+            triangles[0] = quint16(vertex); triangles[1] = quint16(vertex + 1); triangles[2] = quint16(vertex + 2);
+            triangles[3] = quint16(vertex + 1); triangles[4] = quint16(vertex + 3); triangles[5] = quint16(vertex + 2);
+        }
+
+        frame->markDirty(QSGNode::DirtyGeometry);
+    }
+
+    QSGGeometryNode* disc;
+    QSGGeometryNode* topBand;
+    QSGGeometryNode* bottomBand;
+    QSGGeometryNode* frame;
+};
+
+/*
+ * Gauge for the software backend, which doesn't draw custom geometry.
+ * The disc and the border with its ticks are rasterized once into cached image nodes,
+ * the fill bands are made of one pixel high rectangles whose width and color are updated on a value change
+*/
+class GaugeSoftwareNode : public GaugeNode
+{
+public:
+    void rebuild(const GaugeStyle& style, QQuickWindow* window) override
+    {
+        removeAllChildNodes();
+        qDeleteAll(rows[0]);
+        qDeleteAll(rows[1]);
+        rows[0].clear();
+        rows[1].clear();
+        delete disc;
+        delete frame;
+
+        const QRectF bounds(style.center.x() - style.radius, style.center.y() - style.radius, style.radius * 2, style.radius * 2);
+
+        disc = createImageNode(window, bounds, [&style](QPainter& painter, const QRectF& rect)
+        {
+            const double inset = style.borderWidth / 2;
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(style.interiorColor);
+            painter.drawEllipse(rect.adjusted(inset, inset, -inset, -inset));
+        });
+        appendChildNode(disc);
+
+        // Rows for the highest fill, the unused ones are kept empty
+        const int rowCount = qCeil(style.fillPosition * style.radius * 2);
+        for(std::vector<QSGRectangleNode*>& bandRows : rows)
+        {
+            for(int row = 0; row < rowCount; row++)
+            {
+                QSGRectangleNode* rowNode = window->createRectangleNode();
+                bandRows.push_back(rowNode);
+                appendChildNode(rowNode);
+            }
+        }
+
+        frame = createImageNode(window, bounds, [&style](QPainter& painter, const QRectF& rect)
+        {
+            const double inset = style.borderWidth / 2;
+            painter.setPen(QPen(style.color, style.borderWidth));
+            painter.setBrush(Qt::NoBrush);
+            painter.drawEllipse(rect.adjusted(inset, inset, -inset, -inset));
+
+            if(style.tickCount >= 2)
+            {
+                const QPointF center = rect.center();
+                const double innerRadius = style.radius - style.borderWidth;
+                painter.setPen(QPen(style.color, TICK_WIDTH, Qt::SolidLine, Qt::FlatCap));
+                for(int tick = 0; tick < style.tickCount; tick++)
+                {
+                    const double angle = tickAngle(style, tick);
+                    painter.drawLine(pointOnCircle(center, innerRadius, angle), pointOnCircle(center, innerRadius - style.radius * TICK_LENGTH, angle));
+                }
+            }
+        });
+        appendChildNode(frame);
+    }
+
+    void updateFill(const GaugeStyle& style, double fillFraction) override
+    {
+        const double height = fillFraction * style.radius * 2;
+        for(int band = 0; band < 2; band++)
+        {
+            for(size_t row = 0; row < rows[band].size(); row++)
+            {
+                QSGRectangleNode* rowNode = rows[band][row];
+                const double offset = row + 0.5;
+                if(offset > height)
+                {
+                    rowNode->setRect(QRectF());
+                    continue;
+                }
+
+                const double halfWidth = halfChord(style.radius, offset);
+                const double y = band == 0 ? style.center.y() - style.radius + row : style.center.y() + style.radius - row - 1;
+                rowNode->setRect(QRectF(style.center.x() - halfWidth, y, halfWidth * 2, 1.0));
+                rowNode->setColor(interpolate(style.color, style.interiorColor, offset / height));
+            }
+        }
+    }
+
+    ~GaugeSoftwareNode() override
+    {
+        removeAllChildNodes();
+        qDeleteAll(rows[0]);
+        qDeleteAll(rows[1]);
+        delete disc;
+        delete frame;
+    }
+
+private:
+    template<typename Paint>
+    static QSGImageNode* createImageNode(QQuickWindow* window, const QRectF& bounds, Paint&& paint)
+    {
+        const qreal devicePixelRatio = window->effectiveDevicePixelRatio();
+        QImage image(qMax(1, qCeil(bounds.width() * devicePixelRatio)), qMax(1, qCeil(bounds.height() * devicePixelRatio)), QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(devicePixelRatio);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        paint(painter, QRectF(QPointF(0.0, 0.0), bounds.size()));
+        painter.end();
+
+        QSGImageNode* node = window->createImageNode();
+        node->setTexture(window->createTextureFromImage(image));
+        node->setOwnsTexture(true);
+        node->setRect(bounds);
+        return node;
+    }
+
+    QSGImageNode* disc = nullptr;
+    QSGImageNode* frame = nullptr;
+    std::vector<QSGRectangleNode*> rows[2];
+};
+
+}
+
+SpeedometerGauge::SpeedometerGauge(QQuickItem* parent) : QQuickItem(parent)
+{
+    setFlag(ItemHasContents);
+}
+
+void SpeedometerGauge::setValue(double value)
+{
+    if(gaugeValue != value)
+    {
+        gaugeValue = value;
+        // Only the fill changes, the cached nodes are kept
+        update();
+        emit valueChanged(value);
+    }
+}
+
+void SpeedometerGauge::setMaxValue(double maxValue)
+{
+    if(gaugeMaxValue != maxValue)
+    {
+        gaugeMaxValue = maxValue;
+        update();
+        emit maxValueChanged(maxValue);
+    }
+}
+
+void SpeedometerGauge::setFillPosition(double fillPosition)
+{
+    if(gaugeFillPosition != fillPosition)
+    {
+        gaugeFillPosition = fillPosition;
+        invalidateStaticNodes();
+        emit fillPositionChanged(fillPosition);
+    }
+}
+
+void SpeedometerGauge::setColor(const QColor& color)
+{
+    if(gaugeColor != color)
+    {
+        gaugeColor = color;
+        invalidateStaticNodes();
+        emit colorChanged(color);
+    }
+}
+
+void SpeedometerGauge::setInteriorColor(const QColor& interiorColor)
+{
+    if(gaugeInteriorColor != interiorColor)
+    {
+        gaugeInteriorColor = interiorColor;
+        invalidateStaticNodes();
+        emit interiorColorChanged(interiorColor);
+    }
+}
+
+void SpeedometerGauge::setBorderWidth(double borderWidth)
+{
+    if(gaugeBorderWidth != borderWidth)
+    {
+        gaugeBorderWidth = borderWidth;
+        invalidateStaticNodes();
+        emit borderWidthChanged(borderWidth);
+    }
+}
+
+void SpeedometerGauge::setTickCount(int tickCount)
+{
+    if(gaugeTickCount != tickCount)
+    {
+        gaugeTickCount = tickCount;
+        invalidateStaticNodes();
+        emit tickCountChanged(tickCount);
+    }
+}
+
+QSGNode* SpeedometerGauge::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+    GaugeNode* node = static_cast<GaugeNode*>(oldNode);
+    if(!node)
+    {
+        const bool software = window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+        node = software ? static_cast<GaugeNode*>(new GaugeSoftwareNode) : static_cast<GaugeNode*>(new GaugeGeometryNode);
+        staticNodesDirty = true;
+    }
+
+    const GaugeStyle style = { boundingRect().center(), qMin(width(), height()) / 2, gaugeColor, gaugeInteriorColor, gaugeBorderWidth, gaugeTickCount, gaugeFillPosition };
+
+    if(staticNodesDirty)
+    {
+        node->rebuild(style, window());
+        staticNodesDirty = false;
+    }
+    node->updateFill(style, fillFraction());
+
+    return node;
+}
+
+void SpeedometerGauge::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if(newGeometry.size() != oldGeometry.size())
+    {
+        invalidateStaticNodes();
+    }
+}
+
+void SpeedometerGauge::invalidateStaticNodes()
+{
+    staticNodesDirty = true;
+    update();
+}
+
+double SpeedometerGauge::fillFraction() const
+{
+    if(gaugeMaxValue <= 0.0)
+    {
+        return 0.0;
+    }
+    return qBound(0.0, gaugeValue * gaugeFillPosition / gaugeMaxValue, 0.5);
+}
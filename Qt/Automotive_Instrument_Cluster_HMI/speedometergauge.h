@@ -0,0 +1,91 @@
+#ifndef SPEEDOMETERGAUGE_H
+#define SPEEDOMETERGAUGE_H
+
+#include <QColor>
+#include <QQuickItem>
+
+/*
+ * Circular speedometer drawn straight into the scene graph.
+ *
+ * Looks like a circle with a border whose inside fills from the top and bottom edges toward the center as the value rises,
+ * with a gradient from the border color to the interior color (the former Rectangle with four bound GradientStops),
+ * plus optional ticks along a 270 degrees arc.
+ *
+ * The circle, border and ticks are built once per size or style change and cached in the scene graph. A value change only
+ * rewrites the vertices of the two fill bands (or moves the fill row rectangles with the software backend),
+ * nothing is tessellated nor rasterized again.
+*/
+class SpeedometerGauge : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(double value READ value WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(double maxValue READ maxValue WRITE setMaxValue NOTIFY maxValueChanged)
+    // Fraction of the height each fill band reaches at maxValue
+    Q_PROPERTY(double fillPosition READ fillPosition WRITE setFillPosition NOTIFY fillPositionChanged)
+    // Border and fill edge color
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(QColor interiorColor READ interiorColor WRITE setInteriorColor NOTIFY interiorColorChanged)
+    Q_PROPERTY(double borderWidth READ borderWidth WRITE setBorderWidth NOTIFY borderWidthChanged)
+    // Ticks along the arc, none if less than 2
+    Q_PROPERTY(int tickCount READ tickCount WRITE setTickCount NOTIFY tickCountChanged)
+
+public:
+    SpeedometerGauge(QQuickItem* parent = nullptr);
+
+    double value() const { return gaugeValue; }
+    void setValue(double value);
+
+    double maxValue() const { return gaugeMaxValue; }
+    void setMaxValue(double maxValue);
+
+    double fillPosition() const { return gaugeFillPosition; }
+    void setFillPosition(double fillPosition);
+
+    QColor color() const { return gaugeColor; }
+    void setColor(const QColor& color);
+
+    QColor interiorColor() const { return gaugeInteriorColor; }
+    void setInteriorColor(const QColor& interiorColor);
+
+    double borderWidth() const { return gaugeBorderWidth; }
+    void setBorderWidth(double borderWidth);
+
+    int tickCount() const { return gaugeTickCount; }
+    void setTickCount(int tickCount);
+
+Q_SIGNALS:
+    void valueChanged(double value);
+    void maxValueChanged(double maxValue);
+    void fillPositionChanged(double fillPosition);
+    void colorChanged(QColor color);
+    void interiorColorChanged(QColor interiorColor);
+    void borderWidthChanged(double borderWidth);
+    void tickCountChanged(int tickCount);
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* updatePaintNodeData) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+
+private:
+    /*
+     * @brief Schedule a rebuild of the cached circle, border and ticks
+     *
+     * @return void
+    */
+    void invalidateStaticNodes();
+
+    // Height of each fill band as a fraction of the diameter
+    double fillFraction() const;
+
+    double gaugeValue = 0.0;
+    double gaugeMaxValue = 180.0;
+    double gaugeFillPosition = 0.3;
+    QColor gaugeColor = QColor("lightgreen");
+    QColor gaugeInteriorColor = QColor("black");
+    double gaugeBorderWidth = 5.0;
+    int gaugeTickCount = 0;
+
+    bool staticNodesDirty = true;
+};
+
+#endif // SPEEDOMETERGAUGE_H
@@ -0,0 +1,123 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/*
+ * Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * The producer never waits on the consumer: when the ring is full push() fails and the caller decides what to do with the item.
+ * Each side keeps a cached copy of the other side's index, so the shared cache lines are only touched when the cache runs out.
+*/
+template<typename T>
+class SpscRingBuffer
+{
+public:
+    /*
+     * @param capacity Max number of items held at once, rounded up to a power of two
+    */
+    explicit SpscRingBuffer(size_t capacity)
+    {
+        size_t roundedCapacity = 1;
+        while(roundedCapacity < capacity)
+        {
+            roundedCapacity <<= 1;
+        }
+        slots.reset(new T[roundedCapacity]);
+        indexMask = roundedCapacity - 1;
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /*
+     * @brief [Producer] Append an item
+     *
+     * @return false if the ring is full, the item is not added
+    */
+    bool push(const T& item)
+    {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+        if(currentHead - producerCachedTail > indexMask)
+        {
+            producerCachedTail = tail.load(std::memory_order_acquire);
+            if(currentHead - producerCachedTail > indexMask)
+            {
+                return false;
+            }
+        }
+
+        slots[currentHead & indexMask] = item;
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * @brief [Consumer] Remove the oldest item
+     *
+     * @return false if the ring is empty
+    */
+    bool pop(T& item)
+    {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        if(currentTail == consumerCachedHead)
+        {
+            consumerCachedHead = head.load(std::memory_order_acquire);
+            if(currentTail == consumerCachedHead)
+            {
+                return false;
+            }
+        }
+
+        item = slots[currentTail & indexMask];
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * @brief [Consumer] Remove every item available when called, handing each one to onItem()
+     *
+     * Items pushed while draining are left for the next call, so a fast producer can't keep the consumer here forever
+     *
+     * @param onItem Callable with the signature void(const T&)
+     *
+     * @return Number of items removed
+    */
+    template<typename ItemCallback>
+    size_t drain(ItemCallback&& onItem)
+    {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        consumerCachedHead = head.load(std::memory_order_acquire);
+
+        for(size_t index = currentTail; index != consumerCachedHead; index++)
+        {
+            onItem(slots[index & indexMask]);
+        }
+
+        tail.store(consumerCachedHead, std::memory_order_release);
+        return consumerCachedHead - currentTail;
+    }
+
+    size_t capacity() const { return indexMask + 1; }
+
+    // Only a snapshot, the other side may change it right after
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    std::unique_ptr<T[]> slots;
+    size_t indexMask = 0;
+
+    // Written by the producer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head { 0 };
+    size_t producerCachedTail = 0;
+
+    // Written by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail { 0 };
+    size_t consumerCachedHead = 0;
+};
+
+#endif // SPSCRINGBUFFER_H
@@ -0,0 +1,14 @@
+include(../tests.pri)
+
+TARGET = tst_drivelog
+
+SOURCES += \
+        $$APP_SOURCE_DIR/drivelogencoder.cpp \
+        $$APP_SOURCE_DIR/drivelogfile.cpp \
+        tst_drivelog.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/devicesample.h \
+        $$APP_SOURCE_DIR/drivelogencoder.h \
+        $$APP_SOURCE_DIR/drivelogfile.h \
+        $$APP_SOURCE_DIR/drivelogformat.h
@@ -0,0 +1,91 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <vector>
+#include "drivelogfile.h"
+
+/*
+ * Checks that the drive log reader finds the samples of a time range when late merged samples make the blocks overlap,
+ * and that the decoded samples keep their source
+*/
+class DriveLogTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void findBlockWithLateSamples();
+    void samplesKeepTheirSource();
+
+private:
+    static constexpr uint8_t DEVICE_ADDRESS = 0x03;
+    static constexpr qint64 SAMPLE_PERIOD_NS = 100000;
+    static constexpr qint64 SECOND_NS = 1000000000;
+
+    static DeviceSample makeSample(uint8_t sourceId, qint64 timestamp, float value)
+    {
+        DeviceSample sample = DeviceSample::fromFloat(DEVICE_ADDRESS, timestamp, value);
+        sample.setSourceId(sourceId);
+        return sample;
+    }
+
+    QTemporaryDir temporaryDir;
+};
+
+void DriveLogTest::initTestCase()
+{
+    QVERIFY(temporaryDir.isValid());
+}
+
+void DriveLogTest::findBlockWithLateSamples()
+{
+    const QString filePath = temporaryDir.filePath(QStringLiteral("late.drivelog"));
+    DriveLogWriter writer;
+    QVERIFY(writer.open(filePath));
+    // A full first block, up to ~6.5 s
+    for(qint64 i = 0; i < DRIVE_LOG_BLOCK_MAX_SAMPLES; i++)
+    {
+        writer.write(makeSample(0, i * SAMPLE_PERIOD_NS, 1.0f));
+    }
+    // A late sample starts the second block, which ends before the first one
+    writer.write(makeSample(1, 3 * SECOND_NS, 2.0f));
+    // Too far from the late sample for its block, starts the third one
+    writer.write(makeSample(0, 14 * SECOND_NS, 3.0f));
+    writer.close();
+
+    DriveLogReader reader;
+    QVERIFY(reader.open(filePath));
+    QCOMPARE(reader.blocks().size(), size_t(3));
+    QVERIFY(reader.blocks()[1].lastTimestamp < reader.blocks()[0].lastTimestamp);
+
+    // The first block holds samples at 5 s, it must not be skipped
+    QCOMPARE(reader.findBlock(5 * SECOND_NS), size_t(0));
+    QCOMPARE(reader.findBlock(10 * SECOND_NS), size_t(2));
+    QCOMPARE(reader.findBlock(15 * SECOND_NS), size_t(3));
+}
+
+void DriveLogTest::samplesKeepTheirSource()
+{
+    const QString filePath = temporaryDir.filePath(QStringLiteral("sources.drivelog"));
+    DriveLogWriter writer;
+    QVERIFY(writer.open(filePath));
+    writer.write(makeSample(0, 0, 1.0f));
+    writer.write(makeSample(2, SAMPLE_PERIOD_NS, 2.0f));
+    writer.close();
+
+    DriveLogReader reader;
+    QVERIFY(reader.open(filePath));
+    std::vector<DriveLogColumn> columns;
+    QVERIFY(reader.readBlock(0, columns));
+    QCOMPARE(columns.size(), size_t(2));
+    for(const DriveLogColumn& column : columns)
+    {
+        QCOMPARE(column.timestamps.size(), size_t(1));
+        const DeviceSample sample = column.sample(0);
+        QCOMPARE(sample.sourceId(), int(column.sourceId));
+        QCOMPARE(sample.floatData(), column.sourceId == 0 ? 1.0f : 2.0f);
+    }
+}
+
+QTEST_APPLESS_MAIN(DriveLogTest)
+
+#include "tst_drivelog.moc"
@@ -0,0 +1,11 @@
+include(../tests.pri)
+
+TARGET = tst_samplefilter
+
+SOURCES += \
+        $$APP_SOURCE_DIR/samplefilter.cpp \
+        tst_samplefilter.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/devicesample.h \
+        $$APP_SOURCE_DIR/samplefilter.h
@@ -0,0 +1,133 @@
+#include <QtTest>
+#include <vector>
+#include "samplefilter.h"
+
+/*
+ * Checks that SampleFilter keeps a separate filter state for the same device on different sources
+*/
+class SampleFilterTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sourcesDontShareState_data();
+    void sourcesDontShareState();
+    void resetRestartsEverySource();
+    void extraSourcesPassThrough();
+
+private:
+    static constexpr uint8_t DEVICE_ADDRESS = 0x03;
+
+    static DeviceSample makeSample(uint8_t sourceId, qint64 timestamp, float value)
+    {
+        DeviceSample sample = DeviceSample::fromFloat(DEVICE_ADDRESS, timestamp, value);
+        sample.setSourceId(sourceId);
+        return sample;
+    }
+
+    // Filter the samples of one source alone, the reference the interleaved run must match
+    static std::vector<float> filterAlone(const SampleFilterSettings& settings, uint8_t sourceId, const std::vector<float>& values)
+    {
+        SampleFilter filter;
+        filter.setSettings(DEVICE_ADDRESS, settings);
+        std::vector<float> filtered;
+        for(size_t i = 0; i < values.size(); i++)
+        {
+            DeviceSample sample = makeSample(sourceId, static_cast<qint64>(i), values[i]);
+            filter.filter(sample);
+            filtered.push_back(sample.floatData());
+        }
+        return filtered;
+    }
+};
+
+void SampleFilterTest::sourcesDontShareState_data()
+{
+    QTest::addColumn<int>("lowPass");
+    QTest::addColumn<bool>("kalman");
+
+    QTest::newRow("exponential") << int(SampleFilterSettings::LOW_PASS_EXPONENTIAL) << false;
+    QTest::newRow("biquad") << int(SampleFilterSettings::LOW_PASS_BIQUAD) << false;
+    QTest::newRow("kalman") << int(SampleFilterSettings::LOW_PASS_NONE) << true;
+}
+
+void SampleFilterTest::sourcesDontShareState()
+{
+    QFETCH(int, lowPass);
+    QFETCH(bool, kalman);
+
+    SampleFilterSettings settings;
+    settings.lowPass = static_cast<SampleFilterSettings::LowPass>(lowPass);
+    settings.kalman = kalman;
+
+    // Two boards reporting the same device, e.g. the LM35 of two NodeOnes, at very different values
+    std::vector<float> first;
+    std::vector<float> second;
+    for(int i = 0; i < 50; i++)
+    {
+        first.push_back(20.0f + (i % 5) * 0.1f);
+        second.push_back(80.0f - (i % 3) * 0.2f);
+    }
+
+    SampleFilter filter;
+    filter.setSettings(DEVICE_ADDRESS, settings);
+    std::vector<float> filteredFirst;
+    std::vector<float> filteredSecond;
+    for(size_t i = 0; i < first.size(); i++)
+    {
+        DeviceSample sample = makeSample(0, static_cast<qint64>(i), first[i]);
+        filter.filter(sample);
+        filteredFirst.push_back(sample.floatData());
+
+        sample = makeSample(1, static_cast<qint64>(i), second[i]);
+        filter.filter(sample);
+        filteredSecond.push_back(sample.floatData());
+    }
+
+    QCOMPARE(filteredFirst, filterAlone(settings, 0, first));
+    QCOMPARE(filteredSecond, filterAlone(settings, 1, second));
+}
+
+void SampleFilterTest::resetRestartsEverySource()
+{
+    SampleFilterSettings settings;
+    settings.lowPass = SampleFilterSettings::LOW_PASS_EXPONENTIAL;
+
+    SampleFilter filter;
+    filter.setSettings(DEVICE_ADDRESS, settings);
+    for(uint8_t sourceId : { 0, 2 })
+    {
+        DeviceSample sample = makeSample(sourceId, 0, 10.0f);
+        filter.filter(sample);
+    }
+
+    filter.reset();
+
+    // A restarted filter starts settled on its first sample
+    for(uint8_t sourceId : { 0, 2 })
+    {
+        DeviceSample sample = makeSample(sourceId, 1, 50.0f);
+        filter.filter(sample);
+        QCOMPARE(sample.floatData(), 50.0f);
+    }
+}
+
+void SampleFilterTest::extraSourcesPassThrough()
+{
+    SampleFilterSettings settings;
+    settings.lowPass = SampleFilterSettings::LOW_PASS_EXPONENTIAL;
+
+    SampleFilter filter;
+    filter.setSettings(DEVICE_ADDRESS, settings);
+    for(int i = 0; i < 10; i++)
+    {
+        const float value = 10.0f * i;
+        DeviceSample sample = makeSample(SAMPLE_FILTER_MAX_SOURCES, i, value);
+        filter.filter(sample);
+        QCOMPARE(sample.floatData(), value);
+    }
+}
+
+QTEST_APPLESS_MAIN(SampleFilterTest)
+
+#include "tst_samplefilter.moc"
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_speedintegrator
+
+SOURCES += \
+        $$APP_SOURCE_DIR/speedintegrator.cpp \
+        tst_speedintegrator.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/speedintegrator.h
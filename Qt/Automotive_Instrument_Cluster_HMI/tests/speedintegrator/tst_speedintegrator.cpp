@@ -0,0 +1,105 @@
+#include <QtTest>
+#include "speedintegrator.h"
+
+/*
+ * Checks that SpeedIntegrator integrates every accelerometer sample, including the ones sharing the arrival time of their read chunk
+*/
+class SpeedIntegratorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void distinctTimestamps();
+    void sameTimestamp();
+    void chunksKeepTheArrivalTime();
+    void longGapIsCapped();
+    void unevenChunksFollowTheArrivalTime();
+
+private:
+    static constexpr int64_t MS = 1000000;
+};
+
+void SpeedIntegratorTest::distinctTimestamps()
+{
+    SpeedIntegrator integrator;
+    for(int i = 0; i <= 10; i++)
+    {
+        integrator.addSample(1.0, i * 10 * MS);
+    }
+
+    QVERIFY(qAbs(integrator.speed() - 0.1 * SpeedIntegrator::KMH_PER_SECOND_PER_G) < 1e-9);
+}
+
+void SpeedIntegratorTest::sameTimestamp()
+{
+    SpeedIntegrator integrator;
+    integrator.setSamplePeriod(10 * MS);
+
+    // Five frames of one chunk: the four after the first one are each integrated over the sample period
+    for(int i = 0; i < 5; i++)
+    {
+        integrator.addSample(1.0, 1000 * MS);
+    }
+
+    QVERIFY(qAbs(integrator.speed() - 0.04 * SpeedIntegrator::KMH_PER_SECOND_PER_G) < 1e-9);
+}
+
+void SpeedIntegratorTest::chunksKeepTheArrivalTime()
+{
+    SpeedIntegrator integrator;
+    integrator.setSamplePeriod(10 * MS);
+
+    // Chunks of three frames every 30 ms. The first chunk takes 2 sample periods, every next one the 30 ms since the previous chunk
+    for(int chunk = 0; chunk < 10; chunk++)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            integrator.addSample(1.0, chunk * 30 * MS);
+        }
+    }
+
+    QVERIFY(qAbs(integrator.speed() - 0.29 * SpeedIntegrator::KMH_PER_SECOND_PER_G) < 1e-9);
+    QCOMPARE(integrator.samplePeriod(), 10 * MS);
+}
+
+void SpeedIntegratorTest::longGapIsCapped()
+{
+    SpeedIntegrator integrator;
+    integrator.addSample(1.0, 0);
+    integrator.addSample(1.0, 5000 * MS);
+
+    QVERIFY(qAbs(integrator.speed() - SpeedIntegrator::KMH_PER_SECOND_PER_G * SpeedIntegrator::MAX_INTEGRATION_STEP_NS * 1e-9) < 1e-9);
+}
+
+void SpeedIntegratorTest::unevenChunksFollowTheArrivalTime()
+{
+    // Unclamped, so the speed measures the integrated time
+    SpeedIntegrator integrator(1e9);
+
+    // A frame every 10 ms, read in chunks of uneven sizes, each chunk arriving with its last frame
+    const int chunkSizes[] = { 1, 6, 2, 9, 3, 1, 4 };
+    const int chunkSizeCount = sizeof(chunkSizes) / sizeof(chunkSizes[0]);
+    int64_t arrivalTime = 0;
+    for(int chunk = 0; chunk < 100 * chunkSizeCount; chunk++)
+    {
+        arrivalTime += chunkSizes[chunk % chunkSizeCount] * 10 * MS;
+        for(int i = 0; i < chunkSizes[chunk % chunkSizeCount]; i++)
+        {
+            integrator.addSample(1.0, arrivalTime);
+        }
+
+        // Once the period is estimated, the integrated time stays within the frames of a chunk of the time elapsed since the first one
+        if(chunk >= chunkSizeCount)
+        {
+            const double integratedTime = integrator.speed() / SpeedIntegrator::KMH_PER_SECOND_PER_G;
+            const double elapsedTime = (arrivalTime - chunkSizes[0] * 10 * MS) * 1e-9;
+            QVERIFY(integratedTime >= elapsedTime - 1e-9);
+            QVERIFY(integratedTime <= elapsedTime + 0.1);
+        }
+    }
+    QCOMPARE(integrator.samplePeriod(), 10 * MS);
+}
+
+QTEST_APPLESS_MAIN(SpeedIntegratorTest)
+
+#include "tst_speedintegrator.moc"
@@ -0,0 +1,14 @@
+# Settings shared by all the test projects
+
+QT += testlib
+QT -= gui
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+# The application sources live one directory above the tests directory
+APP_SOURCE_DIR = $$PWD/..
+INCLUDEPATH += $$APP_SOURCE_DIR
+DEPENDPATH += $$APP_SOURCE_DIR
+# Device table and frame constants shared with the firmware
+INCLUDEPATH += $$APP_SOURCE_DIR/../../Firmware/Automotive_Instrument_Cluster_HMI/ATMega32ALib
@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+# Each test is a standalone QTest executable, "make check" runs them all
+SUBDIRS += \
+        drivelog \
+        samplefilter \
+        speedintegrator \
+        threadedserial
@@ -0,0 +1,28 @@
+include(../tests.pri)
+
+QT += serialport quick
+
+TARGET = tst_threadedserial
+
+SOURCES += \
+        $$APP_SOURCE_DIR/capturefile.cpp \
+        $$APP_SOURCE_DIR/devicedataparser.cpp \
+        $$APP_SOURCE_DIR/ingestionmetrics.cpp \
+        $$APP_SOURCE_DIR/serial.cpp \
+        $$APP_SOURCE_DIR/serialworker.cpp \
+        $$APP_SOURCE_DIR/threadedserial.cpp \
+        tst_threadedserial.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/capturefile.h \
+        $$APP_SOURCE_DIR/devicedataframedecoder.h \
+        $$APP_SOURCE_DIR/devicedataframedecoderv2.h \
+        $$APP_SOURCE_DIR/devicedataparser.h \
+        $$APP_SOURCE_DIR/deviceprotocol.h \
+        $$APP_SOURCE_DIR/devicesample.h \
+        $$APP_SOURCE_DIR/ingestioncounters.h \
+        $$APP_SOURCE_DIR/ingestionmetrics.h \
+        $$APP_SOURCE_DIR/serial.h \
+        $$APP_SOURCE_DIR/serialworker.h \
+        $$APP_SOURCE_DIR/spscringbuffer.h \
+        $$APP_SOURCE_DIR/threadedserial.h
@@ -0,0 +1,128 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "capturefile.h"
+#include "threadedserial.h"
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Checks that ThreadedSerial keeps recording to the same capture when the port is reopened with other settings
+*/
+class ThreadedSerialTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void reopenAppendsToTheCapture();
+
+private:
+    static constexpr int SESSION_FRAME_COUNT = 50;
+
+    // Motor frames with the session in their payload, so the sessions can be told apart in the capture
+    static QByteArray makeFrames(uint8_t session)
+    {
+        QByteArray frames;
+        for(int i = 0; i < SESSION_FRAME_COUNT; i++)
+        {
+            const uint8_t payload = session;
+            uint8_t encodedFrame[DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE + 1];
+            const size_t encodedSize = DeviceDataFrameDecoderV2::encode(Serial::DEVICE_INTERNAL_ADDRESS_MOTOR, uint8_t(i), &payload, 1, encodedFrame);
+            frames.append(reinterpret_cast<const char*>(encodedFrame), static_cast<int>(encodedSize));
+        }
+        return frames;
+    }
+
+    QTemporaryDir temporaryDir;
+    QString slavePath;
+    int masterFd = -1;
+    // Kept open so the pseudo-terminal survives the port being closed between the sessions
+    int slaveFd = -1;
+};
+
+void ThreadedSerialTest::initTestCase()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Needs a pseudo-terminal");
+#else
+    QVERIFY(temporaryDir.isValid());
+
+    masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    QVERIFY(masterFd >= 0);
+    QVERIFY(grantpt(masterFd) == 0 && unlockpt(masterFd) == 0);
+    slavePath = QString::fromLocal8Bit(ptsname(masterFd));
+    slaveFd = ::open(ptsname(masterFd), O_RDWR | O_NOCTTY);
+    QVERIFY(slaveFd >= 0);
+
+    // Raw mode, so the line discipline passes the binary frames through untouched
+    termios settings;
+    tcgetattr(slaveFd, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(slaveFd, TCSANOW, &settings);
+#endif
+}
+
+void ThreadedSerialTest::cleanupTestCase()
+{
+#ifdef Q_OS_UNIX
+    if(slaveFd >= 0)
+    {
+        ::close(slaveFd);
+    }
+    if(masterFd >= 0)
+    {
+        ::close(masterFd);
+    }
+#endif
+}
+
+void ThreadedSerialTest::reopenAppendsToTheCapture()
+{
+#ifdef Q_OS_UNIX
+    const QString capturePath = temporaryDir.filePath(QStringLiteral("reopen.cap"));
+    int samples = 0;
+
+    {
+        ThreadedSerial serial;
+        QObject::connect(&serial, &ThreadedSerial::deviceSampleAvailable, [&samples]() { samples++; });
+        serial.setPortName(slavePath);
+        serial.setBaudRate(QSerialPort::Baud9600);
+        serial.setCaptureFile(capturePath);
+        serial.setActive(true);
+
+        // Every session is sent once the port is open and fully read before the next one, so no byte is lost in between
+        const QByteArray firstSession = makeFrames(1);
+        QTRY_VERIFY(serial.isOpen());
+        QCOMPARE(::write(masterFd, firstSession.constData(), firstSession.size()), ssize_t(firstSession.size()));
+        QTRY_COMPARE(samples, SESSION_FRAME_COUNT);
+
+        // Replaces the worker
+        serial.setBaudRate(QSerialPort::Baud115200);
+        const QByteArray secondSession = makeFrames(2);
+        QTRY_VERIFY(serial.isOpen());
+        QCOMPARE(::write(masterFd, secondSession.constData(), secondSession.size()), ssize_t(secondSession.size()));
+        QTRY_COMPARE(samples, 2 * SESSION_FRAME_COUNT);
+    }
+
+    // Both sessions, in order
+    CaptureReader reader;
+    QVERIFY(reader.open(capturePath));
+    QByteArray captured;
+    CaptureReader::Chunk chunk;
+    while(reader.next(chunk))
+    {
+        captured.append(chunk.data, static_cast<int>(chunk.size));
+    }
+    QCOMPARE(captured, makeFrames(1) + makeFrames(2));
+#endif
+}
+
+QTEST_GUILESS_MAIN(ThreadedSerialTest)
+
+#include "tst_threadedserial.moc"
@@ -0,0 +1,214 @@
+#include "threadedserial.h"
+#include "serialworker.h"
+
+ThreadedSerial::ThreadedSerial(QObject* parent) : QObject(parent), ingestionMetrics(new IngestionMetrics(this))
+{
+    ioThread.setObjectName(QStringLiteral("SerialIO"));
+}
+
+ThreadedSerial::~ThreadedSerial()
+{
+    stopWorker();
+}
+
+void ThreadedSerial::setPortName(const QString& portName)
+{
+    if(port != portName)
+    {
+        port = portName;
+        emit portNameChanged(portName);
+        applyPortSettings();
+    }
+}
+
+void ThreadedSerial::setBaudRate(qint32 baudRate)
+{
+    if(baud != baudRate)
+    {
+        baud = baudRate;
+        emit baudRateChanged(baudRate);
+        applyPortSettings();
+    }
+}
+
+void ThreadedSerial::setFrameProtocol(Serial::FrameProtocol frameProtocol)
+{
+    if(protocol != frameProtocol)
+    {
+        protocol = frameProtocol;
+        emit frameProtocolChanged(frameProtocol);
+        applyPortSettings();
+    }
+}
+
+void ThreadedSerial::setCaptureFile(const QString& captureFile)
+{
+    if(captureFilePath != captureFile)
+    {
+        captureFilePath = captureFile;
+        emit captureFileChanged(captureFile);
+        applyPortSettings();
+    }
+}
+
+void ThreadedSerial::setBufferCapacity(int bufferCapacity)
+{
+    if(capacity != bufferCapacity && bufferCapacity > 0)
+    {
+        capacity = bufferCapacity;
+        emit bufferCapacityChanged(bufferCapacity);
+    }
+}
+
+void ThreadedSerial::setWindow(QQuickWindow* window)
+{
+    if(paceWindow == window)
+    {
+        return;
+    }
+
+    QObject::disconnect(paceConnection);
+    paceWindow = window;
+    if(paceWindow)
+    {
+        // afterAnimating() is emitted on the GUI thread once per frame, before the scene graph is synchronized
+        paceConnection = QObject::connect(paceWindow, &QQuickWindow::afterAnimating, this, &ThreadedSerial::drainSamples);
+    }
+    emit windowChanged(window);
+}
+
+void ThreadedSerial::setLatencyProbes(bool enabled)
+{
+    if(decodeTimestamps != enabled)
+    {
+        decodeTimestamps = enabled;
+        if(worker)
+        {
+            worker->setDecodeTimestamps(enabled);
+        }
+        emit latencyProbesChanged(enabled);
+    }
+}
+
+void ThreadedSerial::setActive(bool active)
+{
+    if(activeRequested != active)
+    {
+        activeRequested = active;
+        emit activeChanged(active);
+        applyPortSettings();
+    }
+}
+
+void ThreadedSerial::componentComplete()
+{
+    // Open with the final settings, rather than once per property assigned from QML
+    componentCompleted = true;
+    applyPortSettings();
+}
+
+void ThreadedSerial::drainSamples()
+{
+    if(!ring)
+    {
+        return;
+    }
+
+    // Re-arm the wake up before draining, so samples pushed meanwhile trigger another one
+    worker->acknowledgeSamples();
+    ring->drain([this](const DeviceSample& sample) { emit deviceSampleAvailable(sample); });
+
+    const quint64 dropped = worker->droppedSamples();
+    if(dropped != reportedDroppedSamples)
+    {
+        reportedDroppedSamples = dropped;
+        emit droppedSamplesChanged(droppedSamples());
+    }
+}
+
+void ThreadedSerial::applyPortSettings()
+{
+    if(!componentCompleted)
+    {
+        return;
+    }
+
+    stopWorker();
+
+    // One capture per path, kept open across the reopens of the port
+    if(captureRecorder.filePath() != captureFilePath)
+    {
+        captureRecorder.close();
+    }
+
+    if(!activeRequested || port.isEmpty())
+    {
+        return;
+    }
+
+    if(!captureRecorder.isOpen() && !captureFilePath.isEmpty())
+    {
+        captureRecorder.open(captureFilePath);
+    }
+
+    ring = std::make_unique<SpscRingBuffer<DeviceSample>>(static_cast<size_t>(capacity));
+    worker = new SerialWorker(ring.get());
+    worker->setDecodeTimestamps(decodeTimestamps);
+    worker->setCaptureRecorder(captureRecorder.isOpen() ? &captureRecorder : nullptr);
+    worker->moveToThread(&ioThread);
+    ingestionMetrics->setCounters({ &worker->counters() });
+
+    QObject::connect(worker, &SerialWorker::samplesAvailable, this, &ThreadedSerial::onSamplesAvailable);
+    QObject::connect(worker, &SerialWorker::errorOccurred, this, &ThreadedSerial::errorOccurred);
+    QObject::connect(worker, &SerialWorker::openChanged, this, [this](bool open)
+    {
+        if(opened != open)
+        {
+            opened = open;
+            emit isOpenChanged(open);
+        }
+    });
+
+    ioThread.start();
+    QMetaObject::invokeMethod(worker, [worker = worker, port = port, baud = baud, protocol = protocol]()
+    {
+        worker->open(port, baud, protocol);
+    }, Qt::QueuedConnection);
+}
+
+void ThreadedSerial::onSamplesAvailable()
+{
+    if(paceWindow)
+    {
+        // Make sure a frame is coming, the ring is drained on its afterAnimating()
+        paceWindow->update();
+    }
+    else
+    {
+        drainSamples();
+    }
+}
+
+void ThreadedSerial::stopWorker()
+{
+    if(!worker)
+    {
+        return;
+    }
+
+    // Close the port on its own thread, then stop the thread so the worker can be deleted from here
+    QMetaObject::invokeMethod(worker, &SerialWorker::close, Qt::BlockingQueuedConnection);
+    ioThread.quit();
+    ioThread.wait();
+
+    ingestionMetrics->setCounters({});
+    delete worker;
+    worker = nullptr;
+    ring.reset();
+
+    if(opened)
+    {
+        opened = false;
+        emit isOpenChanged(false);
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef THREADEDSERIAL_H
+#define THREADEDSERIAL_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQmlParserStatus>
+#include <QQuickWindow>
+#include <QThread>
+#include <memory>
+#include "capturefile.h"
+#include "devicesample.h"
+#include "ingestionmetrics.h"
+#include "serial.h"
+#include "spscringbuffer.h"
+
+class SerialWorker;
+
+/*
+ * Serial port reader running on its own I/O thread.
+ *
+ * The port is read and parsed by a SerialWorker on a dedicated QThread, so ingestion never competes with QML animation and rendering.
+ * Decoded samples cross to the GUI thread through a bounded lock-free SpscRingBuffer, which is drained once per frame
+ * (on [SIGNAL] QQuickWindow::afterAnimating() of the given window) and re-emitted as [SIGNAL] deviceSampleAvailable().
+ * Without a window the ring is drained as soon as the worker signals new samples.
+ *
+ * The port is always opened with 8 data bits, no parity and 1 stop bit.
+*/
+class ThreadedSerial : public QObject, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+    Q_PROPERTY(QString portName READ portName WRITE setPortName NOTIFY portNameChanged)
+    Q_PROPERTY(qint32 baudRate READ baudRate WRITE setBaudRate NOTIFY baudRateChanged)
+    // Record the raw bytes read from the port to this capture file, see CaptureRecorder. Reopens the port.
+    // The file is only created (truncated) when the path changes, the sessions of every reopen of the port are appended to it
+    Q_PROPERTY(QString captureFile READ captureFile WRITE setCaptureFile NOTIFY captureFileChanged)
+    Q_PROPERTY(Serial::FrameProtocol frameProtocol READ frameProtocol WRITE setFrameProtocol NOTIFY frameProtocolChanged)
+    // Max number of samples waiting for the GUI thread, samples arriving on a full ring are dropped. Applied on the next open
+    Q_PROPERTY(int bufferCapacity READ bufferCapacity WRITE setBufferCapacity NOTIFY bufferCapacityChanged)
+    // Window whose frames pace the draining of the ring
+    Q_PROPERTY(QQuickWindow* window READ window WRITE setWindow NOTIFY windowChanged)
+    // Stamp every sample with its decode time for LatencyProbe, see DeviceDataParser::setDecodeTimestamps()
+    Q_PROPERTY(bool latencyProbes READ latencyProbes WRITE setLatencyProbes NOTIFY latencyProbesChanged)
+    // Open the port when true, close it when false
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(bool isOpen READ isOpen NOTIFY isOpenChanged)
+    Q_PROPERTY(int droppedSamples READ droppedSamples NOTIFY droppedSamplesChanged)
+    // Throughput, frame rate per device and decoding errors of the port, refreshed while metrics.interval is set
+    Q_PROPERTY(IngestionMetrics* metrics READ metrics CONSTANT)
+
+public:
+    ThreadedSerial(QObject* parent = nullptr);
+    ~ThreadedSerial();
+
+    QString portName() const { return port; }
+    void setPortName(const QString& portName);
+
+    qint32 baudRate() const { return baud; }
+    void setBaudRate(qint32 baudRate);
+
+    QString captureFile() const { return captureFilePath; }
+    void setCaptureFile(const QString& captureFile);
+
+    Serial::FrameProtocol frameProtocol() const { return protocol; }
+    void setFrameProtocol(Serial::FrameProtocol frameProtocol);
+
+    int bufferCapacity() const { return capacity; }
+    void setBufferCapacity(int bufferCapacity);
+
+    QQuickWindow* window() const { return paceWindow; }
+    void setWindow(QQuickWindow* window);
+
+    bool latencyProbes() const { return decodeTimestamps; }
+    void setLatencyProbes(bool enabled);
+
+    bool active() const { return activeRequested; }
+    void setActive(bool active);
+
+    bool isOpen() const { return opened; }
+    int droppedSamples() const { return static_cast<int>(reportedDroppedSamples); }
+    IngestionMetrics* metrics() const { return ingestionMetrics; }
+
+    /*
+     * @brief Emit [SIGNAL] deviceSampleAvailable() for every sample waiting in the ring
+     *
+     * @return void
+    */
+    void drainSamples();
+
+    void classBegin() override { componentCompleted = false; }
+    void componentComplete() override;
+
+Q_SIGNALS:
+    void portNameChanged(QString portName);
+    void baudRateChanged(qint32 baudRate);
+    void frameProtocolChanged(Serial::FrameProtocol frameProtocol);
+    void captureFileChanged(QString captureFile);
+    void bufferCapacityChanged(int bufferCapacity);
+    void windowChanged(QQuickWindow* window);
+    void latencyProbesChanged(bool enabled);
+    void activeChanged(bool active);
+    void isOpenChanged(bool isOpen);
+    void droppedSamplesChanged(int droppedSamples);
+    void errorOccurred(QString errorString);
+
+    /*
+     * @brief [SIGNAL] Emitted on the GUI thread for every decoded device data frame, in arrival order
+     *
+     * @return void
+    */
+    void deviceSampleAvailable(DeviceSample sample);
+
+private:
+    /*
+     * @brief (Re)open the port on the worker thread with the current settings, or close it if not active
+     *
+     * @return void
+    */
+    void applyPortSettings();
+
+    /*
+     * @brief [SLOT] The worker pushed samples into an empty ring, request a frame to drain them (or drain right away without a window)
+     *
+     * @return void
+    */
+    void onSamplesAvailable();
+
+    void stopWorker();
+
+    QString port;
+    qint32 baud = QSerialPort::Baud4800;
+    Serial::FrameProtocol protocol = Serial::FRAME_PROTOCOL_V2;
+    QString captureFilePath;
+    // Outlives the workers, which are replaced whenever the port is reopened. Only used by the worker thread while it runs
+    CaptureRecorder captureRecorder;
+    int capacity = 65536;
+    QPointer<QQuickWindow> paceWindow;
+    QMetaObject::Connection paceConnection;
+    bool decodeTimestamps = false;
+    bool activeRequested = false;
+    bool opened = false;
+    bool componentCompleted = true;
+    quint64 reportedDroppedSamples = 0;
+
+    QThread ioThread;
+    std::unique_ptr<SpscRingBuffer<DeviceSample>> ring;
+    SerialWorker* worker = nullptr;
+    IngestionMetrics* ingestionMetrics;
+};
+
+#endif // THREADEDSERIAL_H
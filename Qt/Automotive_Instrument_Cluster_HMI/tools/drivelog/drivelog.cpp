@@ -0,0 +1,212 @@
+/*
+ * drivelog: reader of the drive logs written by the application, see DriveLogger and drivelogformat.h.
+ *
+ *   drivelog info <file>                           Blocks, samples, time span and size per device of the log
+ *   drivelog dump <file> [--from s] [--to s]       Samples of a time range as CSV, in timestamp order. The range is in seconds
+ *                                                  from the first sample of the log, only the blocks overlapping it are decoded
+ *   drivelog bench <file> [--repeat n]             Decode the whole log n times and print the throughput
+ *
+ * The CSV columns are the ones of SampleWriter, so dumps can be compared with the CSV sample files of the headless mode.
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <map>
+#include <utility>
+#include <vector>
+#include "drivelogfile.h"
+#include "samplewriter.h"
+
+namespace
+{
+
+int info(const DriveLogReader& reader)
+{
+    const std::vector<DriveLogReader::Block>& blocks = reader.blocks();
+    if(blocks.empty())
+    {
+        printf("empty log, %zu bytes\n", reader.size());
+        return 0;
+    }
+
+    struct ColumnTotals
+    {
+        quint64 samples = 0;
+    };
+    // Keyed by source id and device address
+    std::map<std::pair<int, int>, ColumnTotals> totals;
+    std::vector<DriveLogColumn> columns;
+    quint64 samples = 0;
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        if(!reader.readBlock(i, columns))
+        {
+            fprintf(stderr, "block %zu is corrupted\n", i);
+            return 1;
+        }
+        for(const DriveLogColumn& column : columns)
+        {
+            totals[{ column.sourceId, column.deviceAddress }].samples += column.timestamps.size();
+            samples += column.timestamps.size();
+        }
+    }
+
+    const double seconds = (blocks.back().latestTimestamp - blocks.front().firstTimestamp) / 1e9;
+    printf("%zu blocks, %llu samples over %.3f s, %zu bytes (%.2f bytes per sample)%s\n", blocks.size(), static_cast<unsigned long long>(samples),
+           seconds, reader.size(), samples > 0 ? double(reader.size()) / samples : 0.0, reader.recovered() ? ", index rebuilt" : "");
+    for(const auto& [key, columnTotals] : totals)
+    {
+        printf("  source %d device %3d: %12llu samples (%.1f per second)\n", key.first, key.second,
+               static_cast<unsigned long long>(columnTotals.samples), seconds > 0.0 ? columnTotals.samples / seconds : 0.0);
+    }
+    return 0;
+}
+
+int dump(const DriveLogReader& reader, double fromSeconds, double toSeconds)
+{
+    const std::vector<DriveLogReader::Block>& blocks = reader.blocks();
+    printf("timestamp_ns,source_id,device_address,payload_type,value\n");
+    if(blocks.empty())
+    {
+        return 0;
+    }
+
+    const qint64 origin = blocks.front().firstTimestamp;
+    const qint64 from = origin + static_cast<qint64>(fromSeconds * 1e9);
+    const qint64 to = toSeconds >= 0.0 ? origin + static_cast<qint64>(toSeconds * 1e9) : INT64_MAX;
+
+    std::vector<DriveLogColumn> columns;
+    std::vector<size_t> positions;
+    for(size_t i = reader.findBlock(from); i < blocks.size() && blocks[i].firstTimestamp <= to; i++)
+    {
+        if(!reader.readBlock(i, columns))
+        {
+            fprintf(stderr, "block %zu is corrupted\n", i);
+            return 1;
+        }
+
+        // Merge the columns back into timestamp order, a block has only a few of them
+        positions.assign(columns.size(), 0);
+        while(true)
+        {
+            const DriveLogColumn* next = nullptr;
+            size_t* nextPosition = nullptr;
+            for(size_t c = 0; c < columns.size(); c++)
+            {
+                if(positions[c] < columns[c].timestamps.size()
+                   && (!next || columns[c].timestamps[positions[c]] < next->timestamps[*nextPosition]))
+                {
+                    next = &columns[c];
+                    nextPosition = &positions[c];
+                }
+            }
+            if(!next)
+            {
+                break;
+            }
+
+            const qint64 timestamp = next->timestamps[*nextPosition];
+            if(timestamp >= from && timestamp <= to)
+            {
+                printf("%lld,%d,%d,%d,", static_cast<long long>(timestamp), next->sourceId, next->deviceAddress, static_cast<int>(next->payloadType));
+                if(next->payloadType == DeviceSample::PAYLOAD_TYPE_FLOAT)
+                {
+                    printf("%.9g\n", next->values[*nextPosition]);
+                }
+                else if(next->payloadType == DeviceSample::PAYLOAD_TYPE_BYTE)
+                {
+                    printf("%d\n", static_cast<int>(next->values[*nextPosition]));
+                }
+                else
+                {
+                    printf("\n");
+                }
+            }
+            (*nextPosition)++;
+        }
+    }
+    return 0;
+}
+
+int bench(const DriveLogReader& reader, int repeat)
+{
+    std::vector<DriveLogColumn> columns;
+    quint64 samples = 0;
+    double checksum = 0.0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for(int r = 0; r < repeat; r++)
+    {
+        for(size_t i = 0; i < reader.blocks().size(); i++)
+        {
+            if(!reader.readBlock(i, columns))
+            {
+                fprintf(stderr, "block %zu is corrupted\n", i);
+                return 1;
+            }
+            for(const DriveLogColumn& column : columns)
+            {
+                samples += column.timestamps.size();
+                // Keeps the decoded values alive
+                checksum += column.values.empty() ? 0.0 : column.values.back() + column.timestamps.back();
+            }
+        }
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    const double bytes = double(reader.size()) * repeat;
+    printf("decoded %llu samples in %.3f s: %.1f MB/s of log, %.1f M samples/s, %.1f MB/s as SampleWriter binary records (checksum %g)\n",
+           static_cast<unsigned long long>(samples), seconds, bytes / seconds / 1e6, samples / seconds / 1e6,
+           samples * double(SAMPLE_FILE_RECORD_SIZE) / seconds / 1e6, checksum);
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser commandLine;
+    commandLine.setApplicationDescription(QStringLiteral("Reads the drive logs written by the Automotive Instrument Cluster HMI."));
+    commandLine.addHelpOption();
+    commandLine.addPositionalArgument(QStringLiteral("command"), QStringLiteral("info, dump or bench."));
+    commandLine.addPositionalArgument(QStringLiteral("file"), QStringLiteral("Drive log to read."));
+    const QCommandLineOption fromOption(QStringLiteral("from"), QStringLiteral("dump: start of the range, in seconds from the first sample."), QStringLiteral("seconds"), QStringLiteral("0"));
+    const QCommandLineOption toOption(QStringLiteral("to"), QStringLiteral("dump: end of the range, in seconds from the first sample. Default to the end of the log."), QStringLiteral("seconds"));
+    const QCommandLineOption repeatOption(QStringLiteral("repeat"), QStringLiteral("bench: number of times the log is decoded."), QStringLiteral("count"), QStringLiteral("10"));
+    commandLine.addOptions({ fromOption, toOption, repeatOption });
+    commandLine.process(app);
+
+    const QStringList arguments = commandLine.positionalArguments();
+    if(arguments.size() != 2)
+    {
+        commandLine.showHelp(1);
+    }
+
+    DriveLogReader reader;
+    if(!reader.open(arguments[1]))
+    {
+        return 1;
+    }
+
+    const QString& command = arguments[0];
+    if(command == QLatin1String("info"))
+    {
+        return info(reader);
+    }
+    if(command == QLatin1String("dump"))
+    {
+        return dump(reader, commandLine.value(fromOption).toDouble(), commandLine.isSet(toOption) ? commandLine.value(toOption).toDouble() : -1.0);
+    }
+    if(command == QLatin1String("bench"))
+    {
+        return bench(reader, qMax(1, commandLine.value(repeatOption).toInt()));
+    }
+
+    fprintf(stderr, "unknown command %s\n", qPrintable(command));
+    return 1;
+}
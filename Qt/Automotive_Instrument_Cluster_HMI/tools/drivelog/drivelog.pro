@@ -0,0 +1,25 @@
+# Reader of the drive logs written by the application (see DriveLogger): prints their summary, dumps a time range as CSV
+# and measures the decoding throughput
+
+TEMPLATE = app
+TARGET = drivelog
+
+QT = core
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+# The log format and its reader live with the application
+APP_SOURCE_DIR = $$PWD/../..
+INCLUDEPATH += $$APP_SOURCE_DIR
+
+SOURCES += \
+        drivelog.cpp \
+        $$APP_SOURCE_DIR/drivelogencoder.cpp \
+        $$APP_SOURCE_DIR/drivelogfile.cpp
+
+HEADERS += \
+        $$APP_SOURCE_DIR/devicesample.h \
+        $$APP_SOURCE_DIR/drivelogencoder.h \
+        $$APP_SOURCE_DIR/drivelogfile.h \
+        $$APP_SOURCE_DIR/drivelogformat.h \
+        $$APP_SOURCE_DIR/samplewriter.h
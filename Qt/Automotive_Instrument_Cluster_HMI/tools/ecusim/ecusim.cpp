@@ -0,0 +1,456 @@
+/*
+ * ecusim: ECU simulator for load-testing the HMI without hardware (Linux).
+ *
+ * Opens a pseudo-terminal and writes HMI node device data frames (motor, accelerometer and LM35) to it at a configurable rate,
+ * with configurable value patterns, noise, bursty timing and corrupted bytes. Point the portName of Serial/ThreadedSerial at the
+ * printed PTY path (or at the --link symlink) to run soak tests, and raise --rate until the achieved rate falls behind
+ * to find the max sustainable frame rate.
+*/
+
+#include "devicedataframedecoderv2.h"
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+
+enum class Pattern
+{
+    Constant,
+    Ramp,
+    Sine,
+    Random
+};
+
+struct Device
+{
+    const char* name;
+    uint8_t address;
+    // Values are generated in [minValue, maxValue]
+    double minValue;
+    double maxValue;
+    // Motor duty cycle is a byte, the other devices send a float
+    bool byteValue;
+};
+
+// Addresses from DEVICE_PROTOCOL_DEVICES, shared with the firmware
+const Device DEVICES[] =
+{
+    { "motor",          DEVICE_INTERNAL_ADDRESS_MOTOR,          0.0,    100.0,  true },
+    { "accelerometer",  DEVICE_INTERNAL_ADDRESS_ACCELEROMETER,  -1.0,   1.0,    false },
+    { "lm35",           DEVICE_INTERNAL_ADDRESS_LM35,           15.0,   45.0,   false }
+};
+
+struct Options
+{
+    double rate = 100.0;
+    int protocol = 2;
+    Pattern pattern = Pattern::Sine;
+    // Period of the ramp and sine patterns in seconds
+    double period = 10.0;
+    // Standard deviation of the added gaussian noise, as a fraction of each device range
+    double noise = 0.0;
+    // Frames are sent back to back in groups of burstSize, the average rate stays the same
+    int burstSize = 1;
+    // Probability for each frame to get one of its bytes flipped
+    double corruptProbability = 0.0;
+    // Probability to insert a random garbage byte between two frames
+    double garbageProbability = 0.0;
+    // 0 runs until interrupted
+    double duration = 0.0;
+    double statsInterval = 1.0;
+    std::vector<const Device*> devices;
+    std::string linkPath;
+    unsigned seed = 1;
+};
+
+volatile std::sig_atomic_t gs_stopRequested = 0;
+
+void onStopSignal(int)
+{
+    gs_stopRequested = 1;
+}
+
+void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --rate <frames/s>          Frame rate, all devices together (default 100)\n"
+        "  --protocol <1|2>           Wire format (default 2)\n"
+        "  --pattern <constant|ramp|sine|random>\n"
+        "                             Shape of the generated values (default sine)\n"
+        "  --period <s>               Period of the ramp and sine patterns (default 10)\n"
+        "  --noise <fraction>         Gaussian noise, standard deviation as a fraction of each device range (default 0)\n"
+        "  --burst <frames>           Send frames back to back in bursts of this size (default 1)\n"
+        "  --corrupt <probability>    Probability to flip a byte of each frame (default 0)\n"
+        "  --garbage <probability>    Probability to insert a garbage byte between frames (default 0)\n"
+        "  --devices <list>           Comma separated subset of motor,accelerometer,lm35 (default all)\n"
+        "  --duration <s>             Stop after this time, 0 runs until interrupted (default 0)\n"
+        "  --stats <s>                Statistics interval, 0 disables them (default 1)\n"
+        "  --link <path>              Create a symlink to the PTY slave at this path\n"
+        "  --seed <n>                 Random seed (default 1)\n",
+        program);
+}
+
+bool parsePattern(const char* name, Pattern& pattern)
+{
+    if(!std::strcmp(name, "constant")) pattern = Pattern::Constant;
+    else if(!std::strcmp(name, "ramp")) pattern = Pattern::Ramp;
+    else if(!std::strcmp(name, "sine")) pattern = Pattern::Sine;
+    else if(!std::strcmp(name, "random")) pattern = Pattern::Random;
+    else return false;
+    return true;
+}
+
+bool parseDevices(const std::string& list, std::vector<const Device*>& devices)
+{
+    devices.clear();
+    size_t start = 0;
+    while(start <= list.size())
+    {
+        const size_t end = std::min(list.find(',', start), list.size());
+        const std::string name = list.substr(start, end - start);
+        bool found = false;
+        for(const Device& device : DEVICES)
+        {
+            if(name == device.name)
+            {
+                devices.push_back(&device);
+                found = true;
+            }
+        }
+        if(!found)
+        {
+            return false;
+        }
+        start = end + 1;
+    }
+    return !devices.empty();
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string option = argv[i];
+        if(option == "--help" || option == "-h" || i + 1 >= argc)
+        {
+            return false;
+        }
+
+        const char* value = argv[++i];
+        if(option == "--rate") options.rate = std::atof(value);
+        else if(option == "--protocol") options.protocol = std::atoi(value);
+        else if(option == "--pattern") { if(!parsePattern(value, options.pattern)) return false; }
+        else if(option == "--period") options.period = std::atof(value);
+        else if(option == "--noise") options.noise = std::atof(value);
+        else if(option == "--burst") options.burstSize = std::atoi(value);
+        else if(option == "--corrupt") options.corruptProbability = std::atof(value);
+        else if(option == "--garbage") options.garbageProbability = std::atof(value);
+        else if(option == "--devices") { if(!parseDevices(value, options.devices)) return false; }
+        else if(option == "--duration") options.duration = std::atof(value);
+        else if(option == "--stats") options.statsInterval = std::atof(value);
+        else if(option == "--link") options.linkPath = value;
+        else if(option == "--seed") options.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else return false;
+    }
+
+    if(options.devices.empty())
+    {
+        for(const Device& device : DEVICES)
+        {
+            options.devices.push_back(&device);
+        }
+    }
+
+    return options.rate > 0.0 && options.period > 0.0 && options.burstSize > 0 && (options.protocol == 1 || options.protocol == 2);
+}
+
+/*
+ * @brief Open a pseudo-terminal in raw mode
+ *
+ * The slave side is kept open as well, so the master doesn't fail with EIO while no HMI is connected
+ *
+ * @return The master file descriptor, -1 on failure
+*/
+int openPseudoTerminal(std::string& slavePath, int& slaveFd)
+{
+    const int masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if(masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0)
+    {
+        std::perror("ecusim: can't open a pseudo-terminal");
+        return -1;
+    }
+
+    slavePath = ptsname(masterFd);
+    slaveFd = open(slavePath.c_str(), O_RDWR | O_NOCTTY);
+    if(slaveFd < 0)
+    {
+        std::perror("ecusim: can't open the pseudo-terminal slave");
+        close(masterFd);
+        return -1;
+    }
+
+    // Raw mode, so the line discipline doesn't translate '\r' or swallow control bytes of the binary frames
+    termios settings;
+    tcgetattr(slaveFd, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(slaveFd, TCSANOW, &settings);
+
+    return masterFd;
+}
+
+double secondsSince(const timespec& start)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+/*
+ * @brief Generated value of a device at the given time
+*/
+double deviceValue(const Device& device, const Options& options, double time, std::mt19937& random)
+{
+    double shape = 0.5;
+    switch(options.pattern)
+    {
+        case Pattern::Constant:
+            break;
+        case Pattern::Ramp:
+            shape = std::fmod(time, options.period) / options.period;
+            break;
+        case Pattern::Sine:
+            shape = 0.5 + 0.5 * std::sin(2.0 * M_PI * time / options.period);
+            break;
+        case Pattern::Random:
+            shape = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+            break;
+    }
+
+    const double range = device.maxValue - device.minValue;
+    double value = device.minValue + shape * range;
+    if(options.noise > 0.0)
+    {
+        value += std::normal_distribution<double>(0.0, options.noise * range)(random);
+    }
+
+    return value;
+}
+
+/*
+ * @brief Append one encoded device data frame to the output
+*/
+void appendFrame(const Device& device, double value, uint8_t sequenceNumber, int protocol, std::vector<uint8_t>& output)
+{
+    uint8_t payload[4];
+    size_t payloadSize;
+    if(device.byteValue)
+    {
+        payload[0] = static_cast<uint8_t>(std::lround(std::min(255.0, std::max(0.0, value))));
+        payloadSize = 1;
+    }
+    else
+    {
+        const float floatValue = static_cast<float>(value);
+        std::memcpy(payload, &floatValue, 4);
+        payloadSize = 4;
+    }
+
+    if(protocol == 2)
+    {
+        uint8_t encodedFrame[DEVICE_DATA_FRAME_V2_MAX_ENCODED_SIZE + 1];
+        const size_t encodedSize = DeviceDataFrameDecoderV2::encode(device.address, sequenceNumber, payload, payloadSize, encodedFrame);
+        output.insert(output.end(), encodedFrame, encodedFrame + encodedSize);
+    }
+    else
+    {
+        output.push_back(DEVICE_DATA_FRAME_V1_START_DELIMITER);
+        output.push_back(device.address);
+        output.insert(output.end(), payload, payload + payloadSize);
+        output.push_back(DEVICE_DATA_FRAME_V1_END_DELIMITER);
+    }
+}
+
+/*
+ * @brief Write the whole buffer to the non-blocking PTY master
+ *
+ * Waits while the PTY buffer is full, i.e. while the HMI doesn't keep up or isn't connected, and counts that time as stalled
+ *
+ * @return false if stopped or on error
+*/
+bool writeAll(int fd, const uint8_t* data, size_t size, double deadline, const timespec& start, double& stalledTime)
+{
+    while(size > 0)
+    {
+        if(gs_stopRequested || (deadline > 0.0 && secondsSince(start) >= deadline))
+        {
+            return false;
+        }
+
+        const ssize_t written = write(fd, data, size);
+        if(written < 0)
+        {
+            if(errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                const double stallStart = secondsSince(start);
+                pollfd writable = { fd, POLLOUT, 0 };
+                poll(&writable, 1, 100);
+                stalledTime += secondsSince(start) - stallStart;
+                continue;
+            }
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            std::perror("ecusim: write failed");
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if(!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string slavePath;
+    int slaveFd = -1;
+    const int masterFd = openPseudoTerminal(slavePath, slaveFd);
+    if(masterFd < 0)
+    {
+        return 1;
+    }
+
+    if(!options.linkPath.empty())
+    {
+        unlink(options.linkPath.c_str());
+        if(symlink(slavePath.c_str(), options.linkPath.c_str()) != 0)
+        {
+            std::perror("ecusim: can't create the symlink");
+        }
+    }
+
+    // No SA_RESTART, so a stop request interrupts a waiting poll()
+    struct sigaction stopAction = {};
+    stopAction.sa_handler = onStopSignal;
+    sigaction(SIGINT, &stopAction, nullptr);
+    sigaction(SIGTERM, &stopAction, nullptr);
+
+    fcntl(masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+
+    std::printf("ecusim: writing protocol v%d frames at %.0f frames/s to %s\n", options.protocol, options.rate, slavePath.c_str());
+    std::fflush(stdout);
+
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> probability(0.0, 1.0);
+    std::vector<uint8_t> output;
+    uint8_t sequenceNumber = 0;
+    size_t nextDevice = 0;
+
+    unsigned long long sentFrames = 0;
+    unsigned long long sentBytes = 0;
+    unsigned long long corruptedFrames = 0;
+    unsigned long long statsFrames = 0;
+    double statsTime = 0.0;
+    double stalledTime = 0.0;
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    // Scheduling tick, frames due at each tick are written with a single write()
+    const long tickNs = 1000000;
+    timespec nextTick = start;
+
+    while(!gs_stopRequested)
+    {
+        const double time = secondsSince(start);
+        if(options.duration > 0.0 && time >= options.duration)
+        {
+            break;
+        }
+
+        // Frames due so far, rounded down to whole bursts
+        const unsigned long long dueFrames = static_cast<unsigned long long>(time * options.rate) / options.burstSize * options.burstSize;
+
+        output.clear();
+        for(; sentFrames < dueFrames; sentFrames++)
+        {
+            const Device& device = *options.devices[nextDevice];
+            nextDevice = (nextDevice + 1) % options.devices.size();
+
+            const size_t frameStart = output.size();
+            appendFrame(device, deviceValue(device, options, time, random), sequenceNumber++, options.protocol, output);
+
+            if(options.corruptProbability > 0.0 && probability(random) < options.corruptProbability)
+            {
+                const size_t frameSize = output.size() - frameStart;
+                output[frameStart + random() % frameSize] ^= static_cast<uint8_t>(1 + random() % 255);
+                corruptedFrames++;
+            }
+            if(options.garbageProbability > 0.0 && probability(random) < options.garbageProbability)
+            {
+                output.push_back(static_cast<uint8_t>(random()));
+            }
+        }
+
+        // A stalled write means the HMI doesn't keep up, which shows up as an achieved rate below the requested one
+        if(!output.empty() && !writeAll(masterFd, output.data(), output.size(), options.duration, start, stalledTime))
+        {
+            break;
+        }
+        sentBytes += output.size();
+
+        if(options.statsInterval > 0.0 && time - statsTime >= options.statsInterval)
+        {
+            const double achievedRate = (sentFrames - statsFrames) / (time - statsTime);
+            std::printf("ecusim: %.1f s, %llu frames, %.0f frames/s (requested %.0f)%s, %llu bytes, %llu corrupted, %.1f s stalled\n",
+                        time, sentFrames, achievedRate, options.rate, achievedRate < options.rate * 0.95 ? " FALLING BEHIND" : "",
+                        sentBytes, corruptedFrames, stalledTime);
+            std::fflush(stdout);
+            statsFrames = sentFrames;
+            statsTime = time;
+        }
+
+        nextTick.tv_nsec += tickNs;
+        if(nextTick.tv_nsec >= 1000000000)
+        {
+            nextTick.tv_sec++;
+            nextTick.tv_nsec -= 1000000000;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextTick, nullptr);
+    }
+
+    std::printf("ecusim: sent %llu frames (%llu bytes, %llu corrupted) in %.1f s\n", sentFrames, sentBytes, corruptedFrames, secondsSince(start));
+
+    if(!options.linkPath.empty())
+    {
+        unlink(options.linkPath.c_str());
+    }
+    close(slaveFd);
+    close(masterFd);
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+# ECU simulator writing device data frames to a pseudo-terminal, Linux only
+
+TEMPLATE = app
+TARGET = ecusim
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+# Shares the frame encoder with the application
+INCLUDEPATH += $$PWD/../..
+# and the frame constants with the firmware
+INCLUDEPATH += $$PWD/../../../../Firmware/Automotive_Instrument_Cluster_HMI/ATMega32ALib
+
+SOURCES += \
+        ecusim.cpp
@@ -0,0 +1,18 @@
+# Reader library of the shared vehicle state segment published by the application, for other processes on the cluster computer.
+# POSIX only. Link the static library and include sharedstatereader.h, see SharedStateReader
+
+TEMPLATE = lib
+TARGET = sharedstatereader
+
+CONFIG += staticlib c++17
+CONFIG -= qt app_bundle
+
+# The reader lives with the application, next to the segment layout it shares with the writer
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += \
+        $$PWD/../../sharedstatereader.cpp
+
+HEADERS += \
+        $$PWD/../../sharedstatelayout.h \
+        $$PWD/../../sharedstatereader.h